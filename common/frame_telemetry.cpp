@@ -0,0 +1,130 @@
+#include "frame_telemetry.h"
+#include <algorithm>
+#include <fstream>
+
+const char *FramePhaseName(FramePhase phase)
+{
+    switch (phase)
+    {
+    case FramePhase::Input:
+        return "input";
+    case FramePhase::Im3dNewFrame:
+        return "im3d_newframe";
+    case FramePhase::Im3dUser:
+        return "im3d_user";
+    case FramePhase::Im3dEndFrame:
+        return "im3d_endframe";
+    case FramePhase::ImGuiUser:
+        return "imgui_user";
+    case FramePhase::DrawTeapot:
+        return "draw_teapot";
+    case FramePhase::DrawIm3d:
+        return "draw_im3d";
+    case FramePhase::ImGuiRender:
+        return "imgui_render";
+    case FramePhase::Present:
+        return "present";
+    default:
+        return "total";
+    }
+}
+
+FrameTelemetryStats FrameTelemetry::CalcStats(FramePhase phase) const
+{
+    FrameTelemetryStats stats{};
+    auto size = Size();
+    if (size == 0)
+    {
+        return stats;
+    }
+
+    std::array<float, Capacity> values;
+    double sum = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        values[i] = Value(i, phase);
+        sum += values[i];
+    }
+    std::sort(values.begin(), values.begin() + size);
+    auto percentile = [&](float p) { return values[std::min(size - 1, (int)(p * size))]; };
+    stats.Min = values[0];
+    stats.Mean = (float)(sum / size);
+    stats.P50 = percentile(0.50f);
+    stats.P95 = percentile(0.95f);
+    stats.P99 = percentile(0.99f);
+    stats.Max = values[size - 1];
+    return stats;
+}
+
+void FrameTelemetry::CalcHistogram(FramePhase phase, float maxMs, float *bins, int binCount) const
+{
+    std::fill(bins, bins + binCount, 0.0f);
+    if (binCount <= 0 || maxMs <= 0)
+    {
+        return;
+    }
+    for (int i = 0; i < Size(); ++i)
+    {
+        auto bin = (int)(Value(i, phase) / maxMs * binCount);
+        bins[std::min(bin, binCount - 1)] += 1.0f;
+    }
+}
+
+bool FrameTelemetry::WriteCsv(const std::filesystem::path &path) const
+{
+    std::ofstream io(path);
+    if (!io)
+    {
+        return false;
+    }
+    io << "frame";
+    for (int p = 0; p <= PhaseCount; ++p)
+    {
+        io << ',' << FramePhaseName((FramePhase)p);
+    }
+    io << '\n';
+    for (int i = 0; i < Size(); ++i)
+    {
+        io << (m_frameCount - Size() + i);
+        for (int p = 0; p <= PhaseCount; ++p)
+        {
+            io << ',' << Value(i, (FramePhase)p);
+        }
+        io << '\n';
+    }
+    return (bool)io;
+}
+
+bool FrameTelemetry::WriteJson(const std::filesystem::path &path) const
+{
+    std::ofstream io(path);
+    if (!io)
+    {
+        return false;
+    }
+    io << "{\n  \"unit\": \"ms\",\n  \"summary\": {";
+    for (int p = 0; p <= PhaseCount; ++p)
+    {
+        auto stats = CalcStats((FramePhase)p);
+        io << (p ? ",\n" : "\n") << "    \"" << FramePhaseName((FramePhase)p) << "\": {\"min\": " << stats.Min
+           << ", \"mean\": " << stats.Mean << ", \"p50\": " << stats.P50 << ", \"p95\": " << stats.P95
+           << ", \"p99\": " << stats.P99 << ", \"max\": " << stats.Max << "}";
+    }
+    io << "\n  },\n  \"columns\": [\"frame\"";
+    for (int p = 0; p <= PhaseCount; ++p)
+    {
+        io << ", \"" << FramePhaseName((FramePhase)p) << "\"";
+    }
+    io << "],\n  \"frames\": [";
+    for (int i = 0; i < Size(); ++i)
+    {
+        io << (i ? ",\n" : "\n") << "    [" << (m_frameCount - Size() + i);
+        for (int p = 0; p <= PhaseCount; ++p)
+        {
+            io << ", " << Value(i, (FramePhase)p);
+        }
+        io << "]";
+    }
+    io << "\n  ]\n}\n";
+    return (bool)io;
+}
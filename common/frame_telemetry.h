@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <stdint.h>
+
+///
+/// Per frame phase timings in a fixed size ring of the last FrameTelemetry::Capacity frames.
+///
+/// telemetry.BeginFrame();
+/// ... input ...               telemetry.Mark(FramePhase::Input);
+/// Im3d_Impl_NewFrame(...);    telemetry.Mark(FramePhase::Im3dNewFrame);
+/// ...
+/// dx11.Present();             telemetry.Mark(FramePhase::Present);
+/// telemetry.EndFrame();
+///
+/// Mark() charges the time since the previous mark to the phase. While disabled every call returns before reading the clock.
+///
+enum class FramePhase
+{
+    Input,
+    Im3dNewFrame,
+    Im3dUser,
+    Im3dEndFrame,
+    ImGuiUser,
+    DrawTeapot,
+    DrawIm3d,
+    ImGuiRender,
+    Present,
+    Count,
+};
+const char *FramePhaseName(FramePhase phase);
+
+struct FrameTelemetryStats
+{
+    float Min;
+    float Mean;
+    float P50;
+    float P95;
+    float P99;
+    float Max;
+};
+
+class FrameTelemetry
+{
+public:
+    using clock = std::chrono::steady_clock;
+    static const int Capacity = 512;
+    static const int PhaseCount = (int)FramePhase::Count;
+
+    // milliseconds
+    struct Frame
+    {
+        std::array<float, PhaseCount> Phases;
+        float Total;
+    };
+
+private:
+    std::array<Frame, Capacity> m_frames;
+    uint64_t m_frameCount = 0; // frames written, the ring holds the last min(m_frameCount, Capacity)
+    Frame m_current;
+    clock::time_point m_frameBegin;
+    clock::time_point m_last;
+    bool m_enabled = true;
+
+public:
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled; }
+
+    void BeginFrame()
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        m_current = {};
+        m_frameBegin = m_last = clock::now();
+    }
+
+    void Mark(FramePhase phase)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        auto now = clock::now();
+        m_current.Phases[(int)phase] += std::chrono::duration<float, std::milli>(now - m_last).count();
+        m_last = now;
+    }
+
+    void EndFrame()
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        m_current.Total = std::chrono::duration<float, std::milli>(clock::now() - m_frameBegin).count();
+        m_frames[m_frameCount % Capacity] = m_current;
+        ++m_frameCount;
+    }
+
+    void Clear() { m_frameCount = 0; }
+    int Size() const { return m_frameCount < Capacity ? (int)m_frameCount : Capacity; }
+    // 0 is the oldest frame in the ring
+    const Frame &At(int i) const { return m_frames[(m_frameCount - Size() + i) % Capacity]; }
+
+    // phase == FramePhase::Count is the frame total
+    float Value(int i, FramePhase phase) const
+    {
+        auto &frame = At(i);
+        return phase == FramePhase::Count ? frame.Total : frame.Phases[(int)phase];
+    }
+    FrameTelemetryStats CalcStats(FramePhase phase) const;
+    // count frames per bin over [0, maxMs), the last bin also counts everything above
+    void CalcHistogram(FramePhase phase, float maxMs, float *bins, int binCount) const;
+
+    bool WriteCsv(const std::filesystem::path &path) const;
+    bool WriteJson(const std::filesystem::path &path) const;
+};
@@ -1,7 +1,8 @@
 #include "im3d_impl.h"
 #include "camera_state.h"
-#include "screenstate.h"
+#include "ScreenState.h"
 #include <im3d.h>
+#include <im3d_context.h>
 #include <im3d_math.h>
 
 void Im3d_Impl_NewFrame(const camera::CameraState *c, const screenstate::ScreenState *window)
@@ -18,36 +19,24 @@ void Im3d_Impl_NewFrame(const camera::CameraState *c, const screenstate::ScreenS
     ad.m_projOrtho = false;
 
     // m_projScaleY controls how gizmos are scaled in world space to maintain a constant screen height
-    ad.m_projScaleY = tanf(c->fovYRadians * 0.5f) * 2.0f;
+    ad.m_projScaleY = c->projScaleY;
 
     // World space cursor ray from mouse position; for VR this might be the position/orientation of the HMD or a tracked controller.
     // auto &mouse = window->Mouse;
     Im3d::Vec2 cursorPos((float)window->MouseX, (float)window->MouseY);
     cursorPos = (cursorPos / ad.m_viewportSize) * 2.0f - 1.0f;
     cursorPos.y = -cursorPos.y; // window origin is top-left, ndc is bottom-left
-    Im3d::Vec3 rayOrigin, rayDirection;
-    {
-        rayOrigin = ad.m_viewOrigin;
-        rayDirection.x = cursorPos.x / c->projection[0];
-        rayDirection.y = cursorPos.y / c->projection[5];
-        rayDirection.z = -1.0f;
-        Im3d::Mat4 camWorld(
-            c->viewInverse[0], c->viewInverse[4], c->viewInverse[8], c->viewInverse[12],
-            c->viewInverse[1], c->viewInverse[5], c->viewInverse[9], c->viewInverse[13],
-            c->viewInverse[2], c->viewInverse[6], c->viewInverse[10], c->viewInverse[14],
-            c->viewInverse[3], c->viewInverse[7], c->viewInverse[11], c->viewInverse[15]);
-        rayDirection = camWorld * Im3d::Vec4(Im3d::Normalize(rayDirection), 0.0f);
-    }
-    ad.m_cursorRayOrigin = rayOrigin;
-    ad.m_cursorRayDirection = rayDirection;
+    auto rayDirection = c->CalcRayDirection(cursorPos.x, cursorPos.y);
+    ad.m_cursorRayOrigin = ad.m_viewOrigin;
+    ad.m_cursorRayDirection = Im3d::Vec3(rayDirection[0], rayDirection[1], rayDirection[2]);
 
     // Set cull frustum planes. This is only required if IM3D_CULL_GIZMOS or IM3D_CULL_PRIMTIIVES is enable via im3d_config.h, or if any of the IsVisible() functions are called.
-    Im3d::Mat4 viewProj(
-        c->viewProjection[0], c->viewProjection[1], c->viewProjection[2], c->viewProjection[3],
-        c->viewProjection[4], c->viewProjection[5], c->viewProjection[6], c->viewProjection[7],
-        c->viewProjection[8], c->viewProjection[9], c->viewProjection[10], c->viewProjection[11],
-        c->viewProjection[12], c->viewProjection[13], c->viewProjection[14], c->viewProjection[15]);
-    ad.setCullFrustum(viewProj, true);
+    // The planes are cached by the camera in Im3d::FrustumPlane order.
+    for (int i = 0; i < Im3d::FrustumPlane_Count; ++i)
+    {
+        auto &plane = c->frustumPlanes[i];
+        ad.m_cullFrustum[i] = Im3d::Vec4(plane[0], plane[1], plane[2], plane[3]);
+    }
 
     // Fill the key state array; using GetAsyncKeyState here but this could equally well be done via the window proc.
     // All key states have an equivalent (and more descriptive) 'Action_' enum.
@@ -0,0 +1,526 @@
+#include "im3d_shm.h"
+#include <im3d.h>
+#include <im3d_context.h>
+#include <plog/Log.h>
+#include <atomic>
+#include <cstring>
+#include <new>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+const uint32_t RING_MAGIC = 0x4d485349; // 'ISHM'
+const uint32_t RING_VERSION = 1;
+const uint32_t RECORD_ALIGN = 32;
+
+enum RecordType : uint32_t
+{
+    RecordType_Padding,    // skip to the start of the ring
+    RecordType_VertexList, // RecordHeader + vertexCount * Im3d::VertexData
+    RecordType_FrameEnd,
+};
+
+struct RecordHeader
+{
+    uint32_t type;
+    uint32_t size; // including the header, multiple of RECORD_ALIGN
+    uint32_t layerId;
+    uint32_t primType;
+    uint32_t vertexCount;
+    uint32_t reserved[3];
+};
+static_assert(sizeof(RecordHeader) == RECORD_ALIGN);
+static_assert(RECORD_ALIGN % alignof(Im3d::VertexData) == 0);
+
+struct RingHeader
+{
+    std::atomic<uint32_t> magic; // set last by the producer
+    uint32_t version;
+    uint32_t capacity;   // size of the record area in bytes
+    uint32_t vertexSize; // sizeof(Im3d::VertexData) of the producer
+    // monotonic byte positions, the record offset is pos % capacity
+    alignas(64) std::atomic<uint64_t> writePos; // end of the last published frame, producer owned
+    alignas(64) std::atomic<uint64_t> readPos;  // start of the oldest frame still in use, consumer owned
+    alignas(64) std::atomic<uint64_t> publishedFrames;
+    std::atomic<uint64_t> droppedFrames;
+    std::atomic<uint64_t> consumedFrames;
+    std::atomic<uint64_t> skippedFrames;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+const uint32_t RECORDS_OFFSET = (sizeof(RingHeader) + 63) & ~63u;
+
+uint32_t AlignRecord(uint64_t size)
+{
+    return (uint32_t)((size + RECORD_ALIGN - 1) & ~(uint64_t)(RECORD_ALIGN - 1));
+}
+
+Im3dShmStats GetRingStats(const RingHeader *header)
+{
+    Im3dShmStats stats;
+    if (header)
+    {
+        stats.PublishedFrames = header->publishedFrames.load(std::memory_order_relaxed);
+        stats.DroppedFrames = header->droppedFrames.load(std::memory_order_relaxed);
+        stats.ConsumedFrames = header->consumedFrames.load(std::memory_order_relaxed);
+        stats.SkippedFrames = header->skippedFrames.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+class SharedMemory
+{
+    void *m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    HANDLE m_mapping = nullptr;
+#else
+    std::string m_unlinkName; // set by the creator
+#endif
+
+public:
+    ~SharedMemory()
+    {
+#ifdef _WIN32
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+        }
+#else
+        if (m_data)
+        {
+            munmap(m_data, m_size);
+        }
+        if (!m_unlinkName.empty())
+        {
+            shm_unlink(m_unlinkName.c_str());
+        }
+#endif
+    }
+
+    void *GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+    bool Create(const std::string &name, size_t size)
+    {
+#ifdef _WIN32
+        m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, name.c_str());
+        if (!m_mapping)
+        {
+            LOGE << "CreateFileMapping: " << name;
+            return false;
+        }
+        m_data = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+#else
+        auto path = "/" + name;
+        int fd = shm_open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+        if (fd < 0)
+        {
+            LOGE << "shm_open: " << path;
+            return false;
+        }
+        m_unlinkName = path;
+        if (ftruncate(fd, (off_t)size) != 0)
+        {
+            LOGE << "ftruncate: " << path;
+            close(fd);
+            return false;
+        }
+        m_data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (m_data == MAP_FAILED)
+        {
+            m_data = nullptr;
+        }
+#endif
+        if (!m_data)
+        {
+            LOGE << "fail to map: " << name;
+            return false;
+        }
+        m_size = size;
+        return true;
+    }
+
+    bool Open(const std::string &name)
+    {
+#ifdef _WIN32
+        m_mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+        if (!m_mapping)
+        {
+            LOGE << "OpenFileMapping: " << name;
+            return false;
+        }
+        m_data = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (m_data)
+        {
+            MEMORY_BASIC_INFORMATION info;
+            VirtualQuery(m_data, &info, sizeof(info));
+            m_size = info.RegionSize;
+        }
+#else
+        auto path = "/" + name;
+        int fd = shm_open(path.c_str(), O_RDWR, 0600);
+        if (fd < 0)
+        {
+            LOGE << "shm_open: " << path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            m_size = (size_t)st.st_size;
+            m_data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (m_data == MAP_FAILED)
+            {
+                m_data = nullptr;
+            }
+        }
+        close(fd);
+#endif
+        if (!m_data)
+        {
+            LOGE << "fail to map: " << name;
+            return false;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+class Im3dShmProducerImpl
+{
+    SharedMemory m_shm;
+    RingHeader *m_header = nullptr;
+    uint8_t *m_records = nullptr;
+    uint64_t m_cursor = 0; // end of the frame being written, not yet visible to the consumer
+    bool m_overflow = false;
+
+public:
+    bool Create(const std::string &name, uint32_t capacity)
+    {
+        capacity = AlignRecord(capacity);
+        if (!m_shm.Create(name, RECORDS_OFFSET + (size_t)capacity))
+        {
+            return false;
+        }
+        m_header = new (m_shm.GetData()) RingHeader;
+        m_header->version = RING_VERSION;
+        m_header->capacity = capacity;
+        m_header->vertexSize = sizeof(Im3d::VertexData);
+        m_header->writePos.store(0, std::memory_order_relaxed);
+        m_header->readPos.store(0, std::memory_order_relaxed);
+        m_header->publishedFrames.store(0, std::memory_order_relaxed);
+        m_header->droppedFrames.store(0, std::memory_order_relaxed);
+        m_header->consumedFrames.store(0, std::memory_order_relaxed);
+        m_header->skippedFrames.store(0, std::memory_order_relaxed);
+        m_header->magic.store(RING_MAGIC, std::memory_order_release);
+        m_records = (uint8_t *)m_shm.GetData() + RECORDS_OFFSET;
+        return true;
+    }
+
+    bool IsCreated() const { return m_header != nullptr; }
+
+    // Reserve a contiguous record for the current frame, null if the consumer has not released enough space.
+    RecordHeader *Reserve(uint32_t size)
+    {
+        if (m_overflow)
+        {
+            return nullptr;
+        }
+        uint32_t capacity = m_header->capacity;
+        uint32_t offset = (uint32_t)(m_cursor % capacity);
+        uint32_t padding = (capacity - offset < size) ? capacity - offset : 0;
+        uint64_t readPos = m_header->readPos.load(std::memory_order_acquire);
+        if (size > capacity || m_cursor + padding + size - readPos > capacity)
+        {
+            m_overflow = true;
+            return nullptr;
+        }
+        if (padding)
+        {
+            auto pad = (RecordHeader *)(m_records + offset);
+            pad->type = RecordType_Padding;
+            pad->size = padding;
+            m_cursor += padding;
+            offset = 0;
+        }
+        auto record = (RecordHeader *)(m_records + offset);
+        record->size = size;
+        m_cursor += size;
+        return record;
+    }
+
+    bool Write(uint32_t layerId, uint32_t primType, const Im3d::VertexData *vertexData, uint32_t vertexCount)
+    {
+        auto record = Reserve(AlignRecord(sizeof(RecordHeader) + (uint64_t)vertexCount * sizeof(Im3d::VertexData)));
+        if (!record)
+        {
+            return false;
+        }
+        record->type = RecordType_VertexList;
+        record->layerId = layerId;
+        record->primType = primType;
+        record->vertexCount = vertexCount;
+        memcpy(record + 1, vertexData, vertexCount * sizeof(Im3d::VertexData));
+        return true;
+    }
+
+    bool Publish()
+    {
+        auto record = Reserve(sizeof(RecordHeader));
+        if (!record)
+        {
+            // drop the whole frame, nothing after writePos was visible to the consumer
+            m_cursor = m_header->writePos.load(std::memory_order_relaxed);
+            m_overflow = false;
+            m_header->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        record->type = RecordType_FrameEnd;
+        m_header->writePos.store(m_cursor, std::memory_order_release);
+        m_header->publishedFrames.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Im3dShmStats GetStats() const { return GetRingStats(m_header); }
+};
+
+class Im3dShmConsumerImpl
+{
+    SharedMemory m_shm;
+    RingHeader *m_header = nullptr;
+    const uint8_t *m_records = nullptr;
+    uint32_t m_capacity = 0;         // checked against the mapping size by Open(), the header is writable by the producer
+    uint64_t m_currentFrame = ~0ull; // start of the frame merged last time
+
+public:
+    bool Open(const std::string &name)
+    {
+        if (!m_shm.Open(name))
+        {
+            return false;
+        }
+        auto header = (RingHeader *)m_shm.GetData();
+        if (m_shm.GetSize() < RECORDS_OFFSET || header->magic.load(std::memory_order_acquire) != RING_MAGIC || header->version != RING_VERSION)
+        {
+            LOGE << name << ": not an im3d ring";
+            return false;
+        }
+        if (header->vertexSize != sizeof(Im3d::VertexData))
+        {
+            LOGE << name << ": VertexData size mismatch " << header->vertexSize << " != " << sizeof(Im3d::VertexData);
+            return false;
+        }
+        if (RECORDS_OFFSET + (size_t)header->capacity > m_shm.GetSize())
+        {
+            LOGE << name << ": truncated mapping";
+            return false;
+        }
+        if (header->capacity < sizeof(RecordHeader) || header->capacity % RECORD_ALIGN != 0)
+        {
+            LOGE << name << ": bad capacity " << header->capacity;
+            return false;
+        }
+        m_header = header;
+        m_records = (const uint8_t *)m_shm.GetData() + RECORDS_OFFSET;
+        m_capacity = header->capacity;
+        return true;
+    }
+
+    bool IsOpen() const { return m_header != nullptr; }
+
+    // Copy the header of the record at pos, false unless the record lies within [pos, end), before the end of the ring, and a
+    // vertex list fits its vertices.
+    bool ReadRecord(uint64_t pos, uint64_t end, RecordHeader *record) const
+    {
+        uint32_t offset = (uint32_t)(pos % m_capacity);
+        if (offset % RECORD_ALIGN != 0)
+        {
+            return false;
+        }
+        memcpy(record, m_records + offset, sizeof(RecordHeader));
+        if (record->size < sizeof(RecordHeader) || record->size % RECORD_ALIGN != 0 || record->size > m_capacity - offset || record->size > end - pos)
+        {
+            return false;
+        }
+        if (record->type == RecordType_VertexList && sizeof(RecordHeader) + (uint64_t)record->vertexCount * sizeof(Im3d::VertexData) > record->size)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    bool Merge(Im3d::Context &ctx)
+    {
+        uint64_t writePos = m_header->writePos.load(std::memory_order_acquire);
+        uint64_t readPos = m_header->readPos.load(std::memory_order_relaxed);
+        if (writePos < readPos || writePos - readPos > m_capacity)
+        {
+            LOGE << "corrupt ring positions " << readPos << ", " << writePos;
+            return false;
+        }
+
+        // find the start of the latest complete frame
+        uint64_t frameStart = readPos;
+        uint64_t latest = readPos;
+        uint64_t frameCount = 0;
+        for (uint64_t pos = readPos; pos < writePos;)
+        {
+            RecordHeader record;
+            if (!ReadRecord(pos, writePos, &record))
+            {
+                LOGE << "corrupt record at " << pos;
+                return false;
+            }
+            pos += record.size;
+            if (record.type == RecordType_FrameEnd)
+            {
+                latest = frameStart;
+                frameStart = pos;
+                ++frameCount;
+            }
+        }
+        if (frameCount == 0)
+        {
+            return false;
+        }
+
+        if (latest != m_currentFrame)
+        {
+            // readPos only ever points at the displayed frame, any other frame before latest was never merged
+            uint64_t skipped = frameCount - 1 - (m_currentFrame == readPos ? 1 : 0);
+            m_header->consumedFrames.fetch_add(1, std::memory_order_relaxed);
+            m_header->skippedFrames.fetch_add(skipped, std::memory_order_relaxed);
+            m_currentFrame = latest;
+            // release the older frames to the producer, keep latest until a newer frame arrives
+            m_header->readPos.store(latest, std::memory_order_release);
+        }
+
+        // append straight from the mapping, the headers are checked again as the producer may have rewritten them meanwhile
+        for (uint64_t pos = latest; pos < writePos;)
+        {
+            RecordHeader record;
+            if (!ReadRecord(pos, writePos, &record))
+            {
+                LOGE << "corrupt record at " << pos;
+                return false;
+            }
+            auto vertexData = (const Im3d::VertexData *)(m_records + pos % m_capacity + sizeof(RecordHeader));
+            pos += record.size;
+            if (record.type == RecordType_FrameEnd)
+            {
+                break;
+            }
+            if (record.type != RecordType_VertexList || record.primType >= Im3d::DrawPrimitive_Count)
+            {
+                continue;
+            }
+            ctx.appendVertexData(record.layerId, (Im3d::DrawPrimitiveType)record.primType, vertexData, record.vertexCount);
+        }
+        return true;
+    }
+
+    Im3dShmStats GetStats() const { return GetRingStats(m_header); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+Im3dShmProducer::Im3dShmProducer()
+    : m_impl(new Im3dShmProducerImpl)
+{
+}
+
+Im3dShmProducer::~Im3dShmProducer()
+{
+    delete m_impl;
+}
+
+bool Im3dShmProducer::Create(const std::string &name, uint32_t capacity)
+{
+    return m_impl->Create(name, capacity);
+}
+
+bool Im3dShmProducer::Write(uint32_t layerId, uint32_t primType, const Im3d::VertexData *vertexData, uint32_t vertexCount)
+{
+    if (!m_impl->IsCreated())
+    {
+        return false;
+    }
+    return m_impl->Write(layerId, primType, vertexData, vertexCount);
+}
+
+bool Im3dShmProducer::WriteDrawLists()
+{
+    auto &ctx = Im3d::GetContext();
+    for (Im3d::U32 i = 0; i < ctx.getDrawListCount(); ++i)
+    {
+        auto &drawList = ctx.getDrawLists()[i];
+        if (!Write(drawList.m_layerId, drawList.m_primType, drawList.m_vertexData, drawList.m_vertexCount))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Im3dShmProducer::Publish()
+{
+    if (!m_impl->IsCreated())
+    {
+        return false;
+    }
+    return m_impl->Publish();
+}
+
+Im3dShmStats Im3dShmProducer::GetStats() const
+{
+    return m_impl->GetStats();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Im3dShmConsumer::Im3dShmConsumer()
+    : m_impl(new Im3dShmConsumerImpl)
+{
+}
+
+Im3dShmConsumer::~Im3dShmConsumer()
+{
+    delete m_impl;
+}
+
+bool Im3dShmConsumer::Open(const std::string &name)
+{
+    return m_impl->Open(name);
+}
+
+bool Im3dShmConsumer::IsOpen() const
+{
+    return m_impl->IsOpen();
+}
+
+bool Im3dShmConsumer::Merge(Im3d::Context &ctx)
+{
+    if (!m_impl->IsOpen())
+    {
+        return false;
+    }
+    return m_impl->Merge(ctx);
+}
+
+Im3dShmStats Im3dShmConsumer::GetStats() const
+{
+    return m_impl->GetStats();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+namespace Im3d
+{
+class Context;
+struct VertexData;
+} // namespace Im3d
+
+///
+/// Shared-memory transport for Im3d vertex data between two processes on the same machine.
+///
+/// One producer writes whole frames of vertex lists into a lock-free ring and publishes them with a single release store.
+/// One consumer (a viewer) merges the latest published frame into its Im3d::Context straight out of the mapping.
+/// The frame being drawn stays in the ring until a newer one is available, so the ring should hold at least two frames.
+/// If the viewer falls behind, the producer drops whole frames instead of blocking.
+///
+struct Im3dShmStats
+{
+    uint64_t PublishedFrames = 0;
+    uint64_t DroppedFrames = 0;  // rejected by the producer, the ring was full
+    uint64_t ConsumedFrames = 0;
+    uint64_t SkippedFrames = 0;  // discarded by the consumer, a newer frame was available
+};
+
+class Im3dShmProducerImpl;
+class Im3dShmProducer
+{
+    Im3dShmProducerImpl *m_impl = nullptr;
+
+public:
+    Im3dShmProducer();
+    ~Im3dShmProducer();
+    // Create the named ring, capacity is the size of the record area in bytes.
+    bool Create(const std::string &name, uint32_t capacity = 8 * 1024 * 1024);
+    // Queue a vertex list for the current frame.
+    bool Write(uint32_t layerId, uint32_t primType, const Im3d::VertexData *vertexData, uint32_t vertexCount);
+    // Queue the draw lists of the current context, call after Im3d::EndFrame().
+    bool WriteDrawLists();
+    // Make the queued vertex lists visible to the consumer. Return false if the frame was dropped.
+    bool Publish();
+    Im3dShmStats GetStats() const;
+};
+
+class Im3dShmConsumerImpl;
+class Im3dShmConsumer
+{
+    Im3dShmConsumerImpl *m_impl = nullptr;
+
+public:
+    Im3dShmConsumer();
+    ~Im3dShmConsumer();
+    bool Open(const std::string &name);
+    bool IsOpen() const;
+    // Append the latest frame to ctx, call between Im3d::NewFrame() and Im3d::EndFrame(). Return false if nothing was published yet.
+    bool Merge(Im3d::Context &ctx);
+    Im3dShmStats GetStats() const;
+};
@@ -0,0 +1,199 @@
+#include "mesh_file.h"
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint64_t Align(uint64_t offset)
+{
+    return (offset + MeshFileAlignment - 1) / MeshFileAlignment * MeshFileAlignment;
+}
+
+bool WriteMeshFile(const std::filesystem::path &path, const float *vertices, uint32_t vertexCount, const uint32_t *indices,
+                   uint32_t indexCount)
+{
+    MeshFileHeader header;
+    header.VertexStride = sizeof(float) * 6;
+    header.VertexCount = vertexCount;
+    header.IndexSize = sizeof(uint32_t);
+    header.IndexCount = indexCount;
+    header.VertexOffset = Align(sizeof(header));
+    header.IndexOffset = Align(header.VertexOffset + (uint64_t)header.VertexStride * vertexCount);
+    header.AttributeCount = 2;
+    header.Attributes[0] = {MeshAttributeSemantic::Position, MeshAttributeFormat::Float32, 3, 0};
+    header.Attributes[1] = {MeshAttributeSemantic::Normal, MeshAttributeFormat::Float32, 3, 12};
+    if (vertexCount)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            header.BoundsMin[i] = header.BoundsMax[i] = vertices[i];
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                header.BoundsMin[i] = std::min(header.BoundsMin[i], vertices[v * 6 + i]);
+                header.BoundsMax[i] = std::max(header.BoundsMax[i], vertices[v * 6 + i]);
+            }
+        }
+    }
+
+    std::ofstream io(path, std::ios::binary | std::ios::trunc);
+    if (!io)
+    {
+        return false;
+    }
+    const char zero[MeshFileAlignment] = {};
+    io.write((const char *)&header, sizeof(header));
+    io.write(zero, header.VertexOffset - sizeof(header));
+    io.write((const char *)vertices, (uint64_t)header.VertexStride * vertexCount);
+    io.write(zero, header.IndexOffset - header.VertexOffset - (uint64_t)header.VertexStride * vertexCount);
+    io.write((const char *)indices, (uint64_t)header.IndexSize * indexCount);
+    return (bool)io;
+}
+
+MappedMeshFile::~MappedMeshFile()
+{
+    Close();
+}
+
+void MappedMeshFile::Close()
+{
+#ifdef _WIN32
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file)
+    {
+        CloseHandle(m_file);
+    }
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data)
+    {
+        munmap(m_data, m_size);
+    }
+    if (m_fd != -1)
+    {
+        close(m_fd);
+    }
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedMeshFile::Open(const std::filesystem::path &path)
+{
+    Close();
+#ifdef _WIN32
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+    m_size = size.QuadPart;
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Close();
+        return false;
+    }
+    m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m_data)
+    {
+        Close();
+        return false;
+    }
+#else
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd == -1)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || st.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+    m_size = st.st_size;
+    auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+    m_data = data;
+    // the whole file is uploaded right after opening
+    madvise(m_data, m_size, MADV_WILLNEED);
+#endif
+
+    // validate before any pointer is handed out
+    if (m_size < sizeof(MeshFileHeader))
+    {
+        Close();
+        return false;
+    }
+    MeshFileHeader expected;
+    auto &header = Header();
+    // offset is untrusted, compare against the remaining size so offset + size can't wrap
+    auto blockFits = [this](uint64_t offset, uint64_t size) { return offset <= m_size && size <= m_size - offset; };
+    if (memcmp(header.Magic, expected.Magic, sizeof(header.Magic)) != 0 || header.Version != expected.Version ||
+        (header.IndexSize != 2 && header.IndexSize != 4) || header.AttributeCount > MeshFileMaxAttributes ||
+        header.VertexOffset % MeshFileAlignment != 0 || header.IndexOffset % MeshFileAlignment != 0 ||
+        !blockFits(header.VertexOffset, (uint64_t)header.VertexStride * header.VertexCount) ||
+        !blockFits(header.IndexOffset, (uint64_t)header.IndexSize * header.IndexCount))
+    {
+        Close();
+        return false;
+    }
+    // an out of range index would read past the vertex buffer on the GPU
+    auto validIndices = [&header](auto *indices) {
+        for (uint32_t i = 0; i < header.IndexCount; ++i)
+        {
+            if (indices[i] >= header.VertexCount)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (header.IndexSize == 2 ? !validIndices((const uint16_t *)Indices()) : !validIndices((const uint32_t *)Indices()))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedMeshFile::IsPositionNormalUInt32() const
+{
+    auto &header = Header();
+    return header.VertexStride == sizeof(float) * 6 && header.IndexSize == 4 && header.AttributeCount >= 2 &&
+           header.Attributes[0].Semantic == MeshAttributeSemantic::Position &&
+           header.Attributes[0].Format == MeshAttributeFormat::Float32 && header.Attributes[0].Components == 3 &&
+           header.Attributes[0].Offset == 0 && header.Attributes[1].Semantic == MeshAttributeSemantic::Normal &&
+           header.Attributes[1].Format == MeshAttributeFormat::Float32 && header.Attributes[1].Components == 3 &&
+           header.Attributes[1].Offset == 12;
+}
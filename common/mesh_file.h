@@ -0,0 +1,90 @@
+#pragma once
+#include <filesystem>
+#include <stdint.h>
+
+///
+/// Binary mesh container that is used in place through a read-only memory mapping.
+///
+/// [MeshFileHeader][pad][vertex block][pad][index block]
+/// Blocks start at MeshFileAlignment boundaries so the mapped pointers can be handed to glBufferData/CreateBuffer directly.
+/// All values are little endian.
+///
+enum class MeshAttributeSemantic : uint8_t
+{
+    None,
+    Position,
+    Normal,
+    TexCoord,
+    Color,
+};
+
+enum class MeshAttributeFormat : uint8_t
+{
+    None,
+    Float32,
+    UNorm8,
+};
+
+struct MeshFileAttribute
+{
+    MeshAttributeSemantic Semantic;
+    MeshAttributeFormat Format;
+    uint8_t Components;
+    uint8_t Offset; // in the vertex
+};
+
+const uint32_t MeshFileAlignment = 64;
+const uint32_t MeshFileMaxAttributes = 8;
+
+struct MeshFileHeader
+{
+    char Magic[4] = {'M', 'E', 'S', 'H'};
+    uint32_t Version = 1;
+    uint32_t VertexStride = 0;
+    uint32_t VertexCount = 0;
+    uint32_t IndexSize = 4; // 2 or 4
+    uint32_t IndexCount = 0;
+    uint64_t VertexOffset = 0; // from the file start
+    uint64_t IndexOffset = 0;
+    uint32_t AttributeCount = 0;
+    MeshFileAttribute Attributes[MeshFileMaxAttributes] = {};
+    float BoundsMin[3] = {};
+    float BoundsMax[3] = {};
+    uint32_t Reserved = 0;
+};
+static_assert(sizeof(MeshFileHeader) == 104, "sizeof(MeshFileHeader)");
+
+// position(xyz) + normal(xyz) float32, uint32 indices. the layout GL3Renderer::RegisterMesh and DX11Renderer::SetMesh take
+bool WriteMeshFile(const std::filesystem::path &path, const float *vertices, uint32_t vertexCount, const uint32_t *indices,
+                   uint32_t indexCount);
+
+class MappedMeshFile
+{
+    void *m_data = nullptr;
+    uint64_t m_size = 0;
+#ifdef _WIN32
+    void *m_file = nullptr;
+    void *m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+
+public:
+    MappedMeshFile() = default;
+    ~MappedMeshFile();
+    MappedMeshFile(const MappedMeshFile &) = delete;
+    MappedMeshFile &operator=(const MappedMeshFile &) = delete;
+
+    // map the file and validate the header, the blocks are paged in on first access
+    bool Open(const std::filesystem::path &path);
+    void Close();
+    bool IsOpen() const { return m_data != nullptr; }
+
+    const MeshFileHeader &Header() const { return *(const MeshFileHeader *)m_data; }
+    const void *Vertices() const { return (const uint8_t *)m_data + Header().VertexOffset; }
+    const void *Indices() const { return (const uint8_t *)m_data + Header().IndexOffset; }
+    uint32_t VertexCount() const { return Header().VertexCount; }
+    uint32_t IndexCount() const { return Header().IndexCount; }
+    // true if the layout is the one WriteMeshFile produces
+    bool IsPositionNormalUInt32() const;
+};
@@ -0,0 +1,62 @@
+#include "telemetry_window.h"
+#include <frame_telemetry.h>
+#include <imgui.h>
+#include <plog/Log.h>
+#include <float.h>
+
+void ShowTelemetryWindow(FrameTelemetry &telemetry, bool *p_open)
+{
+    if (!ImGui::Begin("frame telemetry", p_open))
+    {
+        ImGui::End();
+        return;
+    }
+
+    auto total = telemetry.CalcStats(FramePhase::Count);
+    ImGui::Text("%d frames, p50 %.2f ms, p99 %.2f ms", telemetry.Size(), total.P50, total.P99);
+
+    // frame total over time, oldest first
+    ImGui::PlotLines(
+        "frame", [](void *data, int i) { return ((FrameTelemetry *)data)->Value(i, FramePhase::Count); }, &telemetry,
+        telemetry.Size(), 0, nullptr, 0.0f, total.Max, ImVec2(0, 60));
+
+    const int BIN_COUNT = 32;
+    float bins[BIN_COUNT];
+    auto histogramMax = total.P99 > 0 ? total.P99 * 1.25f : 1.0f;
+    telemetry.CalcHistogram(FramePhase::Count, histogramMax, bins, BIN_COUNT);
+    ImGui::PlotHistogram("histogram", bins, BIN_COUNT, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+    ImGui::Text("0 .. %.2f ms", histogramMax);
+
+    ImGui::Separator();
+    ImGui::Text("%-14s %7s %7s %7s %7s %7s", "phase (ms)", "mean", "p50", "p95", "p99", "max");
+    for (int i = 0; i <= FrameTelemetry::PhaseCount; ++i)
+    {
+        auto stats = telemetry.CalcStats((FramePhase)i);
+        ImGui::Text("%-14s %7.3f %7.3f %7.3f %7.3f %7.3f", FramePhaseName((FramePhase)i), stats.Mean, stats.P50, stats.P95,
+                    stats.P99, stats.Max);
+    }
+
+    ImGui::Separator();
+    if (ImGui::Button("export csv"))
+    {
+        if (telemetry.WriteCsv("frame_telemetry.csv"))
+        {
+            LOGI << "frame_telemetry.csv";
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("export json"))
+    {
+        if (telemetry.WriteJson("frame_telemetry.json"))
+        {
+            LOGI << "frame_telemetry.json";
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("clear"))
+    {
+        telemetry.Clear();
+    }
+
+    ImGui::End();
+}
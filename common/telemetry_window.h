@@ -0,0 +1,5 @@
+#pragma once
+
+class FrameTelemetry;
+// percentiles, frame time plot and histogram of the collected frames, CSV/JSON export
+void ShowTelemetryWindow(FrameTelemetry &telemetry, bool *p_open);
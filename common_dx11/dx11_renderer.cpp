@@ -30,12 +30,28 @@ static ComPtr<ID3DBlob> LoadCompileShader(const std::string &src, const char *na
     return ret;
 }
 
+struct ConstantBuffer
+{
+    std::array<float, 16> World;
+    std::array<float, 16> ViewProjection;
+};
+static_assert(sizeof(ConstantBuffer) == sizeof(float) * 16 * 2);
+
 class DX11RendererImpl
 {
     int m_width = 0;
     int m_height = 0;
     Dx11RenderTarget m_rt;
 
+    ComPtr<ID3D11VertexShader> m_vs;
+    ComPtr<ID3D11PixelShader> m_ps;
+    ComPtr<ID3D11InputLayout> m_inputLayout;
+    ComPtr<ID3D11Buffer> m_vb;
+    ComPtr<ID3D11Buffer> m_ib;
+    UINT m_indexCount = 0;
+    ComPtr<ID3D11Buffer> m_cb;
+    ComPtr<ID3D11RasterizerState> m_rasterizerState;
+
 public:
     void *NewFrameToRenderTarget(ID3D11DeviceContext *deviceContext, int width, int height, const float *clear)
     {
@@ -75,45 +91,14 @@ public:
 
         return m_rt.m_srv.Get();
     }
-};
-
-DX11Renderer::DX11Renderer()
-    : m_impl(new DX11RendererImpl)
-{
-}
-
-DX11Renderer::~DX11Renderer()
-{
-    delete m_impl;
-}
-
-void *DX11Renderer::NewFrameToRenderTarget(void *deviceContext, int width, int height, const float *clear)
-{
-    return m_impl->NewFrameToRenderTarget((ID3D11DeviceContext *)deviceContext, width, height, clear);
-}
-
-struct ConstantBuffer
-{
-    std::array<float, 16> World;
-    std::array<float, 16> ViewProjection;
-};
-static_assert(sizeof(ConstantBuffer) == sizeof(float) * 16 * 2);
-
-void DX11Renderer::DrawTeapot(void *deviceContext, const float *viewProjection, const float *world)
-{
-    static ComPtr<ID3D11VertexShader> s_vs;
-    static ComPtr<ID3D11PixelShader> s_ps;
-    static ComPtr<ID3D11InputLayout> s_inputLayout;
-    static ComPtr<ID3D11Buffer> s_vb;
-    static ComPtr<ID3D11Buffer> s_ib;
-    static ComPtr<ID3D11Buffer> s_cb;
-    static ComPtr<ID3D11RasterizerState> s_rasterizerState;
 
-    auto ctx = (ID3D11DeviceContext *)deviceContext;
-    ComPtr<ID3D11Device> d3d;
-    ctx->GetDevice(&d3d);
-    if (!s_vs)
+    bool Initialize(ID3D11Device *d3d)
     {
+        if (m_vs)
+        {
+            return true;
+        }
+
         D3D_SHADER_MACRO vsMacro[] =
             {
                 {
@@ -124,20 +109,20 @@ void DX11Renderer::DrawTeapot(void *deviceContext, const float *viewProjection,
         auto vsBlob = LoadCompileShader(g_hlsl, "model.hlsl@vs", vsMacro, "vs_4_0");
         if (!vsBlob)
         {
-            return;
+            return false;
         }
-        if (FAILED(d3d->CreateVertexShader((DWORD *)vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &s_vs)))
+        if (FAILED(d3d->CreateVertexShader((DWORD *)vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &m_vs)))
         {
-            return;
+            return false;
         }
 
         // create layout for vs
         D3D11_INPUT_ELEMENT_DESC inputDesc[] = {
             {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
             {"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0}};
-        if (FAILED(d3d->CreateInputLayout(inputDesc, 2, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), &s_inputLayout)))
+        if (FAILED(d3d->CreateInputLayout(inputDesc, 2, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), &m_inputLayout)))
         {
-            return;
+            return false;
         }
 
         D3D_SHADER_MACRO psMacro[] =
@@ -150,97 +135,152 @@ void DX11Renderer::DrawTeapot(void *deviceContext, const float *viewProjection,
         auto psBlob = LoadCompileShader(g_hlsl, "model.hlsl@ps", psMacro, "ps_4_0");
         if (!psBlob)
         {
-            return;
+            return false;
         }
-        if (FAILED(d3d->CreatePixelShader((DWORD *)psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &s_ps)))
+        if (FAILED(d3d->CreatePixelShader((DWORD *)psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &m_ps)))
         {
-            return;
+            return false;
         }
 
         {
-            D3D11_BUFFER_DESC desc = {0};
-            desc.ByteWidth = sizeof(s_teapotVertices);
-            desc.Usage = D3D11_USAGE_IMMUTABLE;
-            desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+            D3D11_BUFFER_DESC desc = {};
+            desc.ByteWidth = sizeof(float) * 16 * 2;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+            // desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-            D3D11_SUBRESOURCE_DATA subRes = {0};
-            subRes.pSysMem = s_teapotVertices;
-            if (FAILED(d3d->CreateBuffer(&desc, &subRes, &s_vb)))
+            if (FAILED(d3d->CreateBuffer(&desc, nullptr, &m_cb)))
             {
-                return;
+                return false;
             }
         }
 
+        D3D11_RASTERIZER_DESC rasterizerDesc = {0};
+        rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+        rasterizerDesc.CullMode = D3D11_CULL_BACK;
+        rasterizerDesc.FrontCounterClockwise = true;
+        if (FAILED(d3d->CreateRasterizerState(&rasterizerDesc, &m_rasterizerState)))
+        {
+            return false;
+        }
+
+        return SetMesh(d3d, s_teapotVertices, sizeof(s_teapotVertices) / (sizeof(float) * 6), s_teapotIndices,
+                       sizeof(s_teapotIndices) / sizeof(unsigned));
+    }
+
+    bool SetMesh(ID3D11Device *d3d, const float *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount)
+    {
+        ComPtr<ID3D11Buffer> vb;
         {
             D3D11_BUFFER_DESC desc = {0};
-            desc.ByteWidth = sizeof(s_teapotIndices);
+            desc.ByteWidth = sizeof(float) * 6 * vertexCount;
             desc.Usage = D3D11_USAGE_IMMUTABLE;
-            desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+            desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 
             D3D11_SUBRESOURCE_DATA subRes = {0};
-            subRes.pSysMem = s_teapotIndices;
-            if (FAILED(d3d->CreateBuffer(&desc, &subRes, &s_ib)))
+            subRes.pSysMem = vertices;
+            if (FAILED(d3d->CreateBuffer(&desc, &subRes, &vb)))
             {
-                return;
+                return false;
             }
         }
 
+        ComPtr<ID3D11Buffer> ib;
         {
-            D3D11_BUFFER_DESC desc = {};
-            desc.ByteWidth = sizeof(float) * 16 * 2;
-            desc.Usage = D3D11_USAGE_DEFAULT;
-            desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-            // desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            D3D11_BUFFER_DESC desc = {0};
+            desc.ByteWidth = sizeof(uint32_t) * indexCount;
+            desc.Usage = D3D11_USAGE_IMMUTABLE;
+            desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
-            if (FAILED(d3d->CreateBuffer(&desc, nullptr, &s_cb)))
+            D3D11_SUBRESOURCE_DATA subRes = {0};
+            subRes.pSysMem = indices;
+            if (FAILED(d3d->CreateBuffer(&desc, &subRes, &ib)))
             {
-                return;
+                return false;
             }
         }
 
-        D3D11_RASTERIZER_DESC rasterizerDesc = {0};
-        rasterizerDesc.FillMode = D3D11_FILL_SOLID;
-        rasterizerDesc.CullMode = D3D11_CULL_BACK;
-        rasterizerDesc.FrontCounterClockwise = true;
-        if (FAILED(d3d->CreateRasterizerState(&rasterizerDesc, &s_rasterizerState)))
+        m_vb = vb;
+        m_ib = ib;
+        m_indexCount = indexCount;
+        return true;
+    }
+
+    void DrawTeapot(ID3D11DeviceContext *ctx, const float *viewProjection, const float *world)
+    {
+        ComPtr<ID3D11Device> d3d;
+        ctx->GetDevice(&d3d);
+        if (!Initialize(d3d.Get()))
         {
             return;
         }
+
+        static std::array<float, 16> identity = {
+            1.0f, 0, 0, 0,
+            0, 1.0f, 0, 0,
+            0, 0, 1.0f, 0,
+            0, 0, 0, 1.0f};
+
+        ConstantBuffer data{
+            .World = *(const std::array<float, 16> *)world,
+            // .World = identity,
+            .ViewProjection = *(const std::array<float, 16> *)viewProjection,
+            // .ViewProjection = identity,
+        };
+        ctx->UpdateSubresource(m_cb.Get(), 0, nullptr, &data, 0, 0);
+
+        unsigned int stride = 4 * 3 * 2;
+        unsigned int offset = 0;
+        ctx->IASetInputLayout(m_inputLayout.Get());
+        ID3D11Buffer *vb_list[] =
+            {
+                m_vb.Get()};
+        ctx->IASetVertexBuffers(0, 1, vb_list, &stride, &offset);
+        ctx->IASetIndexBuffer(m_ib.Get(), DXGI_FORMAT_R32_UINT, 0);
+        ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        ctx->VSSetShader(m_vs.Get(), nullptr, 0);
+        ID3D11Buffer *cb_list[] =
+            {
+                m_cb.Get()};
+        ctx->VSSetConstantBuffers(0, 1, cb_list);
+        ctx->PSSetShader(m_ps.Get(), nullptr, 0);
+
+        ctx->OMSetBlendState(nullptr, nullptr, 0xffffffff);
+        ctx->OMSetDepthStencilState(nullptr, 0);
+        ctx->RSSetState(m_rasterizerState.Get());
+
+        ctx->DrawIndexed(m_indexCount, 0, 0);
     }
+};
 
-    static std::array<float, 16> identity = {
-        1.0f, 0, 0, 0,
-        0, 1.0f, 0, 0,
-        0, 0, 1.0f, 0,
-        0, 0, 0, 1.0f};
-
-    ConstantBuffer data{
-        .World = *(const std::array<float, 16> *)world,
-        // .World = identity,
-        .ViewProjection = *(const std::array<float, 16> *)viewProjection,
-        // .ViewProjection = identity,
-    };
-    ctx->UpdateSubresource(s_cb.Get(), 0, nullptr, &data, 0, 0);
-
-    unsigned int stride = 4 * 3 * 2;
-    unsigned int offset = 0;
-    ctx->IASetInputLayout(s_inputLayout.Get());
-    ID3D11Buffer *vb_list[] =
-        {
-            s_vb.Get()};
-    ctx->IASetVertexBuffers(0, 1, vb_list, &stride, &offset);
-    ctx->IASetIndexBuffer(s_ib.Get(), DXGI_FORMAT_R32_UINT, 0);
-    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    ctx->VSSetShader(s_vs.Get(), nullptr, 0);
-    ID3D11Buffer *cb_list[] =
-        {
-            s_cb.Get()};
-    ctx->VSSetConstantBuffers(0, 1, cb_list);
-    ctx->PSSetShader(s_ps.Get(), nullptr, 0);
+DX11Renderer::DX11Renderer()
+    : m_impl(new DX11RendererImpl)
+{
+}
+
+DX11Renderer::~DX11Renderer()
+{
+    delete m_impl;
+}
 
-    ctx->OMSetBlendState(nullptr, nullptr, 0xffffffff);
-    ctx->OMSetDepthStencilState(nullptr, 0);
-    ctx->RSSetState(s_rasterizerState.Get());
+void *DX11Renderer::NewFrameToRenderTarget(void *deviceContext, int width, int height, const float *clear)
+{
+    return m_impl->NewFrameToRenderTarget((ID3D11DeviceContext *)deviceContext, width, height, clear);
+}
+
+void DX11Renderer::DrawTeapot(void *deviceContext, const float *viewProjection, const float *world)
+{
+    m_impl->DrawTeapot((ID3D11DeviceContext *)deviceContext, viewProjection, world);
+}
 
-    ctx->DrawIndexed(sizeof(s_teapotIndices) / sizeof(unsigned), 0, 0);
+bool DX11Renderer::SetMesh(void *deviceContext, const float *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount)
+{
+    auto ctx = (ID3D11DeviceContext *)deviceContext;
+    ComPtr<ID3D11Device> d3d;
+    ctx->GetDevice(&d3d);
+    if (!m_impl->Initialize(d3d.Get()))
+    {
+        return false;
+    }
+    return m_impl->SetMesh(d3d.Get(), vertices, vertexCount, indices, indexCount);
 }
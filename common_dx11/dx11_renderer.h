@@ -1,4 +1,5 @@
 #pragma once
+#include <stdint.h>
 
 class DX11RendererImpl;
 class DX11Renderer
@@ -10,4 +11,7 @@ public:
     ~DX11Renderer();
     void* NewFrameToRenderTarget(void *deviceContext, int width, int height, const float *clear);
     void DrawTeapot(void *deviceContext, const float *viewProjection, const float *world);
+    // Replace the teapot with an indexed mesh, position(xyz) + normal(xyz) and uint32 indices, e.g. from a MappedMeshFile.
+    // The data is read straight from the given pointers into immutable buffers.
+    bool SetMesh(void *deviceContext, const float *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount);
 };
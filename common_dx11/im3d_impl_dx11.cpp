@@ -248,6 +248,7 @@ class Im3dImplDx11Impl
     ComPtr<ID3D11BlendState> g_Im3dBlendState;
     ComPtr<ID3D11DepthStencilState> g_Im3dDepthStencilState;
     ComPtr<ID3D11Buffer> g_Im3dConstantBuffer;
+    float m_uploadedConstants[18] = {}; // last view-proj/viewport written to g_Im3dConstantBuffer
     ComPtr<ID3D11Buffer> g_Im3dVertexBuffer;
 
     bool Initialize(const ComPtr<ID3D11Device> &d3d)
@@ -436,7 +437,13 @@ public:
         Layout layout{
             .m_viewProj = *(const Im3d::Mat4 *)viewProjection,
             .m_viewport = ad.m_viewportSize};
-        ctx->UpdateSubresource(g_Im3dConstantBuffer.Get(), 0, nullptr, &layout, 0, 0);
+        static_assert(sizeof(layout) == sizeof(m_uploadedConstants));
+        if (memcmp(&layout, m_uploadedConstants, sizeof(layout)) != 0)
+        {
+            // the camera caches viewProjection, skip the upload while it does not move
+            ctx->UpdateSubresource(g_Im3dConstantBuffer.Get(), 0, nullptr, &layout, 0, 0);
+            memcpy(m_uploadedConstants, &layout, sizeof(layout));
+        }
 
         ctx->RSSetState(g_Im3dRasterizerState.Get());
         ctx->OMSetDepthStencilState(g_Im3dDepthStencilState.Get(), 0);
@@ -1,6 +1,7 @@
 #include "gl3_renderer.h"
 #include "shader_source.h"
 #include <array>
+#include <vector>
 #include <sstream>
 #include <fstream>
 
@@ -12,18 +13,6 @@ const std::string g_glsl =
 #include "../shaders/model.glsl"
     ;
 
-///
-/// GL3Renderer
-///
-GL3Renderer::GL3Renderer(const std::string &version)
-    : m_version(version)
-{
-}
-
-GL3Renderer::~GL3Renderer()
-{
-}
-
 void GL3Renderer::NewFrame(int screenWidth, int screenHeight)
 {
     glClearColor(0.5f, 0.5f, 0.5f, 0.0f);
@@ -86,7 +75,8 @@ static bool LinkShaderProgram(GLuint _handle)
     return true;
 }
 
-unsigned int CreateShader(const std::string &debugName, const std::string &vsSrc, const std::string &fsSrc)
+unsigned int CreateShader(const std::string &debugName, const std::string &vsSrc, const std::string &fsSrc,
+                          const std::vector<std::string> &attributeNames)
 {
     auto vs = CompileShader(debugName + "@vs", GL_VERTEX_SHADER, vsSrc);
     if (!vs)
@@ -102,6 +92,10 @@ unsigned int CreateShader(const std::string &debugName, const std::string &vsSrc
     auto shTeapot = glCreateProgram();
     glAttachShader(shTeapot, vs);
     glAttachShader(shTeapot, fs);
+    for (size_t i = 0; i < attributeNames.size(); ++i)
+    {
+        glBindAttribLocation(shTeapot, (GLuint)i, attributeNames[i].c_str());
+    }
     bool ret = LinkShaderProgram(shTeapot);
     glDeleteShader(vs);
     glDeleteShader(fs);
@@ -112,56 +106,284 @@ unsigned int CreateShader(const std::string &debugName, const std::string &vsSrc
     return shTeapot;
 }
 
-void GL3Renderer::DrawTeapot(const float *viewProjection, const float *world)
+static ShaderSource ModelShaderSource(const std::string &version, const char *stage, bool instanced)
 {
-    static GLuint shTeapot = 0;
-    static GLuint vbTeapot = 0;
-    static GLuint ibTeapot = 0;
-    static GLuint vaTeapot = 0;
-    if (shTeapot == 0)
-    {
-        auto vs = ShaderSource(g_glsl, m_version);
-        vs.Define("VERTEX_SHADER");
-        if(m_version=="#version 300 es")
+    auto src = ShaderSource(g_glsl, version);
+    src.Define(stage);
+    if (instanced)
+    {
+        src.Define("INSTANCED");
+    }
+    if (version == "#version 300 es")
+    {
+        if (std::string(stage) == "FRAGMENT_SHADER")
         {
-            vs.Replace("noperspective", "");
+            src.Insert("precision mediump float;\n");
         }
+        src.Replace("noperspective", "");
+    }
+    return src;
+}
+
+// the VAOs are shared by both programs, so the locations are fixed. aWorldMatrix takes 4 locations
+static const std::vector<std::string> g_modelAttributes = {"aPosition", "aNormal", "aWorldMatrix"};
+const GLuint ATTRIBUTE_WORLD_MATRIX = 2;
 
-        auto fs = ShaderSource(g_glsl, m_version);
-        fs.Define("FRAGMENT_SHADER");
-        if(m_version=="#version 300 es")
+// glVertexAttribDivisor is core in GL 3.3 and GLES 3.0, a GL 3.1/3.2 context needs ARB_instanced_arrays
+static bool HasInstancedArrays()
+{
+#if defined(RENDERER_GLEW)
+    return GLEW_VERSION_3_3 || (GLEW_VERSION_3_1 && GLEW_ARB_instanced_arrays);
+#else
+    return true;
+#endif
+}
+
+static void VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+#if defined(RENDERER_GLEW)
+    if (!GLEW_VERSION_3_3)
+    {
+        glVertexAttribDivisorARB(index, divisor);
+        return;
+    }
+#endif
+    glVertexAttribDivisor(index, divisor);
+}
+
+class GL3RendererImpl
+{
+    struct Mesh
+    {
+        GLuint VertexArray;
+        GLuint VertexBuffer;
+        GLuint IndexBuffer;
+        GLsizei IndexCount;
+    };
+    std::vector<Mesh> m_meshes;
+
+    // single draw
+    GLuint m_shader = 0;
+    GLint m_uWorldMatrix = -1;
+    GLint m_uViewProjMatrix = -1;
+
+    // instanced draw
+    GLuint m_shaderInstanced = 0;
+    GLint m_uViewProjMatrixInstanced = -1;
+    GLint m_aWorldMatrix = -1; // -1 without instanced arrays, DrawMeshes() then draws one instance at a time with m_shader
+    GLuint m_instanceBuffer = 0;
+    GLsizeiptr m_instanceBufferSize = 0;
+
+    uint32_t m_teapot = 0;
+
+public:
+    GL3RendererImpl(const std::string &version)
+    {
+        m_shader = CreateShader("model.glsl", ModelShaderSource(version, "VERTEX_SHADER", false).GetSource(),
+                                ModelShaderSource(version, "FRAGMENT_SHADER", false).GetSource(), g_modelAttributes);
+        m_uWorldMatrix = glGetUniformLocation(m_shader, "uWorldMatrix");
+        m_uViewProjMatrix = glGetUniformLocation(m_shader, "uViewProjMatrix");
+
+        m_shaderInstanced = CreateShader("model.glsl@instanced", ModelShaderSource(version, "VERTEX_SHADER", true).GetSource(),
+                                         ModelShaderSource(version, "FRAGMENT_SHADER", true).GetSource(), g_modelAttributes);
+        m_uViewProjMatrixInstanced = glGetUniformLocation(m_shaderInstanced, "uViewProjMatrix");
+        m_aWorldMatrix = m_shaderInstanced && HasInstancedArrays() ? (GLint)ATTRIBUTE_WORLD_MATRIX : -1;
+        glGenBuffers(1, &m_instanceBuffer);
+
+        m_teapot = RegisterMesh(s_teapotVertices, sizeof(s_teapotVertices) / (sizeof(float) * 6), s_teapotIndices,
+                                sizeof(s_teapotIndices) / sizeof(unsigned));
+    }
+
+    ~GL3RendererImpl()
+    {
+        for (auto &mesh : m_meshes)
         {
-            fs.Insert("precision mediump float;\n");
-            fs.Replace("noperspective", "");
+            glDeleteVertexArrays(1, &mesh.VertexArray);
+            glDeleteBuffers(1, &mesh.VertexBuffer);
+            glDeleteBuffers(1, &mesh.IndexBuffer);
         }
+        glDeleteBuffers(1, &m_instanceBuffer);
+        glDeleteProgram(m_shader);
+        glDeleteProgram(m_shaderInstanced);
+    }
 
-        shTeapot = CreateShader("model.glsl", vs.GetSource(), fs.GetSource());
-        glGenBuffers(1, &vbTeapot);
-        glGenBuffers(1, &ibTeapot);
-        glGenVertexArrays(1, &vaTeapot);
-        glBindVertexArray(vaTeapot);
-        glBindBuffer(GL_ARRAY_BUFFER, vbTeapot);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3 * 2, (GLvoid *)0);
-        glEnableVertexAttribArray(1);
+    uint32_t RegisterMesh(const float *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount)
+    {
+        Mesh mesh{
+            .IndexCount = (GLsizei)indexCount,
+        };
+        glGenBuffers(1, &mesh.VertexBuffer);
+        glGenBuffers(1, &mesh.IndexBuffer);
+        glGenVertexArrays(1, &mesh.VertexArray);
+        glBindVertexArray(mesh.VertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.VertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * vertexCount, (GLvoid *)vertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 6, (GLvoid *)0);
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 6, (GLvoid *)(sizeof(float) * 3));
-        glBufferData(GL_ARRAY_BUFFER, sizeof(s_teapotVertices), (GLvoid *)s_teapotVertices, GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibTeapot);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(s_teapotIndices), (GLvoid *)s_teapotIndices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.IndexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * indexCount, (GLvoid *)indices, GL_STATIC_DRAW);
+
+        // per instance world matrix, the offset into the instance buffer is set per draw
+        if (m_aWorldMatrix >= 0)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+            for (int c = 0; c < 4; ++c)
+            {
+                glEnableVertexAttribArray(m_aWorldMatrix + c);
+                glVertexAttribPointer(m_aWorldMatrix + c, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 16, (GLvoid *)(sizeof(float) * 4 * c));
+                VertexAttribDivisor(m_aWorldMatrix + c, 1);
+            }
+        }
         glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_meshes.push_back(mesh);
+        return (uint32_t)m_meshes.size() - 1;
     }
-    glUseProgram(shTeapot);
-    glUniformMatrix4fv(glGetUniformLocation(shTeapot, "uWorldMatrix"), 1, false, world);
-    glUniformMatrix4fv(glGetUniformLocation(shTeapot, "uViewProjMatrix"), 1, false, viewProjection);
-    glBindVertexArray(vaTeapot);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glDrawElements(GL_TRIANGLES, sizeof(s_teapotIndices) / sizeof(unsigned), GL_UNSIGNED_INT, (GLvoid *)0);
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
-    glBindVertexArray(0);
-    glUseProgram(0);
+
+    void DrawTeapot(const float *viewProjection, const float *world)
+    {
+        auto &mesh = m_meshes[m_teapot];
+        glUseProgram(m_shader);
+        glUniformMatrix4fv(m_uWorldMatrix, 1, false, world);
+        glUniformMatrix4fv(m_uViewProjMatrix, 1, false, viewProjection);
+        glBindVertexArray(mesh.VertexArray);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        glDrawElements(GL_TRIANGLES, mesh.IndexCount, GL_UNSIGNED_INT, (GLvoid *)0);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+    // one draw per instance, for contexts without instanced arrays
+    void DrawMeshesSingle(const float *viewProjection, const GL3MeshInstances *batches, uint32_t batchCount)
+    {
+        glUseProgram(m_shader);
+        glUniformMatrix4fv(m_uViewProjMatrix, 1, false, viewProjection);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        for (uint32_t i = 0; i < batchCount; ++i)
+        {
+            auto &batch = batches[i];
+            if (batch.Count == 0 || batch.Mesh >= m_meshes.size())
+            {
+                continue;
+            }
+            auto &mesh = m_meshes[batch.Mesh];
+            glBindVertexArray(mesh.VertexArray);
+            for (uint32_t j = 0; j < batch.Count; ++j)
+            {
+                glUniformMatrix4fv(m_uWorldMatrix, 1, false, batch.WorldMatrices + 16 * j);
+                glDrawElements(GL_TRIANGLES, mesh.IndexCount, GL_UNSIGNED_INT, (GLvoid *)0);
+            }
+        }
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+    void DrawMeshes(const float *viewProjection, const GL3MeshInstances *batches, uint32_t batchCount)
+    {
+        if (m_aWorldMatrix < 0)
+        {
+            DrawMeshesSingle(viewProjection, batches, batchCount);
+            return;
+        }
+
+        // upload every batch into one buffer, orphaning last frame's storage
+        GLsizeiptr size = 0;
+        for (uint32_t i = 0; i < batchCount; ++i)
+        {
+            size += sizeof(float) * 16 * batches[i].Count;
+        }
+        if (size == 0)
+        {
+            return;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+        if (size > m_instanceBufferSize)
+        {
+            m_instanceBufferSize = size;
+        }
+        glBufferData(GL_ARRAY_BUFFER, m_instanceBufferSize, nullptr, GL_STREAM_DRAW);
+        GLintptr offset = 0;
+        for (uint32_t i = 0; i < batchCount; ++i)
+        {
+            auto bytes = sizeof(float) * 16 * batches[i].Count;
+            glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, batches[i].WorldMatrices);
+            offset += bytes;
+        }
+
+        glUseProgram(m_shaderInstanced);
+        glUniformMatrix4fv(m_uViewProjMatrixInstanced, 1, false, viewProjection);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        offset = 0;
+        for (uint32_t i = 0; i < batchCount; ++i)
+        {
+            auto &batch = batches[i];
+            if (batch.Count == 0 || batch.Mesh >= m_meshes.size())
+            {
+                offset += sizeof(float) * 16 * batch.Count;
+                continue;
+            }
+            auto &mesh = m_meshes[batch.Mesh];
+            glBindVertexArray(mesh.VertexArray);
+            for (int c = 0; c < 4; ++c)
+            {
+                glVertexAttribPointer(m_aWorldMatrix + c, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 16,
+                                      (GLvoid *)(offset + sizeof(float) * 4 * c));
+            }
+            glDrawElementsInstanced(GL_TRIANGLES, mesh.IndexCount, GL_UNSIGNED_INT, (GLvoid *)0, batch.Count);
+            offset += sizeof(float) * 16 * batch.Count;
+        }
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glUseProgram(0);
+    }
+};
+
+///
+/// GL3Renderer
+///
+GL3Renderer::GL3Renderer(const std::string &version)
+    : m_version(version)
+{
+}
+
+GL3Renderer::~GL3Renderer()
+{
+    delete m_impl;
+}
+
+GL3RendererImpl *GL3Renderer::GetImpl()
+{
+    // created on first use, the GL context has to be current
+    if (!m_impl)
+    {
+        m_impl = new GL3RendererImpl(m_version);
+    }
+    return m_impl;
+}
+
+void GL3Renderer::DrawTeapot(const float *viewProjection, const float *world)
+{
+    GetImpl()->DrawTeapot(viewProjection, world);
+}
+
+uint32_t GL3Renderer::RegisterMesh(const float *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount)
+{
+    return GetImpl()->RegisterMesh(vertices, vertexCount, indices, indexCount);
+}
+
+void GL3Renderer::DrawMeshes(const float *viewProjection, const GL3MeshInstances *batches, uint32_t batchCount)
+{
+    GetImpl()->DrawMeshes(viewProjection, batches, batchCount);
 }
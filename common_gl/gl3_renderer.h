@@ -1,8 +1,20 @@
 #pragma once
+#include <stdint.h>
 #include <string>
 #include <filesystem>
+#include <vector>
 
-unsigned int CreateShader(const std::string &debugName, const std::string &vsSrc, const std::string &fsSrc);
+// attributeNames[i] is bound to location i before linking
+unsigned int CreateShader(const std::string &debugName, const std::string &vsSrc, const std::string &fsSrc,
+                          const std::vector<std::string> &attributeNames = {});
+
+// world matrices of one registered mesh, 16 floats each in the same layout as DrawTeapot's world
+struct GL3MeshInstances
+{
+    uint32_t Mesh;
+    const float *WorldMatrices;
+    uint32_t Count;
+};
 
 class GL3RendererImpl;
 class GL3Renderer
@@ -15,4 +27,13 @@ public:
     ~GL3Renderer();
     void NewFrame(int screenWidth, int screenHeight);
     void DrawTeapot(const float *viewProjection, const float *world);
+
+    // Upload an indexed mesh once. vertices are interleaved position(xyz) + normal(xyz). Return the mesh id for DrawMeshes.
+    uint32_t RegisterMesh(const float *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount);
+    // Copy all world matrices into the per frame instance buffer and draw each batch with glDrawElementsInstanced.
+    // Program, view-projection and depth/cull state are set once for all batches.
+    void DrawMeshes(const float *viewProjection, const GL3MeshInstances *batches, uint32_t batchCount);
+
+private:
+    GL3RendererImpl *GetImpl();
 };
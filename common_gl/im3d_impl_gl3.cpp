@@ -1,11 +1,14 @@
 #include "im3d_impl_gl3.h"
 #include <im3d.h>
 #include <im3d_math.h>
+#include <im3d_expand.h>
 #include <plog/Log.h>
+#include <thread>
+#include <vector>
 
 #include "gl_include.h"
 #include "camera_state.h"
-#include "screenstate.h"
+#include "ScreenState.h"
 #include "gl3_renderer.h"
 #include "shader_source.h"
 
@@ -22,6 +25,13 @@ class Im3dImplGL3Impl
     GLuint g_Im3dShaderLines;
     GLuint g_Im3dShaderTriangles;
 
+    // cpu expansion path
+    bool m_cpuExpansion = false;
+    GLuint g_Im3dShaderExpanded;
+    GLuint g_Im3dExpandedVertexArray;
+    GLuint g_Im3dExpandedVertexBuffer;
+    std::vector<Im3d::ExpandedVertex> m_expandedVertices;
+
 public:
     Im3dImplGL3Impl(const std::string &version)
     {
@@ -98,6 +108,26 @@ public:
             auto blockIndex = glGetUniformBlockIndex(g_Im3dShaderTriangles, "VertexDataBlock");
             glUniformBlockBinding(g_Im3dShaderTriangles, blockIndex, 0);
         }
+        {
+            auto vs = ShaderSource(g_glsl, version);
+            vs.Define("VERTEX_SHADER");
+            vs.Define("EXPANDED");
+            if (version == "#version 300 es")
+            {
+                vs.Replace("noperspective", "");
+            }
+
+            auto fs = ShaderSource(g_glsl, version);
+            fs.Define("FRAGMENT_SHADER");
+            fs.Define("EXPANDED");
+            if (version == "#version 300 es")
+            {
+                fs.Insert("precision mediump float;\n");
+                fs.Replace("noperspective", "");
+            }
+
+            g_Im3dShaderExpanded = CreateShader("im3d_expanded", vs.GetSource(), fs.GetSource());
+        }
 
         // in this example we're using a static buffer as the vertex source with a uniform buffer to provide
         // the shader with the Im3d vertex data
@@ -118,6 +148,22 @@ public:
         glBindVertexArray(0);
 
         glGenBuffers(1, &g_Im3dUniformBuffer);
+
+        // the cpu expansion path streams ExpandedVertex into a plain vertex buffer
+        glGenBuffers(1, &g_Im3dExpandedVertexBuffer);
+        glGenVertexArrays(1, &g_Im3dExpandedVertexArray);
+        glBindVertexArray(g_Im3dExpandedVertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, g_Im3dExpandedVertexBuffer);
+        auto position = glGetAttribLocation(g_Im3dShaderExpanded, "aPosition");
+        glEnableVertexAttribArray(position);
+        glVertexAttribPointer(position, 4, GL_FLOAT, GL_FALSE, sizeof(Im3d::ExpandedVertex), (GLvoid *)offsetof(Im3d::ExpandedVertex, m_position));
+        auto edge = glGetAttribLocation(g_Im3dShaderExpanded, "aEdge");
+        glEnableVertexAttribArray(edge);
+        glVertexAttribPointer(edge, 4, GL_FLOAT, GL_FALSE, sizeof(Im3d::ExpandedVertex), (GLvoid *)offsetof(Im3d::ExpandedVertex, m_edge));
+        auto color = glGetAttribLocation(g_Im3dShaderExpanded, "aColor");
+        glEnableVertexAttribArray(color);
+        glVertexAttribPointer(color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Im3d::ExpandedVertex), (GLvoid *)offsetof(Im3d::ExpandedVertex, m_color));
+        glBindVertexArray(0);
     }
 
     ~Im3dImplGL3Impl()
@@ -125,13 +171,27 @@ public:
         glDeleteVertexArrays(1, &g_Im3dVertexArray);
         glDeleteBuffers(1, &g_Im3dUniformBuffer);
         glDeleteBuffers(1, &g_Im3dVertexBuffer);
+        glDeleteVertexArrays(1, &g_Im3dExpandedVertexArray);
+        glDeleteBuffers(1, &g_Im3dExpandedVertexBuffer);
         glDeleteProgram(g_Im3dShaderPoints);
         glDeleteProgram(g_Im3dShaderLines);
         glDeleteProgram(g_Im3dShaderTriangles);
+        glDeleteProgram(g_Im3dShaderExpanded);
+    }
+
+    void SetCpuExpansion(bool enable)
+    {
+        m_cpuExpansion = enable;
     }
 
     void Draw(const float *viewProj)
     {
+        if (m_cpuExpansion)
+        {
+            DrawExpanded(viewProj);
+            return;
+        }
+
         glEnable(GL_BLEND);
         glBlendEquation(GL_FUNC_ADD);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -210,6 +270,37 @@ public:
         glUseProgram(0);
         glDisable(GL_BLEND);
     }
+
+    // All draw lists in one draw call, no uniform buffer size limit. Layers are drawn in order, as above.
+    void DrawExpanded(const float *viewProj)
+    {
+        auto drawLists = Im3d::GetDrawLists();
+        auto drawListCount = Im3d::GetDrawListCount();
+        m_expandedVertices.resize(Im3d::GetExpandedVertexCount(drawLists, drawListCount));
+        if (m_expandedVertices.empty())
+        {
+            return;
+        }
+        auto &ad = Im3d::GetAppData();
+        auto vertexCount = Im3d::ExpandDrawLists(drawLists, drawListCount, viewProj, ad.m_viewportSize,
+                                                 m_expandedVertices.data(), (int)std::thread::hardware_concurrency());
+
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDisable(GL_CULL_FACE); // points and lines are view-aligned
+
+        glBindBuffer(GL_ARRAY_BUFFER, g_Im3dExpandedVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCount * sizeof(Im3d::ExpandedVertex), (GLvoid *)m_expandedVertices.data(), GL_STREAM_DRAW);
+
+        glUseProgram(g_Im3dShaderExpanded);
+        glBindVertexArray(g_Im3dExpandedVertexArray);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertexCount);
+
+        glBindVertexArray(0);
+        glUseProgram(0);
+        glDisable(GL_BLEND);
+    }
 };
 
 //////////////////////////////////////////////////////////////////////////////
@@ -223,6 +314,11 @@ Im3dImplGL3::~Im3dImplGL3()
     delete m_impl;
 }
 
+void Im3dImplGL3::SetCpuExpansion(bool enable)
+{
+    m_impl->SetCpuExpansion(enable);
+}
+
 void Im3dImplGL3::Draw(const float *viewProjection)
 {
     m_impl->Draw(viewProjection);
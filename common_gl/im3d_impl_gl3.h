@@ -9,5 +9,7 @@ class Im3dImplGL3
 public:
     Im3dImplGL3(const std::string &version);
     ~Im3dImplGL3();
+    // Expand points/lines on the CPU and draw everything as one triangle list, instead of instanced draws from a uniform buffer.
+    void SetCpuExpansion(bool enable);
     void Draw(const float *viewProjection);
 };
@@ -21,6 +21,7 @@
 #include "im3d.h"
 #include "im3d_context.h"
 #include "im3d_math.h"
+#include "im3d_polyline.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -59,32 +60,32 @@
 namespace Im3d
 {
 
-inline AppData &GetAppData() { return GetContext().getAppData(); }
-inline void NewFrame() { GetContext().reset(); }
-inline void EndFrame() { GetContext().endFrame(); }
-inline void Draw() { GetContext().draw(); }
+AppData &GetAppData() { return GetContext().getAppData(); }
+void NewFrame() { GetContext().reset(); }
+void EndFrame() { GetContext().endFrame(); }
+void Draw() { GetContext().draw(); }
 
-inline const DrawList *GetDrawLists() { return GetContext().getDrawLists(); }
-inline U32 GetDrawListCount() { return GetContext().getDrawListCount(); }
+const DrawList *GetDrawLists() { return GetContext().getDrawLists(); }
+U32 GetDrawListCount() { return GetContext().getDrawListCount(); }
 
-inline void BeginPoints() { GetContext().begin(PrimitiveMode_Points); }
-inline void BeginLines() { GetContext().begin(PrimitiveMode_Lines); }
-inline void BeginLineLoop() { GetContext().begin(PrimitiveMode_LineLoop); }
-inline void BeginLineStrip() { GetContext().begin(PrimitiveMode_LineStrip); }
-inline void BeginTriangles() { GetContext().begin(PrimitiveMode_Triangles); }
-inline void BeginTriangleStrip() { GetContext().begin(PrimitiveMode_TriangleStrip); }
-inline void End() { GetContext().end(); }
+void BeginPoints() { GetContext().begin(PrimitiveMode_Points); }
+void BeginLines() { GetContext().begin(PrimitiveMode_Lines); }
+void BeginLineLoop() { GetContext().begin(PrimitiveMode_LineLoop); }
+void BeginLineStrip() { GetContext().begin(PrimitiveMode_LineStrip); }
+void BeginTriangles() { GetContext().begin(PrimitiveMode_Triangles); }
+void BeginTriangleStrip() { GetContext().begin(PrimitiveMode_TriangleStrip); }
+void End() { GetContext().end(); }
 
-inline void Vertex(const Vec3 &_position) { GetContext().vertex(_position, GetContext().getSize(), GetContext().getColor()); }
-inline void Vertex(const Vec3 &_position, Color _color) { GetContext().vertex(_position, GetContext().getSize(), _color); }
-inline void Vertex(const Vec3 &_position, float _size) { GetContext().vertex(_position, _size, GetContext().getColor()); }
-inline void Vertex(const Vec3 &_position, float _size, Color _color) { GetContext().vertex(_position, _size, _color); }
-inline void Vertex(float _x, float _y, float _z) { Vertex(Vec3(_x, _y, _z)); }
-inline void Vertex(float _x, float _y, float _z, Color _color) { Vertex(Vec3(_x, _y, _z), _color); }
-inline void Vertex(float _x, float _y, float _z, float _size) { Vertex(Vec3(_x, _y, _z), _size); }
-inline void Vertex(float _x, float _y, float _z, float _size, Color _color) { Vertex(Vec3(_x, _y, _z), _size, _color); }
+void Vertex(const Vec3 &_position) { GetContext().vertex(_position, GetContext().getSize(), GetContext().getColor()); }
+void Vertex(const Vec3 &_position, Color _color) { GetContext().vertex(_position, GetContext().getSize(), _color); }
+void Vertex(const Vec3 &_position, float _size) { GetContext().vertex(_position, _size, GetContext().getColor()); }
+void Vertex(const Vec3 &_position, float _size, Color _color) { GetContext().vertex(_position, _size, _color); }
+void Vertex(float _x, float _y, float _z) { Vertex(Vec3(_x, _y, _z)); }
+void Vertex(float _x, float _y, float _z, Color _color) { Vertex(Vec3(_x, _y, _z), _color); }
+void Vertex(float _x, float _y, float _z, float _size) { Vertex(Vec3(_x, _y, _z), _size); }
+void Vertex(float _x, float _y, float _z, float _size, Color _color) { Vertex(Vec3(_x, _y, _z), _size, _color); }
 
-inline void PushDrawState()
+void PushDrawState()
 {
     Context &ctx = GetContext();
     ctx.pushColor(ctx.getColor());
@@ -92,7 +93,7 @@ inline void PushDrawState()
     ctx.pushSize(ctx.getSize());
     ctx.pushEnableSorting(ctx.getEnableSorting());
 }
-inline void PopDrawState()
+void PopDrawState()
 {
     Context &ctx = GetContext();
     ctx.popColor();
@@ -101,62 +102,70 @@ inline void PopDrawState()
     ctx.popEnableSorting();
 }
 
-inline void PushColor() { GetContext().pushColor(GetContext().getColor()); }
-inline void PushColor(Color _color) { GetContext().pushColor(_color); }
-inline void PopColor() { GetContext().popColor(); }
-inline void SetColor(Color _color) { GetContext().setColor(_color); }
-inline void SetColor(float _r, float _g, float _b, float _a) { GetContext().setColor(Color(_r, _g, _b, _a)); }
-inline Color GetColor() { return GetContext().getColor(); }
-
-inline void PushAlpha() { GetContext().pushAlpha(GetContext().getAlpha()); }
-inline void PushAlpha(float _alpha) { GetContext().pushAlpha(_alpha); }
-inline void PopAlpha() { GetContext().popAlpha(); }
-inline void SetAlpha(float _alpha) { GetContext().setAlpha(_alpha); }
-inline float GetAlpha() { return GetContext().getAlpha(); }
-
-inline void PushSize() { GetContext().pushSize(GetContext().getAlpha()); }
-inline void PushSize(float _size) { GetContext().pushSize(_size); }
-inline void PopSize() { GetContext().popSize(); }
-inline void SetSize(float _size) { GetContext().setSize(_size); }
-inline float GetSize() { return GetContext().getSize(); }
-
-inline void PushEnableSorting() { GetContext().pushEnableSorting(GetContext().getEnableSorting()); }
-inline void PushEnableSorting(bool _enable) { GetContext().pushEnableSorting(_enable); }
-inline void PopEnableSorting() { GetContext().popEnableSorting(); }
-inline void EnableSorting(bool _enable) { GetContext().setEnableSorting(_enable); }
-
-inline void PushMatrix() { GetContext().pushMatrix(GetContext().getMatrix()); }
-inline void PushMatrix(const Mat4 &_mat4) { GetContext().pushMatrix(_mat4); }
-inline void PopMatrix() { GetContext().popMatrix(); }
-inline void SetMatrix(const Mat4 &_mat4) { GetContext().setMatrix(_mat4); }
-inline void SetIdentity() { GetContext().setMatrix(Mat4(1.0f)); }
-
-inline void PushId() { GetContext().pushId(GetContext().getId()); }
-inline void PushId(Id _id) { GetContext().pushId(_id); }
-inline void PushId(const char *_str) { GetContext().pushId(MakeId(_str)); }
-inline void PushId(const void *_ptr) { GetContext().pushId(MakeId(_ptr)); }
-inline void PushId(int _i) { GetContext().pushId(MakeId(_i)); }
-inline void PopId() { GetContext().popId(); }
-inline Id GetId() { return GetContext().getId(); }
-inline Id GetActiveId() { return GetContext().m_appActiveId; }
-inline Id GetHotId() { return GetContext().m_appHotId; }
-
-inline void PushLayerId() { GetContext().pushLayerId(GetContext().getLayerId()); }
-inline void PushLayerId(Id _layer) { GetContext().pushLayerId(_layer); }
-inline void PushLayerId(const char *_str) { PushLayerId(MakeId(_str)); }
-inline void PopLayerId() { GetContext().popLayerId(); }
-inline Id GetLayerId() { return GetContext().getLayerId(); }
-
-inline bool GizmoTranslation(const char *_id, float _translation_[3], bool _local) { return GizmoTranslation(MakeId(_id), _translation_, _local); }
-inline bool GizmoRotation(const char *_id, float _rotation_[3 * 3], bool _local) { return GizmoRotation(MakeId(_id), _rotation_, _local); }
-inline bool GizmoScale(const char *_id, float _scale_[3]) { return GizmoScale(MakeId(_id), _scale_); }
-inline bool Gizmo(const char *_id, float _translation_[3], float _rotation_[3 * 3], float _scale_[3]) { return Gizmo(MakeId(_id), _translation_, _rotation_, _scale_); }
-inline bool Gizmo(const char *_id, float _transform_[4 * 4]) { return Gizmo(MakeId(_id), _transform_); }
-
-inline bool IsVisible(const Vec3 &_origin, float _radius) { return GetContext().isVisible(_origin, _radius); }
-inline bool IsVisible(const Vec3 &_min, const Vec3 &_max) { return GetContext().isVisible(_min, _max); }
-
-inline void MergeContexts(Context &_dst_, const Context &_src) { _dst_.merge(_src); }
+void PushColor() { GetContext().pushColor(GetContext().getColor()); }
+void PushColor(Color _color) { GetContext().pushColor(_color); }
+void PopColor() { GetContext().popColor(); }
+void SetColor(Color _color) { GetContext().setColor(_color); }
+void SetColor(float _r, float _g, float _b, float _a) { GetContext().setColor(Color(_r, _g, _b, _a)); }
+Color GetColor() { return GetContext().getColor(); }
+
+void PushAlpha() { GetContext().pushAlpha(GetContext().getAlpha()); }
+void PushAlpha(float _alpha) { GetContext().pushAlpha(_alpha); }
+void PopAlpha() { GetContext().popAlpha(); }
+void SetAlpha(float _alpha) { GetContext().setAlpha(_alpha); }
+float GetAlpha() { return GetContext().getAlpha(); }
+
+void PushSize() { GetContext().pushSize(GetContext().getAlpha()); }
+void PushSize(float _size) { GetContext().pushSize(_size); }
+void PopSize() { GetContext().popSize(); }
+void SetSize(float _size) { GetContext().setSize(_size); }
+float GetSize() { return GetContext().getSize(); }
+
+void PushEnableSorting() { GetContext().pushEnableSorting(GetContext().getEnableSorting()); }
+void PushEnableSorting(bool _enable) { GetContext().pushEnableSorting(_enable); }
+void PopEnableSorting() { GetContext().popEnableSorting(); }
+void EnableSorting(bool _enable) { GetContext().setEnableSorting(_enable); }
+
+void PushLifetime() { GetContext().pushLifetime(GetContext().getLifetime()); }
+void PushLifetime(float _seconds) { GetContext().pushLifetime(_seconds); }
+void PushLifetimeFrames(int _frames) { GetContext().pushLifetime(-(float)_frames); }
+void PopLifetime() { GetContext().popLifetime(); }
+void SetLifetime(float _seconds) { GetContext().setLifetime(_seconds); }
+void SetLifetimeFrames(int _frames) { GetContext().setLifetime(-(float)_frames); }
+void ClearTimedPrimitives() { GetContext().clearTimedPrimitives(); }
+
+void PushMatrix() { GetContext().pushMatrix(GetContext().getMatrix()); }
+void PushMatrix(const Mat4 &_mat4) { GetContext().pushMatrix(_mat4); }
+void PopMatrix() { GetContext().popMatrix(); }
+void SetMatrix(const Mat4 &_mat4) { GetContext().setMatrix(_mat4); }
+void SetIdentity() { GetContext().setMatrix(Mat4(1.0f)); }
+
+void PushId() { GetContext().pushId(GetContext().getId()); }
+void PushId(Id _id) { GetContext().pushId(_id); }
+void PushId(const char *_str) { GetContext().pushId(MakeId(_str)); }
+void PushId(const void *_ptr) { GetContext().pushId(MakeId(_ptr)); }
+void PushId(int _i) { GetContext().pushId(MakeId(_i)); }
+void PopId() { GetContext().popId(); }
+Id GetId() { return GetContext().getId(); }
+Id GetActiveId() { return GetContext().m_appActiveId; }
+Id GetHotId() { return GetContext().m_appHotId; }
+
+void PushLayerId() { GetContext().pushLayerId(GetContext().getLayerId()); }
+void PushLayerId(Id _layer) { GetContext().pushLayerId(_layer); }
+void PushLayerId(const char *_str) { PushLayerId(MakeId(_str)); }
+void PopLayerId() { GetContext().popLayerId(); }
+Id GetLayerId() { return GetContext().getLayerId(); }
+
+bool GizmoTranslation(const char *_id, float _translation_[3], bool _local) { return GizmoTranslation(MakeId(_id), _translation_, _local); }
+bool GizmoRotation(const char *_id, float _rotation_[3 * 3], bool _local) { return GizmoRotation(MakeId(_id), _rotation_, _local); }
+bool GizmoScale(const char *_id, float _scale_[3]) { return GizmoScale(MakeId(_id), _scale_); }
+bool Gizmo(const char *_id, float _translation_[3], float _rotation_[3 * 3], float _scale_[3]) { return Gizmo(MakeId(_id), _translation_, _rotation_, _scale_); }
+bool Gizmo(const char *_id, float _transform_[4 * 4]) { return Gizmo(MakeId(_id), _transform_); }
+
+bool IsVisible(const Vec3 &_origin, float _radius) { return GetContext().isVisible(_origin, _radius); }
+bool IsVisible(const Vec3 &_min, const Vec3 &_max) { return GetContext().isVisible(_min, _max); }
+
+void MergeContexts(Context &_dst_, const Context &_src) { _dst_.merge(_src); }
 
 void MulMatrix(const Mat4 &_mat4)
 {
@@ -656,6 +665,135 @@ void DrawArrow(const Vec3 &_start, const Vec3 &_end, float _headLength, float _h
     ctx.vertex(_end, 2.0f, ctx.getColor()); // \hack \todo 2.0f here compensates for the shader antialiasing (which reduces alpha when size < 2)
     ctx.end();
 }
+// Emits the visible spans of a polyline, each at its own pyramid level. Consecutive visible spans share a line strip, a
+// culled span ends it after its first sample so that segments crossing the frustum are kept. Within a strip a span only
+// emits its nodes' min/max samples, the span's own first and last samples are emitted at the ends of the strip.
+struct PolylineDraw
+{
+    Context &m_ctx;
+    const Polyline &m_polyline;
+    const Mat4 &m_world;
+    float m_worldScale;
+    float m_verticesPerPixel;
+    bool m_inStrip = false;
+    U32 m_prev = 0; // last emitted sample, valid while m_inStrip
+
+    void vertex(U32 _i)
+    {
+        if (m_inStrip && _i <= m_prev)
+        {
+            return;
+        }
+        m_ctx.vertex(m_polyline.getPosition(_i));
+        m_prev = _i;
+    }
+
+    // Samples [_first, _end) at _level, _first and _end - 1 aligned to nodes of _level.
+    void emitSpan(U32 _first, U32 _end, int _level)
+    {
+        if (!m_inStrip)
+        {
+            m_ctx.begin(PrimitiveMode_LineStrip);
+            vertex(_first > 0 ? _first - 1 : _first);
+            m_inStrip = true;
+        }
+        for (U32 i = _first >> _level, last = (_end - 1) >> _level; i <= last; ++i)
+        {
+            U32 first, second;
+            m_polyline.getNode(_level, i, first, second);
+            vertex(first);
+            vertex(second);
+        }
+    }
+
+    // End the strip at sample _i, the first culled sample or the last one.
+    void endStrip(U32 _i)
+    {
+        if (m_inStrip)
+        {
+            vertex(_i);
+            m_ctx.end();
+            m_inStrip = false;
+        }
+    }
+
+    // Cull [_first, _end) against the frustum, else return the level for its projected size.
+    bool selectLevel(U32 _first, U32 _end, const Vec3 &_min, const Vec3 &_max, int &level_)
+    {
+        Vec3 center = m_world * ((_min + _max) * 0.5f);
+        float radius = Length(_max - _min) * 0.5f * m_worldScale;
+        if (!m_ctx.isVisible(center, radius))
+        {
+            return false;
+        }
+        // the budget follows the span's extent along the other axes, a node's min/max already covers the value axis.
+        // an oscillating series has the full amplitude in every span, sizing by the box would keep every sample.
+        Vec3 extent = _max - _min;
+        extent[m_polyline.getValueAxis()] = 0.0f;
+        float pixels = m_ctx.worldSizeToPixels(center, Length(extent) * m_worldScale);
+        U32 maxVertices = (U32)Clamp(pixels * m_verticesPerPixel, 2.0f, (float)(_end - _first));
+        level_ = m_polyline.selectLevel(maxVertices, _end - _first);
+        return true;
+    }
+
+    void node(int _level, U32 _i)
+    {
+        U32 count = m_polyline.getCount();
+        U32 first = _i << _level;
+        U32 end = count - first > (1u << _level) ? first + (1u << _level) : count;
+        Vec3 bmin, bmax;
+        m_polyline.getNodeBounds(_level, _i, bmin, bmax);
+        int level;
+        if (!selectLevel(first, end, bmin, bmax, level))
+        {
+            endStrip(first);
+            return;
+        }
+        if (level >= _level || _level == Polyline::kBoundsLevel)
+        {
+            emitSpan(first, end, level < _level ? level : _level);
+            return;
+        }
+        // too coarse for this span, refine each half against its own size
+        node(_level - 1, _i * 2);
+        if (((_i * 2 + 1) << (_level - 1)) < count)
+        {
+            node(_level - 1, _i * 2 + 1);
+        }
+    }
+};
+
+void DrawPolyline(const Polyline &_polyline, float _verticesPerPixel)
+{
+    U32 count = _polyline.getCount();
+    if (count < 2)
+    {
+        return;
+    }
+    Context &ctx = GetContext();
+
+    const Mat4 &world = ctx.getMatrix();
+    Vec3 scale = world.getScale();
+    PolylineDraw draw = {ctx, _polyline, world, Max(Max(scale.x, scale.y), scale.z), _verticesPerPixel};
+    int topLevel = _polyline.getLevelCount() - 1;
+    if (topLevel >= Polyline::kBoundsLevel)
+    {
+        for (U32 i = 0, n = _polyline.getNodeCount(topLevel); i < n; ++i)
+        {
+            draw.node(topLevel, i);
+        }
+    }
+    else
+    {
+        // too short for per-node bounds, a single span
+        int level;
+        if (draw.selectLevel(0, count, _polyline.getBoundsMin(), _polyline.getBoundsMax(), level))
+        {
+            draw.emitSpan(0, count, level);
+        }
+    }
+    draw.endStrip(count - 1);
+}
 
 static constexpr U32 kFnv1aPrime32 = 0x01000193u;
 static U32 Hash(const char *_buf, int _buflen, U32 _base)
@@ -756,8 +894,7 @@ bool GizmoTranslation(Id _id, float _translation_[3], bool _local)
 	}*/
 
     Sphere boundingSphere(*outVec3, worldHeight * 1.5f); // expand the bs to catch the planar subgizmos
-    Ray ray(appData.m_cursorRayOrigin, appData.m_cursorRayDirection);
-    bool intersects = ctx.m_appHotId == ctx.m_appId || Intersects(ray, boundingSphere);
+    bool intersects = ctx.gizmoBroadphase(boundingSphere);
 
     // planes
     ctx.pushEnableSorting(true);
@@ -894,8 +1031,7 @@ bool GizmoRotation(Id _id, float _rotation_[3 * 3], bool _local)
     Id viewId = MakeId("axisV");
 
     Sphere boundingSphere(origin, worldRadius);
-    Ray ray(ctx.getAppData().m_cursorRayOrigin, ctx.getAppData().m_cursorRayDirection);
-    bool intersects = ctx.m_appHotId == ctx.m_appId || Intersects(ray, boundingSphere);
+    bool intersects = ctx.gizmoBroadphase(boundingSphere);
 
     const AppData &appData = ctx.getAppData();
 
@@ -1005,8 +1141,7 @@ bool GizmoScale(Id _id, float _scale_[3])
 	}*/
 
     Sphere boundingSphere(origin, worldHeight);
-    Ray ray(appData.m_cursorRayOrigin, appData.m_cursorRayDirection);
-    bool intersects = ctx.m_appHotId == ctx.m_appId || Intersects(ray, boundingSphere);
+    bool intersects = ctx.gizmoBroadphase(boundingSphere);
 
     ctx.pushEnableSorting(true);
     ctx.pushMatrix(Mat4(1.0f));
@@ -1015,6 +1150,7 @@ bool GizmoScale(Id _id, float _scale_[3])
 
         if (intersects)
         {
+            Ray ray(appData.m_cursorRayOrigin, appData.m_cursorRayDirection);
             Sphere handle(origin, ctx.pixelsToWorldSize(origin, ctx.m_gizmoSizePixels * 4.0f));
             float t0, t1;
             bool intersects = Intersect(ray, handle, t0, t1);
@@ -1390,49 +1526,17 @@ void Mat4::setScale(const Vec3 &_scale)
     setCol(1, getCol(1) * scale.y);
     setCol(2, getCol(2) * scale.z);
 }
-inline static float Determinant(const Mat4 &_m)
-{
-    return _m(0, 3) * _m(1, 2) * _m(2, 1) * _m(3, 0) - _m(0, 2) * _m(1, 3) * _m(2, 1) * _m(3, 0) - _m(0, 3) * _m(1, 1) * _m(2, 2) * _m(3, 0) + _m(0, 1) * _m(1, 3) * _m(2, 2) * _m(3, 0) +
-           _m(0, 2) * _m(1, 1) * _m(2, 3) * _m(3, 0) - _m(0, 1) * _m(1, 2) * _m(2, 3) * _m(3, 0) - _m(0, 3) * _m(1, 2) * _m(2, 0) * _m(3, 1) + _m(0, 2) * _m(1, 3) * _m(2, 0) * _m(3, 1) +
-           _m(0, 3) * _m(1, 0) * _m(2, 2) * _m(3, 1) - _m(0, 0) * _m(1, 3) * _m(2, 2) * _m(3, 1) - _m(0, 2) * _m(1, 0) * _m(2, 3) * _m(3, 1) + _m(0, 0) * _m(1, 2) * _m(2, 3) * _m(3, 1) +
-           _m(0, 3) * _m(1, 1) * _m(2, 0) * _m(3, 2) - _m(0, 1) * _m(1, 3) * _m(2, 0) * _m(3, 2) - _m(0, 3) * _m(1, 0) * _m(2, 1) * _m(3, 2) + _m(0, 0) * _m(1, 3) * _m(2, 1) * _m(3, 2) +
-           _m(0, 1) * _m(1, 0) * _m(2, 3) * _m(3, 2) - _m(0, 0) * _m(1, 1) * _m(2, 3) * _m(3, 2) - _m(0, 2) * _m(1, 1) * _m(2, 0) * _m(3, 3) + _m(0, 1) * _m(1, 2) * _m(2, 0) * _m(3, 3) +
-           _m(0, 2) * _m(1, 0) * _m(2, 1) * _m(3, 3) - _m(0, 0) * _m(1, 2) * _m(2, 1) * _m(3, 3) - _m(0, 1) * _m(1, 0) * _m(2, 2) * _m(3, 3) + _m(0, 0) * _m(1, 1) * _m(2, 2) * _m(3, 3);
-}
 Mat4 Inverse(const Mat4 &_m)
 {
     Mat4 ret;
-    ret(0, 0) = _m(1, 2) * _m(2, 3) * _m(3, 1) - _m(1, 3) * _m(2, 2) * _m(3, 1) + _m(1, 3) * _m(2, 1) * _m(3, 2) - _m(1, 1) * _m(2, 3) * _m(3, 2) - _m(1, 2) * _m(2, 1) * _m(3, 3) + _m(1, 1) * _m(2, 2) * _m(3, 3);
-    ret(0, 1) = _m(0, 3) * _m(2, 2) * _m(3, 1) - _m(0, 2) * _m(2, 3) * _m(3, 1) - _m(0, 3) * _m(2, 1) * _m(3, 2) + _m(0, 1) * _m(2, 3) * _m(3, 2) + _m(0, 2) * _m(2, 1) * _m(3, 3) - _m(0, 1) * _m(2, 2) * _m(3, 3);
-    ret(0, 2) = _m(0, 2) * _m(1, 3) * _m(3, 1) - _m(0, 3) * _m(1, 2) * _m(3, 1) + _m(0, 3) * _m(1, 1) * _m(3, 2) - _m(0, 1) * _m(1, 3) * _m(3, 2) - _m(0, 2) * _m(1, 1) * _m(3, 3) + _m(0, 1) * _m(1, 2) * _m(3, 3);
-    ret(0, 3) = _m(0, 3) * _m(1, 2) * _m(2, 1) - _m(0, 2) * _m(1, 3) * _m(2, 1) - _m(0, 3) * _m(1, 1) * _m(2, 2) + _m(0, 1) * _m(1, 3) * _m(2, 2) + _m(0, 2) * _m(1, 1) * _m(2, 3) - _m(0, 1) * _m(1, 2) * _m(2, 3);
-    ret(1, 0) = _m(1, 3) * _m(2, 2) * _m(3, 0) - _m(1, 2) * _m(2, 3) * _m(3, 0) - _m(1, 3) * _m(2, 0) * _m(3, 2) + _m(1, 0) * _m(2, 3) * _m(3, 2) + _m(1, 2) * _m(2, 0) * _m(3, 3) - _m(1, 0) * _m(2, 2) * _m(3, 3);
-    ret(1, 1) = _m(0, 2) * _m(2, 3) * _m(3, 0) - _m(0, 3) * _m(2, 2) * _m(3, 0) + _m(0, 3) * _m(2, 0) * _m(3, 2) - _m(0, 0) * _m(2, 3) * _m(3, 2) - _m(0, 2) * _m(2, 0) * _m(3, 3) + _m(0, 0) * _m(2, 2) * _m(3, 3);
-    ret(1, 2) = _m(0, 3) * _m(1, 2) * _m(3, 0) - _m(0, 2) * _m(1, 3) * _m(3, 0) - _m(0, 3) * _m(1, 0) * _m(3, 2) + _m(0, 0) * _m(1, 3) * _m(3, 2) + _m(0, 2) * _m(1, 0) * _m(3, 3) - _m(0, 0) * _m(1, 2) * _m(3, 3);
-    ret(1, 3) = _m(0, 2) * _m(1, 3) * _m(2, 0) - _m(0, 3) * _m(1, 2) * _m(2, 0) + _m(0, 3) * _m(1, 0) * _m(2, 2) - _m(0, 0) * _m(1, 3) * _m(2, 2) - _m(0, 2) * _m(1, 0) * _m(2, 3) + _m(0, 0) * _m(1, 2) * _m(2, 3);
-    ret(2, 0) = _m(1, 1) * _m(2, 3) * _m(3, 0) - _m(1, 3) * _m(2, 1) * _m(3, 0) + _m(1, 3) * _m(2, 0) * _m(3, 1) - _m(1, 0) * _m(2, 3) * _m(3, 1) - _m(1, 1) * _m(2, 0) * _m(3, 3) + _m(1, 0) * _m(2, 1) * _m(3, 3);
-    ret(2, 1) = _m(0, 3) * _m(2, 1) * _m(3, 0) - _m(0, 1) * _m(2, 3) * _m(3, 0) - _m(0, 3) * _m(2, 0) * _m(3, 1) + _m(0, 0) * _m(2, 3) * _m(3, 1) + _m(0, 1) * _m(2, 0) * _m(3, 3) - _m(0, 0) * _m(2, 1) * _m(3, 3);
-    ret(2, 2) = _m(0, 1) * _m(1, 3) * _m(3, 0) - _m(0, 3) * _m(1, 1) * _m(3, 0) + _m(0, 3) * _m(1, 0) * _m(3, 1) - _m(0, 0) * _m(1, 3) * _m(3, 1) - _m(0, 1) * _m(1, 0) * _m(3, 3) + _m(0, 0) * _m(1, 1) * _m(3, 3);
-    ret(2, 3) = _m(0, 3) * _m(1, 1) * _m(2, 0) - _m(0, 1) * _m(1, 3) * _m(2, 0) - _m(0, 3) * _m(1, 0) * _m(2, 1) + _m(0, 0) * _m(1, 3) * _m(2, 1) + _m(0, 1) * _m(1, 0) * _m(2, 3) - _m(0, 0) * _m(1, 1) * _m(2, 3);
-    ret(3, 0) = _m(1, 2) * _m(2, 1) * _m(3, 0) - _m(1, 1) * _m(2, 2) * _m(3, 0) - _m(1, 2) * _m(2, 0) * _m(3, 1) + _m(1, 0) * _m(2, 2) * _m(3, 1) + _m(1, 1) * _m(2, 0) * _m(3, 2) - _m(1, 0) * _m(2, 1) * _m(3, 2);
-    ret(3, 1) = _m(0, 1) * _m(2, 2) * _m(3, 0) - _m(0, 2) * _m(2, 1) * _m(3, 0) + _m(0, 2) * _m(2, 0) * _m(3, 1) - _m(0, 0) * _m(2, 2) * _m(3, 1) - _m(0, 1) * _m(2, 0) * _m(3, 2) + _m(0, 0) * _m(2, 1) * _m(3, 2);
-    ret(3, 2) = _m(0, 2) * _m(1, 1) * _m(3, 0) - _m(0, 1) * _m(1, 2) * _m(3, 0) - _m(0, 2) * _m(1, 0) * _m(3, 1) + _m(0, 0) * _m(1, 2) * _m(3, 1) + _m(0, 1) * _m(1, 0) * _m(3, 2) - _m(0, 0) * _m(1, 1) * _m(3, 2);
-    ret(3, 3) = _m(0, 1) * _m(1, 2) * _m(2, 0) - _m(0, 2) * _m(1, 1) * _m(2, 0) + _m(0, 2) * _m(1, 0) * _m(2, 1) - _m(0, 0) * _m(1, 2) * _m(2, 1) - _m(0, 1) * _m(1, 0) * _m(2, 2) + _m(0, 0) * _m(1, 1) * _m(2, 2);
-
-    float det = 1.0f / Determinant(_m);
-    for (int i = 0; i < 16; ++i)
-    {
-        ret[i] *= det;
-    }
+    simd::Inverse(_m.m, ret.m);
     return ret;
 }
 Mat4 Transpose(const Mat4 &_m)
 {
-    return Mat4(
-        _m(0, 0), _m(1, 0), _m(2, 0), _m(3, 0),
-        _m(0, 1), _m(1, 1), _m(2, 1), _m(3, 1),
-        _m(0, 2), _m(1, 2), _m(2, 2), _m(3, 2),
-        _m(0, 3), _m(1, 3), _m(2, 3), _m(3, 3));
+    Mat4 ret;
+    simd::Transpose(_m.m, ret.m);
+    return ret;
 }
 Mat4 Translation(const Vec3 &_t)
 {
@@ -20,6 +20,7 @@ typedef U32 Id;
 struct AppData;
 struct DrawList;
 class  Context;
+class  Polyline;
 
 // Get AppData struct from the current context, fill before calling NewFrame().
 AppData& GetAppData();
@@ -84,6 +85,17 @@ void  PushEnableSorting(bool _enable);
 void  PopEnableSorting();
 void  EnableSorting(bool _enable);
 
+// Lifetime draw state, primitives are retained and redrawn by EndFrame() until they expire (per primitive). 0 = draw once (default).
+// Lifetimes in seconds are driven by AppData::m_deltaTime. Retained primitives are stored in IM3D_TIMED_VERTEX_CAPACITY vertices per
+// context; when they are all live new primitives are dropped.
+void  PushLifetime(); // push the stack top
+void  PushLifetime(float _seconds);
+void  PushLifetimeFrames(int _frames);
+void  PopLifetime();
+void  SetLifetime(float _seconds);
+void  SetLifetimeFrames(int _frames);
+void  ClearTimedPrimitives();
+
 // Push/pop all draw states (color, alpha, size, sorting).
 void  PushDrawState();
 void  PopDrawState();
@@ -119,6 +131,9 @@ void  DrawCylinder(const Vec3& _start, const Vec3& _end, float _radius, int _det
 void  DrawCapsule(const Vec3& _start, const Vec3& _end, float _radius, int _detail = -1);
 void  DrawPrism(const Vec3& _start, const Vec3& _end, float _radius, int _sides);
 void  DrawArrow(const Vec3& _start, const Vec3& _end, float _headLength = -1.0f, float _headThickness = -1.0f);
+// Draw a decimated polyline (see im3d_polyline.h), emitting at most ~_verticesPerPixel vertices per pixel of its projected
+// extent across the value axis.
+void  DrawPolyline(const Polyline& _polyline, float _verticesPerPixel = 2.0f);
 
 // Ids are used to uniquely identify gizmos and layers. Gizmo should have a unique id during a frame.
 // Note that ids are a hash of the whole id stack, see PushId(), PopId().
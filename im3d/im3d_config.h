@@ -15,6 +15,10 @@
 // Use row-major internal matrix layout. 
 //#define IM3D_MATRIX_ROW_MAJOR 1
 
+// Use the SSE2/AVX matrix kernels in im3d_simd.h (default is 1 on x86-64 and on x86 targeting SSE2). If set, set it for
+// every translation unit (e.g. via the build system, see the IM3D_SIMD cache variable), im3d_simd.h is also used outside of Im3d.
+//#define IM3D_SIMD 0
+
 // Force vertex data alignment (default is 4 bytes).
 //#define IM3D_VERTEX_ALIGNMENT 4
 
@@ -24,6 +28,9 @@
 // Enable internal culling for gizmos. The application must set a culling frustum via AppData.
 //#define IM3D_CULL_GIZMOS 1
 
+// Max vertices retained for primitives with a lifetime (see PushLifetime()). New primitives are dropped while it is full of live ones.
+//#define IM3D_TIMED_VERTEX_CAPACITY (64 * 1024)
+
 // Conversion to/from application math types.
 //#define IM3D_VEC2_APP \
 //	Vec2(const glm::vec2& _v)          { x = _v.x; y = _v.y;     } \
@@ -1,6 +1,7 @@
 #include "im3d_context.h"
 #include "im3d.h"
 #include "im3d_math.h"
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <cfloat>
@@ -17,6 +18,9 @@
 #ifndef IM3D_FREE
 #define IM3D_FREE(ptr) free(ptr)
 #endif
+#ifndef IM3D_TIMED_VERTEX_CAPACITY
+#define IM3D_TIMED_VERTEX_CAPACITY (64 * 1024)
+#endif
 
 namespace Im3d
 {
@@ -181,6 +185,11 @@ template class Vector<Id>;
 template class Vector<Mat4>;
 template class Vector<Color>;
 template class Vector<DrawList>;
+template class Vector<TimedPrimitive>;
+template class Vector<Vec3>;
+template class Vector<Vec4>;
+template class Vector<PickNode>;
+template class Vector<PickPrimitive>;
 
 /*******************************************************************************
 
@@ -247,6 +256,10 @@ void Context::end()
         default:
             break;
         };
+        if (m_lifetimeStack.back() != 0.0f)
+        { // retain before culling, the primitive may become visible during a later frame
+            pushTimedPrimitive(vertexList->data() + m_firstVertThisPrim, vertexList->size() - m_firstVertThisPrim);
+        }
 #if IM3D_CULL_PRIMITIVES
         // \hack force the bounds to be slightly conservative to account for point/line size
         m_minVertThisPrim = m_minVertThisPrim - Vec3(1.0f);
@@ -381,6 +394,7 @@ void Context::reset()
     IM3D_ASSERT(m_layerIdStack.size() == 1);
     IM3D_ASSERT(m_matrixStack.size() == 1);
     IM3D_ASSERT(m_idStack.size() == 1);
+    IM3D_ASSERT(m_lifetimeStack.size() == 1);
 
     IM3D_ASSERT(m_primMode == PrimitiveMode_None);
     m_primMode = PrimitiveMode_None;
@@ -395,8 +409,24 @@ void Context::reset()
     m_sortCalled = false;
     m_endFrameCalled = false;
 
+    m_pickRoots.clear();
+    m_pickNodes.clear();
+    m_pickPrimitives.clear();
+
     m_appData.m_viewDirection = Normalize(m_appData.m_viewDirection);
 
+    // advance the clock for timed primitives, expired primitives at the head are reclaimed (others are skipped until compacted)
+    m_time += (double)m_appData.m_deltaTime;
+    ++m_frame;
+    while (m_timedHead < m_timedPrims.size() && isExpired(m_timedPrims[m_timedHead]))
+    {
+        ++m_timedHead;
+    }
+    if (m_timedHead == m_timedPrims.size())
+    {
+        clearTimedPrimitives();
+    }
+
     // copy keydown array internally so that we can make a delta to detect key presses
     memcpy(m_keyDownPrev, m_keyDownCurr, Key_Count);       // \todo avoid this copy, use an index
     memcpy(m_keyDownCurr, m_appData.m_keyDown, Key_Count); // must copy in case m_keyDown is updated after reset (e.g. by an app callback)
@@ -417,6 +447,41 @@ void Context::reset()
         m_cullFrustum[m_cullFrustumCount++] = plane;
     }
 
+    // resolve the two-phase picking candidates with a single cursor ray query over last frame's gizmo bounds: walk the gizmos
+    // hit by the ray in order of entry depth, taking in each one's precise hit from last frame, and stop at the first whose bounds
+    // start behind the nearest precise hit so far (it can't be nearer)
+    m_gizmoPickCandidates.clear();
+    if (m_gizmoTwoPhasePicking)
+    {
+        Ray ray(m_appData.m_cursorRayOrigin, m_appData.m_cursorRayDirection);
+        m_gizmoPickEntries.resize(m_gizmoPickIds.size(), FLT_MAX);
+        m_gizmoPickOrder.clear();
+        for (U32 i = 0; i < m_gizmoPickIds.size(); ++i)
+        {
+            const Vec4 &bounds = m_gizmoPickBounds[i];
+            float t0, t1;
+            if (Intersect(ray, Sphere(Vec3(bounds), bounds.w), t0, t1))
+            {
+                m_gizmoPickEntries[i] = Max(t0, 0.0f); // ray origin inside the bounds
+                m_gizmoPickOrder.push_back(i);
+            }
+        }
+        std::sort(m_gizmoPickOrder.begin(), m_gizmoPickOrder.end(), [this](U32 _a, U32 _b) { return m_gizmoPickEntries[_a] < m_gizmoPickEntries[_b]; });
+        float nearest = FLT_MAX;
+        for (U32 i : m_gizmoPickOrder)
+        {
+            if (nearest < m_gizmoPickEntries[i])
+            {
+                break;
+            }
+            m_gizmoPickCandidates.push_back(m_gizmoPickIds[i]);
+            nearest = Min(nearest, m_gizmoPickDepths[i]);
+        }
+    }
+    m_gizmoPickIds.clear();
+    m_gizmoPickBounds.clear();
+    m_gizmoPickDepths.clear();
+
     // update gizmo modes
     if (wasKeyPressed(Action_GizmoTranslation))
     {
@@ -465,6 +530,18 @@ void Context::merge(const Context &_src)
             m_vertexData[i][layerIndex * DrawPrimitive_Count + k]->append(*vertexData[j]);
         }
     }
+
+    appendTimedPrimitives(_src);
+}
+
+void Context::appendVertexData(Id _layerId, DrawPrimitiveType _primType, const VertexData *_vdata, U32 _count, bool _sorted)
+{
+    IM3D_ASSERT(!m_endFrameCalled);                                // call appendVertexData() before calling EndFrame()
+    IM3D_ASSERT(_count % VertsPerDrawPrimitive[_primType] == 0); // partial primitive
+    pushLayerId(_layerId);                                         // add a new layer if id doesn't alrady exist
+    popLayerId();
+    int layerIndex = findLayerIndex(_layerId);
+    m_vertexData[_sorted ? 1 : 0][layerIndex * DrawPrimitive_Count + _primType]->append(_vdata, _count);
 }
 
 void Context::endFrame()
@@ -472,6 +549,8 @@ void Context::endFrame()
     IM3D_ASSERT(!m_endFrameCalled); // EndFrame() was called multiple times for this frame
     m_endFrameCalled = true;
 
+    appendTimedPrimitives(*this);
+
     // draw unsorted primitives first
     for (U32 i = 0; i < m_vertexData[0].size(); ++i)
     {
@@ -572,6 +651,15 @@ Context::Context()
     m_hotDepth = FLT_MAX;
     m_gizmoHeightPixels = 64.0f;
     m_gizmoSizePixels = 5.0f;
+    m_gizmoTwoPhasePicking = false;
+
+    m_timedHead = 0;
+    m_timedVertexTail = 0;
+    m_timedMinExpiryTime = DBL_MAX;
+    m_timedMinExpiryFrame = ~0u;
+    m_timedDropCount = 0;
+    m_time = 0.0;
+    m_frame = 0;
 
     memset(&m_appData, 0, sizeof(m_appData));
     memset(&m_keyDownCurr, 0, sizeof(m_keyDownCurr));
@@ -590,6 +678,7 @@ Context::Context()
     pushEnableSorting(false);
     pushLayerId(0);
     pushId(0x811C9DC5u); // fnv1 hash base
+    pushLifetime(0.0f);
 }
 
 Context::~Context()
@@ -850,6 +939,103 @@ Context::VertexList *Context::getCurrentVertexList()
     return m_vertexData[m_vertexDataIndex][m_layerIndex * DrawPrimitive_Count + m_primType];
 }
 
+void Context::clearTimedPrimitives()
+{
+    m_timedPrims.clear();
+    m_timedHead = 0;
+    m_timedVertexTail = 0;
+    m_timedMinExpiryTime = DBL_MAX;
+    m_timedMinExpiryFrame = ~0u;
+}
+
+void Context::pushTimedPrimitive(const VertexData *_vdata, U32 _count)
+{
+    if (m_timedVertexData.empty())
+    {
+        m_timedVertexData.resize(IM3D_TIMED_VERTEX_CAPACITY, VertexData());
+    }
+    U32 capacity = m_timedVertexData.size();
+    if (_count > capacity - m_timedVertexTail)
+    {
+        // only worth a pass if it frees something: the reclaimed head or a primitive which expired behind a live one
+        if (m_timedHead > 0 || m_time >= m_timedMinExpiryTime || m_frame >= m_timedMinExpiryFrame)
+        {
+            compactTimedPrimitives();
+        }
+        if (_count > capacity - m_timedVertexTail)
+        {
+            ++m_timedDropCount;
+            return;
+        }
+    }
+    U32 offset = m_timedVertexTail;
+    memcpy(m_timedVertexData.data() + offset, _vdata, sizeof(VertexData) * _count);
+    m_timedVertexTail = offset + _count;
+
+    float lifetime = m_lifetimeStack.back();
+    TimedPrimitive prim;
+    prim.m_expiryTime = lifetime > 0.0f ? m_time + (double)lifetime : DBL_MAX;
+    prim.m_expiryFrame = lifetime < 0.0f ? m_frame + (U32)(-lifetime) : ~0u;
+    prim.m_frame = m_frame;
+    prim.m_layerId = m_layerIdMap[m_layerIndex];
+    prim.m_vertexDataIndex = m_vertexDataIndex;
+    prim.m_primType = m_primType;
+    prim.m_offset = offset;
+    prim.m_count = _count;
+    m_timedPrims.push_back(prim);
+    m_timedMinExpiryTime = prim.m_expiryTime < m_timedMinExpiryTime ? prim.m_expiryTime : m_timedMinExpiryTime;
+    m_timedMinExpiryFrame = prim.m_expiryFrame < m_timedMinExpiryFrame ? prim.m_expiryFrame : m_timedMinExpiryFrame;
+}
+
+void Context::compactTimedPrimitives()
+{
+    // offsets increase in submission order, live vertices only ever move down
+    U32 count = 0;
+    U32 vertexTail = 0;
+    m_timedMinExpiryTime = DBL_MAX;
+    m_timedMinExpiryFrame = ~0u;
+    for (U32 i = m_timedHead; i < m_timedPrims.size(); ++i)
+    {
+        TimedPrimitive prim = m_timedPrims[i];
+        if (isExpired(prim))
+        {
+            continue;
+        }
+        if (prim.m_offset != vertexTail)
+        {
+            memmove(m_timedVertexData.data() + vertexTail, m_timedVertexData.data() + prim.m_offset, sizeof(VertexData) * prim.m_count);
+            prim.m_offset = vertexTail;
+        }
+        vertexTail += prim.m_count;
+        m_timedMinExpiryTime = prim.m_expiryTime < m_timedMinExpiryTime ? prim.m_expiryTime : m_timedMinExpiryTime;
+        m_timedMinExpiryFrame = prim.m_expiryFrame < m_timedMinExpiryFrame ? prim.m_expiryFrame : m_timedMinExpiryFrame;
+        m_timedPrims[count++] = prim;
+    }
+    m_timedPrims.resize(count, TimedPrimitive());
+    m_timedHead = 0;
+    m_timedVertexTail = vertexTail;
+}
+
+bool Context::isExpired(const TimedPrimitive &_prim) const
+{
+    return m_time >= _prim.m_expiryTime || m_frame >= _prim.m_expiryFrame;
+}
+
+void Context::appendTimedPrimitives(const Context &_src)
+{
+    for (U32 i = _src.m_timedHead; i < _src.m_timedPrims.size(); ++i)
+    {
+        const TimedPrimitive &prim = _src.m_timedPrims[i];
+        if (prim.m_frame == _src.m_frame || _src.isExpired(prim))
+        {
+            continue;
+        }
+        int layerIndex = findLayerIndex(prim.m_layerId);
+        IM3D_ASSERT(layerIndex >= 0);
+        m_vertexData[prim.m_vertexDataIndex][layerIndex * DrawPrimitive_Count + prim.m_primType]->append(_src.m_timedVertexData.data() + prim.m_offset, prim.m_count);
+    }
+}
+
 float Context::pixelsToWorldSize(const Vec3 &_position, float _pixels)
 {
     float d = m_appData.m_projOrtho ? 1.0f : Length(_position - m_appData.m_viewOrigin);
@@ -1216,27 +1402,23 @@ void Context::gizmoAxislAngle_Draw(Id _id, const Vec3 &_origin, const Vec3 &_axi
     {
         aligned = 1.0f;
     }
-    pushColor(color);
-    pushSize(m_gizmoSizePixels);
-    pushMatrix(getMatrix() * LookAt(_origin, _origin + _axis, m_appData.m_worldUp));
-    begin(PrimitiveMode_LineLoop);
-    const int detail = estimateLevelOfDetail(_origin, _worldRadius, 16, 128);
-    for (int i = 0; i < detail; ++i)
-    {
-        float rad = TwoPi * ((float)i / (float)detail);
-        vertex(Vec3(cosf(rad) * _worldRadius, sinf(rad) * _worldRadius, 0.0f));
+    Mat4 transform = LookAt(_origin, _origin + _axis, m_appData.m_worldUp);
+    transform.setCol(0, transform.getCol(0) * _worldRadius);
+    transform.setCol(1, transform.getCol(1) * _worldRadius);
+    begin(PrimitiveMode_Lines);
+    appendGizmoGeometry(getGizmoRing(estimateLevelOfDetail(_origin, _worldRadius, 16, 128)), transform, color, m_gizmoSizePixels);
 
-        // post-modify the alpha for parts of the ring occluded by the sphere
-        VertexData &vd = getCurrentVertexList()->back();
+    // post-modify the alpha for parts of the ring occluded by the sphere
+    VertexList *vertexList = getCurrentVertexList();
+    for (U32 i = m_firstVertThisPrim; i < vertexList->size(); ++i)
+    {
+        VertexData &vd = (*vertexList)[i];
         Vec3 v = vd.m_positionSize;
         float d = Dot(Normalize(_origin - v), m_appData.m_viewDirection);
         d = Max(Remap(d, 0.1f, 0.2f), aligned);
         vd.m_color.setA(vd.m_color.getA() * d);
     }
     end();
-    popMatrix();
-    popSize();
-    popColor();
 }
 
 bool Context::gizmoAxisScale_Behavior(Id _id, const Vec3 &_origin, const Vec3 &_axis, float _snap, float _worldHeight, float _worldSize, float *_out_)
@@ -1336,17 +1518,125 @@ void Context::gizmoAxisScale_Draw(Id _id, const Vec3 &_origin, const Vec3 &_axis
         aligned = 1.0f;
     }
     color.setA(color.getA() * aligned);
-    begin(PrimitiveMode_LineLoop);
-    vertex(_origin + _axis * (0.2f * _worldHeight), m_gizmoSizePixels, color);
-    vertex(_origin + _axis * _worldHeight, m_gizmoSizePixels, color);
+    Mat4 transform(1.0f);
+    transform.setCol(2, Vec4(_axis * _worldHeight, 0.0f));
+    transform.setCol(3, Vec4(_origin, 1.0f));
+    begin(PrimitiveMode_Lines);
+    appendGizmoGeometry(GizmoGeometry_ScaleLine, transform, color, m_gizmoSizePixels);
     end();
     begin(PrimitiveMode_Points);
-    vertex(_origin + _axis * _worldHeight, m_gizmoSizePixels * 2.0f, color);
+    appendGizmoGeometry(GizmoGeometry_ScalePoint, transform, color, m_gizmoSizePixels);
     end();
 }
 
+bool Context::gizmoBroadphase(const Sphere &_bounds)
+{
+    if (m_gizmoTwoPhasePicking)
+    {
+        m_gizmoPickIds.push_back(m_appId);
+        m_gizmoPickBounds.push_back(Vec4(_bounds.m_origin, _bounds.m_radius));
+        m_gizmoPickDepths.push_back(FLT_MAX);
+        if (m_appHotId == m_appId)
+        {
+            return true;
+        }
+        for (Id id : m_gizmoPickCandidates)
+        {
+            if (id == m_appId)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    Ray ray(m_appData.m_cursorRayOrigin, m_appData.m_cursorRayDirection);
+    return m_appHotId == m_appId || Intersects(ray, _bounds);
+}
+
+Context::GizmoGeometry Context::getGizmoRing(int _detail) const
+{
+    int ring = GizmoGeometry_Ring16;
+    for (int segments = 16; segments < _detail && ring < GizmoGeometry_Ring128; segments *= 2)
+    {
+        ++ring;
+    }
+    return (GizmoGeometry)ring;
+}
+
+const Context::VertexList &Context::getGizmoGeometry(GizmoGeometry _geometry)
+{
+    VertexList &ret = m_gizmoGeometry[_geometry];
+    if (!ret.empty())
+    {
+        return ret;
+    }
+    switch (_geometry)
+    {
+    case GizmoGeometry_ScaleLine:
+        ret.push_back(VertexData(Vec3(0.0f, 0.0f, 0.2f), 1.0f, Color_White));
+        ret.push_back(VertexData(Vec3(0.0f, 0.0f, 1.0f), 1.0f, Color_White));
+        break;
+    case GizmoGeometry_ScalePoint:
+        ret.push_back(VertexData(Vec3(0.0f, 0.0f, 1.0f), 2.0f, Color_White));
+        break;
+    case GizmoGeometry_Ring16:
+    case GizmoGeometry_Ring32:
+    case GizmoGeometry_Ring64:
+    case GizmoGeometry_Ring128:
+    {
+        int detail = 16 << (_geometry - GizmoGeometry_Ring16);
+        ret.reserve(detail * 2);
+        for (int i = 0; i < detail; ++i)
+        {
+            float rad0 = TwoPi * ((float)i / (float)detail);
+            float rad1 = TwoPi * ((float)(i + 1) / (float)detail);
+            ret.push_back(VertexData(Vec3(cosf(rad0), sinf(rad0), 0.0f), 1.0f, Color_White));
+            ret.push_back(VertexData(Vec3(cosf(rad1), sinf(rad1), 0.0f), 1.0f, Color_White));
+        }
+        break;
+    }
+    default:
+        IM3D_ASSERT(false);
+        break;
+    };
+    return ret;
+}
+
+void Context::appendGizmoGeometry(GizmoGeometry _geometry, const Mat4 &_transform, Color _color, float _size)
+{
+    IM3D_ASSERT(m_primMode != PrimitiveMode_None); // call between begin()/end()
+    const VertexList &geometry = getGizmoGeometry(_geometry);
+    Mat4 world = getMatrix() * _transform;
+    _color.setA(_color.getA() * m_alphaStack.back());
+
+    VertexList *vertexList = getCurrentVertexList();
+    vertexList->reserve(vertexList->size() + geometry.size());
+    for (U32 i = 0; i < geometry.size(); ++i)
+    {
+        const VertexData &src = geometry[i];
+        Vec3 p = world * Vec3(src.m_positionSize);
+        vertexList->push_back(VertexData(p, src.m_positionSize.w * _size, _color));
+#if IM3D_CULL_PRIMITIVES
+        if (m_vertCountThisPrim == 0 && i == 0)
+        {
+            m_minVertThisPrim = m_maxVertThisPrim = p;
+        }
+        else
+        {
+            m_minVertThisPrim = Min(m_minVertThisPrim, p);
+            m_maxVertThisPrim = Max(m_maxVertThisPrim, p);
+        }
+#endif
+    }
+    m_vertCountThisPrim += geometry.size();
+}
+
 bool Context::makeHot(Id _id, float _depth, bool _intersects)
 {
+    if (_intersects && !m_gizmoPickIds.empty() && m_gizmoPickIds.back() == m_appId)
+    { // precise hit of the gizmo registered last by gizmoBroadphase(), for next frame's candidates
+        m_gizmoPickDepths.back() = Min(m_gizmoPickDepths.back(), _depth);
+    }
     if (m_activeId == Id_Invalid && _depth < m_hotDepth && _intersects && !isKeyDown(Action_Select))
     {
         m_hotId = _id;
@@ -1369,6 +1659,266 @@ void Context::resetId()
     m_hotDepth = FLT_MAX;
 }
 
+namespace
+{
+const U32 kPickLeafSize = 4;
+
+// Slab test, _invDirection may contain inf. NaNs (0 * inf) are ignored by the comparisons.
+bool IntersectAabb(const Vec3 &_origin, const Vec3 &_invDirection, const Vec3 &_min, const Vec3 &_max, float _tmax)
+{
+    float t0 = 0.0f;
+    float t1 = _tmax;
+    for (int i = 0; i < 3; ++i)
+    {
+        float tnear = (_min[i] - _origin[i]) * _invDirection[i];
+        float tfar = (_max[i] - _origin[i]) * _invDirection[i];
+        if (tnear > tfar)
+        {
+            float tmp = tnear;
+            tnear = tfar;
+            tfar = tmp;
+        }
+        if (tnear > t0)
+        {
+            t0 = tnear;
+        }
+        if (tfar < t1)
+        {
+            t1 = tfar;
+        }
+        if (t0 > t1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Double-sided ray/triangle test (Moller-Trumbore).
+bool IntersectTriangle(const Ray &_ray, const Vec3 &_a, const Vec3 &_b, const Vec3 &_c, float &t_)
+{
+    Vec3 e1 = _b - _a;
+    Vec3 e2 = _c - _a;
+    Vec3 p = Cross(_ray.m_direction, e2);
+    float det = Dot(e1, p);
+    if (fabs(det) < FLT_EPSILON)
+    {
+        return false;
+    }
+    float invDet = 1.0f / det;
+    Vec3 s = _ray.m_origin - _a;
+    float u = Dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f)
+    {
+        return false;
+    }
+    Vec3 q = Cross(s, e1);
+    float v = Dot(_ray.m_direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+    {
+        return false;
+    }
+    t_ = Dot(e2, q) * invDet;
+    return t_ >= 0.0f;
+}
+} // namespace
+
+bool Context::pickRay(const Vec3 &_origin, const Vec3 &_direction, RayHit &hit_, Id _layerId)
+{
+    IM3D_ASSERT(m_endFrameCalled); // pickRay() called before EndFrame(), vertex data isn't final
+
+    if (m_pickRoots.size() != m_layerIdMap.size())
+    {
+        m_pickRoots.resize(m_layerIdMap.size(), ~0u);
+    }
+    Vec3 direction = Normalize(_direction);
+    Vec3 invDirection = Vec3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    hit_.m_depth = FLT_MAX;
+    bool ret = false;
+
+    Vector<U32> stack;
+    for (U32 layer = 0; layer < m_layerIdMap.size(); ++layer)
+    {
+        if (_layerId != Id_Invalid && m_layerIdMap[layer] != _layerId)
+        {
+            continue;
+        }
+        if (m_pickRoots[layer] == ~0u)
+        {
+            m_pickRoots[layer] = buildPickLayer(layer);
+        }
+
+        stack.clear();
+        stack.push_back(m_pickRoots[layer]);
+        while (!stack.empty())
+        {
+            PickNode node = m_pickNodes[stack.back()];
+            stack.pop_back();
+            if (!IntersectAabb(_origin, invDirection, node.m_min, node.m_max, hit_.m_depth))
+            {
+                continue;
+            }
+            if (node.m_count == 0)
+            {
+                stack.push_back(node.m_first + 1);
+                stack.push_back(node.m_first);
+                continue;
+            }
+            for (U32 i = node.m_first; i < node.m_first + node.m_count; ++i)
+            {
+                if (pickPrimitive(m_pickPrimitives[i], _origin, direction, hit_))
+                {
+                    hit_.m_layerId = m_layerIdMap[layer];
+                    ret = true;
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+U32 Context::buildPickLayer(int _layerIndex)
+{
+    U32 first = m_pickPrimitives.size();
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int type = 0; type < DrawPrimitive_Count; ++type)
+        {
+            const VertexList &vertexList = *m_vertexData[i][_layerIndex * DrawPrimitive_Count + type];
+            U32 primSize = (U32)VertsPerDrawPrimitive[type];
+            for (U32 j = 0; j + primSize <= vertexList.size(); j += primSize)
+            {
+                PickPrimitive prim;
+                prim.m_vertexData = vertexList.data() + j;
+                prim.m_primType = (DrawPrimitiveType)type;
+                prim.m_min = Vec3(FLT_MAX);
+                prim.m_max = Vec3(-FLT_MAX);
+                for (U32 k = 0; k < primSize; ++k)
+                {
+                    const VertexData &vd = prim.m_vertexData[k];
+                    Vec3 p = Vec3(vd.m_positionSize);
+                    float tolerance = type == DrawPrimitive_Triangles ? 0.0f : pixelsToWorldSize(p, vd.m_positionSize.w * 0.5f);
+                    prim.m_min = Min(prim.m_min, p - Vec3(tolerance));
+                    prim.m_max = Max(prim.m_max, p + Vec3(tolerance));
+                }
+                m_pickPrimitives.push_back(prim);
+            }
+        }
+    }
+
+    U32 root = m_pickNodes.size();
+    m_pickNodes.push_back(PickNode());
+    buildPickNode(root, first, m_pickPrimitives.size() - first);
+    return root;
+}
+
+void Context::buildPickNode(U32 _node, U32 _first, U32 _count)
+{
+    Vec3 boundsMin = Vec3(FLT_MAX);
+    Vec3 boundsMax = Vec3(-FLT_MAX);
+    Vec3 centerMin = Vec3(FLT_MAX);
+    Vec3 centerMax = Vec3(-FLT_MAX);
+    for (U32 i = _first; i < _first + _count; ++i)
+    {
+        const PickPrimitive &prim = m_pickPrimitives[i];
+        boundsMin = Min(boundsMin, prim.m_min);
+        boundsMax = Max(boundsMax, prim.m_max);
+        Vec3 center = (prim.m_min + prim.m_max) * 0.5f;
+        centerMin = Min(centerMin, center);
+        centerMax = Max(centerMax, center);
+    }
+    PickNode &node = m_pickNodes[_node];
+    node.m_min = boundsMin; // empty bounds if _count == 0, the node is never entered
+    node.m_max = boundsMax;
+    if (_count <= kPickLeafSize)
+    {
+        node.m_first = _first;
+        node.m_count = _count;
+        return;
+    }
+
+    // split at the middle of the largest axis of the primitive centers
+    Vec3 extent = centerMax - centerMin;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    float split = (centerMin[axis] + centerMax[axis]) * 0.5f;
+    U32 mid = _first;
+    for (U32 i = _first; i < _first + _count; ++i)
+    {
+        PickPrimitive &prim = m_pickPrimitives[i];
+        if ((prim.m_min[axis] + prim.m_max[axis]) * 0.5f < split)
+        {
+            PickPrimitive tmp = prim;
+            prim = m_pickPrimitives[mid];
+            m_pickPrimitives[mid] = tmp;
+            ++mid;
+        }
+    }
+    if (mid == _first || mid == _first + _count)
+    { // all centers coincide
+        mid = _first + _count / 2;
+    }
+
+    U32 child = m_pickNodes.size();
+    node.m_first = child; // node is invalidated by the push_back below
+    node.m_count = 0;
+    m_pickNodes.push_back(PickNode());
+    m_pickNodes.push_back(PickNode());
+    buildPickNode(child, _first, mid - _first);
+    buildPickNode(child + 1, mid, _first + _count - mid);
+}
+
+bool Context::pickPrimitive(const PickPrimitive &_prim, const Vec3 &_origin, const Vec3 &_direction, RayHit &hit_)
+{
+    Ray ray(_origin, _direction);
+    const VertexData *vd = _prim.m_vertexData;
+    float t = FLT_MAX;
+    Vec3 position;
+    switch (_prim.m_primType)
+    {
+    case DrawPrimitive_Points:
+    {
+        position = Vec3(vd[0].m_positionSize);
+        float t0, t1;
+        if (!Intersect(ray, Sphere(position, pixelsToWorldSize(position, vd[0].m_positionSize.w * 0.5f)), t0, t1) || t1 < 0.0f)
+        {
+            return false;
+        }
+        t = Max(t0, 0.0f);
+        break;
+    }
+    case DrawPrimitive_Lines:
+    {
+        position = Nearest(ray, LineSegment(Vec3(vd[0].m_positionSize), Vec3(vd[1].m_positionSize)), t);
+        float tolerance = pixelsToWorldSize(position, Max(vd[0].m_positionSize.w, vd[1].m_positionSize.w) * 0.5f);
+        if (t < 0.0f || Length2(ray.m_origin + ray.m_direction * t - position) > tolerance * tolerance)
+        {
+            return false;
+        }
+        break;
+    }
+    case DrawPrimitive_Triangles:
+        if (!IntersectTriangle(ray, Vec3(vd[0].m_positionSize), Vec3(vd[1].m_positionSize), Vec3(vd[2].m_positionSize), t))
+        {
+            return false;
+        }
+        position = ray.m_origin + ray.m_direction * t;
+        break;
+    default:
+        IM3D_ASSERT(false);
+        return false;
+    };
+
+    if (t >= hit_.m_depth)
+    {
+        return false;
+    }
+    hit_.m_primType = _prim.m_primType;
+    hit_.m_vertexData = vd;
+    hit_.m_depth = t;
+    hit_.m_position = position;
+    return true;
+}
+
 U32 Context::getPrimitiveCount(DrawPrimitiveType _type) const
 {
     U32 ret = 0;
@@ -5,6 +5,7 @@
 namespace Im3d
 {
 constexpr Id Id_Invalid = 0;
+struct Sphere;
 
 enum PrimitiveMode
 {
@@ -84,6 +85,45 @@ struct DrawList
 };
 typedef void(DrawPrimitivesCallback)(const DrawList &_drawList);
 
+// Primitive retained in the context ring buffer until its lifetime expires (see Context::pushLifetime()).
+struct TimedPrimitive
+{
+    double m_expiryTime;         // Context time (seconds) at which the primitive expires.
+    U32 m_expiryFrame;           // Context frame at which the primitive expires.
+    U32 m_frame;                 // Frame during which the primitive was submitted (it is already in that frame's vertex lists).
+    Id m_layerId;
+    int m_vertexDataIndex;       // 0 = unsorted, 1 = sorted.
+    DrawPrimitiveType m_primType;
+    U32 m_offset;                // First vertex in the timed vertex ring.
+    U32 m_count;
+};
+
+// Result of Context::pickRay().
+struct RayHit
+{
+    Id m_layerId;                   // Layer of the primitive which was hit.
+    DrawPrimitiveType m_primType;
+    const VertexData *m_vertexData; // First vertex of the primitive, valid until the next reset().
+    float m_depth;                  // Distance along the ray.
+    Vec3 m_position;                // Hit position, for points/lines the nearest point on the primitive.
+};
+
+// Acceleration structure for Context::pickRay(), one bounding volume hierarchy per layer.
+struct PickNode
+{
+    Vec3 m_min = Vec3(0.0f);
+    Vec3 m_max = Vec3(0.0f);
+    U32 m_first = 0; // First primitive if m_count > 0, else index of the first of 2 child nodes.
+    U32 m_count = 0;
+};
+struct PickPrimitive
+{
+    Vec3 m_min; // Bounds, including the pixel tolerance for points/lines.
+    Vec3 m_max;
+    const VertexData *m_vertexData;
+    DrawPrimitiveType m_primType;
+};
+
 // Minimal vector.
 template <typename T>
 class Vector
@@ -198,6 +238,8 @@ public:
 
     void reset();
     void merge(const Context &_src);
+    // Append prebuilt vertex data (e.g. produced in another process) to a layer, _count must be a multiple of the primitive size. Call before endFrame().
+    void appendVertexData(Id _layerId, DrawPrimitiveType _primType, const VertexData *_vdata, U32 _count, bool _sorted = false);
     void endFrame();
     void draw(); // DEPRECATED (see Im3d::Draw)
 
@@ -249,6 +291,18 @@ public:
         m_matrixStack.pop_back();
     }
 
+    // Lifetime > 0 is in seconds, < 0 is a frame count, 0 = draw once (default).
+    void setLifetime(float _lifetime) { m_lifetimeStack.back() = _lifetime; }
+    float getLifetime() const { return m_lifetimeStack.back(); }
+    void pushLifetime(float _lifetime) { m_lifetimeStack.push_back(_lifetime); }
+    void popLifetime()
+    {
+        IM3D_ASSERT(m_lifetimeStack.size() > 1);
+        m_lifetimeStack.pop_back();
+    }
+    // Discard all primitives which have a lifetime.
+    void clearTimedPrimitives();
+
     void setId(Id _id) { m_idStack.back() = _id; }
     Id getId() const { return m_idStack.back(); }
     void pushId(Id _id) { m_idStack.push_back(_id); }
@@ -277,6 +331,11 @@ public:
     bool gizmoAxisScale_Behavior(Id _id, const Vec3 &_origin, const Vec3 &_axis, float _snap, float _worldHeight, float _worldSize, float *_out_);
     void gizmoAxisScale_Draw(Id _id, const Vec3 &_origin, const Vec3 &_axis, float _worldHeight, float _worldSize, Color _color);
 
+    // Broad phase for the gizmo m_appId, _bounds must contain all of its handles. Return true if the gizmo should run its behaviors.
+    // With m_gizmoTwoPhasePicking the bounds are registered and only the candidates selected during reset() pass, else any
+    // gizmo whose bounds intersect the cursor ray passes. The hot gizmo always passes.
+    bool gizmoBroadphase(const Sphere &_bounds);
+
     // Convert pixels -> world space size based on distance between _position and view origin.
     float pixelsToWorldSize(const Vec3 &_position, float _pixels);
     // Convert world space size -> pixels based on distance between _position and view origin.
@@ -314,6 +373,15 @@ public:
     float m_gizmoStateFloat;   //               "
     float m_gizmoHeightPixels; // Height/radius of gizmos.
     float m_gizmoSizePixels;   // Thickness of gizmo lines.
+    bool m_gizmoTwoPhasePicking; // Only the nearest gizmo under the cursor runs its behaviors, see gizmoBroadphase().
+    Vector<Id> m_gizmoPickCandidates; // Gizmos which may be nearest along the cursor ray, from the previous frame's bounds and hits.
+
+    // picking
+
+    // Find the nearest primitive hit by the ray, call after endFrame(). Points and lines are hit within their pixel size
+    // (VertexData::m_positionSize.w) of the ray. Search only _layerId, or all layers if Id_Invalid. The acceleration structure
+    // of a layer is built on the first query which reaches it and reused until the next reset().
+    bool pickRay(const Vec3 &_origin, const Vec3 &_direction, RayHit &hit_, Id _layerId = Id_Invalid);
 
     // stats/debugging
 
@@ -323,6 +391,12 @@ public:
     // Return the number of layers.
     U32 getLayerCount() const { return m_layerIdMap.size(); }
 
+    // Return the number of retained primitives with a lifetime, including expired ones behind a live one until compaction.
+    U32 getTimedPrimitiveCount() const { return m_timedPrims.size() - m_timedHead; }
+
+    // Return the number of timed primitives dropped because the vertex store was full of live primitives.
+    U32 getTimedDropCount() const { return m_timedDropCount; }
+
 private:
     // state stacks
     Vector<Color> m_colorStack;
@@ -332,6 +406,7 @@ private:
     Vector<Mat4> m_matrixStack;
     Vector<Id> m_idStack;
     Vector<Id> m_layerIdStack;
+    Vector<float> m_lifetimeStack;
 
     // vertex data: one list per layer, per primitive type, *2 for sorted/unsorted
     typedef Vector<VertexData> VertexList;
@@ -358,6 +433,51 @@ private:
     Vec4 m_cullFrustum[FrustumPlane_Count]; // Optimized frustum planes from m_appData.m_cullFrustum.
     int m_cullFrustumCount;                 // # valid frustum planes in m_cullFrustum.
 
+    // timed primitives, ordered by submission; expired primitives at the head are reclaimed during reset(), expired primitives
+    // behind a live one once the vertex store is full (see compactTimedPrimitives()). A live primitive is never dropped.
+    Vector<VertexData> m_timedVertexData;  // IM3D_TIMED_VERTEX_CAPACITY vertices, allocated on first use.
+    Vector<TimedPrimitive> m_timedPrims;   // Primitives referencing m_timedVertexData in submission order.
+    U32 m_timedHead;                       // Index of the oldest retained primitive in m_timedPrims.
+    U32 m_timedVertexTail;                 // Next free vertex in m_timedVertexData.
+    double m_timedMinExpiryTime;           // Lower bound of m_expiryTime over the retained primitives.
+    U32 m_timedMinExpiryFrame;             // Lower bound of m_expiryFrame over the retained primitives.
+    U32 m_timedDropCount;                  // # primitives dropped because the vertex store was full of live primitives.
+    double m_time;                         // Accumulated AppData::m_deltaTime.
+    U32 m_frame;                           // # calls to reset().
+
+    // unit-space gizmo geometry, built on first use and appended per frame with a transform, color and size
+    enum GizmoGeometry
+    {
+        GizmoGeometry_ScaleLine,  // Line from 0.2 to 1 on +z.
+        GizmoGeometry_ScalePoint, // Point at 1 on +z, 2x size.
+        GizmoGeometry_Ring16,     // Unit circle in the xy plane, as a line list. Each ring level doubles the segment count.
+        GizmoGeometry_Ring32,
+        GizmoGeometry_Ring64,
+        GizmoGeometry_Ring128,
+
+        GizmoGeometry_Count
+    };
+    VertexList m_gizmoGeometry[GizmoGeometry_Count];
+
+    // two-phase gizmo picking, bounds registered via gizmoBroadphase() during the current frame
+    Vector<Id> m_gizmoPickIds;
+    Vector<Vec4> m_gizmoPickBounds;   // xyz = origin, w = radius.
+    Vector<float> m_gizmoPickDepths;  // Nearest precise hit of the gizmo's behaviors (see makeHot()), FLT_MAX if none ran or hit.
+    Vector<float> m_gizmoPickEntries; // Scratch for reset(), cursor ray depth at which the bounds are entered.
+    Vector<U32> m_gizmoPickOrder;     // Scratch for reset(), registered gizmos hit by the cursor ray, by entry depth.
+
+    // primitive picking, see pickRay(); cleared during reset()
+    Vector<U32> m_pickRoots;              // Root node per layer index, ~0 if not built yet.
+    Vector<PickNode> m_pickNodes;
+    Vector<PickPrimitive> m_pickPrimitives;
+
+    // Build the hierarchy for _layerIndex, return the root node.
+    U32 buildPickLayer(int _layerIndex);
+    // Fill node _node with _count primitives from _first, split recursively.
+    void buildPickNode(U32 _node, U32 _first, U32 _count);
+    // Test _prim against the ray, return true if hit nearer than hit_.m_depth.
+    bool pickPrimitive(const PickPrimitive &_prim, const Vec3 &_origin, const Vec3 &_direction, RayHit &hit_);
+
     // Sort primitive data.
     void sort();
 
@@ -365,6 +485,21 @@ private:
     int findLayerIndex(Id _id) const;
 
     VertexList *getCurrentVertexList();
+
+    // Copy _count vertices of the current primitive into the timed store, the primitive is dropped if they don't fit.
+    void pushTimedPrimitive(const VertexData *_vdata, U32 _count);
+    // Remove the expired primitives and move the live ones to the start of the store, in order.
+    void compactTimedPrimitives();
+    bool isExpired(const TimedPrimitive &_prim) const;
+    // Append live timed primitives from _src which weren't submitted during the current frame.
+    void appendTimedPrimitives(const Context &_src);
+
+    // Return the ring geometry with at least _detail segments (clamped to the finest ring).
+    GizmoGeometry getGizmoRing(int _detail) const;
+    const VertexList &getGizmoGeometry(GizmoGeometry _geometry);
+    // Append _geometry to the current primitive (call between begin()/end()), transformed by the current matrix * _transform.
+    // Vertex colors are replaced by _color, vertex sizes are multiples of _size.
+    void appendGizmoGeometry(GizmoGeometry _geometry, const Mat4 &_transform, Color _color, float _size);
 };
 
 namespace internal
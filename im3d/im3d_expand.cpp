@@ -0,0 +1,300 @@
+#include "im3d_expand.h"
+#include "im3d_math.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Im3d
+{
+
+namespace
+{
+const U32 VertsPerDrawPrimitive[DrawPrimitive_Count] = {3, 2, 1};
+const U32 ExpandedVertsPerDrawPrimitive[DrawPrimitive_Count] = {3, 6, 6};
+
+// quad corners in the order of the shader's triangle strip (0,1,2,3), emitted as triangles 0,1,2 + 2,1,3
+const Vec2 QuadCorners[4] = {Vec2(-1.0f, -1.0f), Vec2(1.0f, -1.0f), Vec2(-1.0f, 1.0f), Vec2(1.0f, 1.0f)};
+const int QuadIndices[6] = {0, 1, 2, 2, 1, 3};
+
+inline Vec4 Transform(const float _m[16], const Vec4 &_p)
+{
+    return Vec4(
+        _m[0] * _p.x + _m[4] * _p.y + _m[8] * _p.z + _m[12],
+        _m[1] * _p.x + _m[5] * _p.y + _m[9] * _p.z + _m[13],
+        _m[2] * _p.x + _m[6] * _p.y + _m[10] * _p.z + _m[14],
+        _m[3] * _p.x + _m[7] * _p.y + _m[11] * _p.z + _m[15]);
+}
+
+inline float Smoothstep(float _edge0, float _edge1, float _x)
+{
+    float t = Clamp((_x - _edge0) / (_edge1 - _edge0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+inline Color FadeAlpha(Color _color, float _fade)
+{
+    _color.setA(_color.getA() * _fade);
+    return _color;
+}
+
+void ExpandPoints(const VertexData *_vdata, U32 _count, const float _viewProj[16], const Vec2 &_viewport, ExpandedVertex *_out_)
+{
+    for (U32 i = 0; i < _count; ++i)
+    {
+        const VertexData &v = _vdata[i];
+        float size = Max(v.m_positionSize.w, kExpandAntialiasing);
+        Color color = FadeAlpha(v.m_color, Smoothstep(0.0f, 1.0f, size / kExpandAntialiasing));
+        Vec4 clip = Transform(_viewProj, v.m_positionSize);
+        Vec2 scale = Vec2(size / _viewport.x, size / _viewport.y) * clip.w;
+        for (int j = 0; j < 6; ++j)
+        {
+            const Vec2 &corner = QuadCorners[QuadIndices[j]];
+            ExpandedVertex &out = *_out_++;
+            out.m_position = Vec4(clip.x + corner.x * scale.x, clip.y + corner.y * scale.y, clip.z, clip.w);
+            out.m_edge = Vec4(corner.x * 0.5f + 0.5f, corner.y * 0.5f + 0.5f, size, (float)DrawPrimitive_Points);
+            out.m_color = color;
+        }
+    }
+}
+
+void ExpandLines(const VertexData *_vdata, U32 _count, const float _viewProj[16], const Vec2 &_viewport, ExpandedVertex *_out_)
+{
+    for (U32 i = 0; i < _count; i += 2)
+    {
+        Vec4 clip[2];
+        float size[2];
+        Color color[2];
+        for (int k = 0; k < 2; ++k)
+        {
+            const VertexData &v = _vdata[i + k];
+            clip[k] = Transform(_viewProj, v.m_positionSize);
+            color[k] = FadeAlpha(v.m_color, Smoothstep(0.0f, 1.0f, v.m_positionSize.w / kExpandAntialiasing));
+            size[k] = Max(v.m_positionSize.w, kExpandAntialiasing);
+        }
+
+        // screen space direction, corrected for aspect ratio
+        Vec2 dir = Vec2(clip[0].x / clip[0].w - clip[1].x / clip[1].w, clip[0].y / clip[0].w - clip[1].y / clip[1].w);
+        dir.y *= _viewport.y / _viewport.x;
+        float len = Length(dir);
+        dir = len > 0.0f ? dir / len : Vec2(1.0f, 0.0f);
+
+        for (int j = 0; j < 6; ++j)
+        {
+            int corner = QuadIndices[j];
+            int k = corner % 2; // even corners are the line start
+            float side = QuadCorners[corner].y;
+            ExpandedVertex &out = *_out_++;
+            out.m_position = clip[k];
+            out.m_position.x += -dir.y * size[k] / _viewport.x * side * clip[k].w;
+            out.m_position.y += dir.x * size[k] / _viewport.y * side * clip[k].w;
+            out.m_edge = Vec4(size[k] * side, 0.0f, size[k], (float)DrawPrimitive_Lines);
+            out.m_color = color[k];
+        }
+    }
+}
+
+void ExpandTriangles(const VertexData *_vdata, U32 _count, const float _viewProj[16], ExpandedVertex *_out_)
+{
+    for (U32 i = 0; i < _count; ++i)
+    {
+        ExpandedVertex &out = _out_[i];
+        out.m_position = Transform(_viewProj, _vdata[i].m_positionSize);
+        out.m_edge = Vec4(0.0f, 0.0f, 0.0f, (float)DrawPrimitive_Triangles);
+        out.m_color = _vdata[i].m_color;
+    }
+}
+
+struct ExpandJob
+{
+    const DrawList *m_drawList;
+    U32 m_firstPrim;
+    U32 m_primCount;
+    ExpandedVertex *m_out;
+};
+
+// Worker threads started on first use and kept until exit. One batch of jobs runs at a time, the calling thread takes part and
+// jobs are handed out in order through an atomic counter.
+class ExpandPool
+{
+    std::mutex m_dispatchMutex; // held by ExpandDrawLists() for the whole batch
+    std::mutex m_mutex;         // guards the batch state below
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::vector<std::thread> m_workers;
+    bool m_quit = false;
+    U32 m_generation = 0;    // incremented per batch
+    U32 m_activeWorkers = 0; // workers [0, m_activeWorkers) take part in the current batch
+    U32 m_busyWorkers = 0;   // active workers which haven't finished the current batch
+    std::atomic<U32> m_nextJob{0};
+    const float *m_viewProj = nullptr;
+    Vec2 m_viewport;
+
+    void runJobs()
+    {
+        for (U32 i; (i = m_nextJob.fetch_add(1, std::memory_order_relaxed)) < m_jobs.size();)
+        {
+            const ExpandJob &job = m_jobs[i];
+            ExpandPrimitives(*job.m_drawList, job.m_firstPrim, job.m_primCount, m_viewProj, m_viewport, job.m_out);
+        }
+    }
+
+    void workerMain(U32 _index)
+    {
+        U32 generation = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_wake.wait(lock, [&]() { return m_quit || m_generation != generation; });
+            if (m_quit)
+            {
+                return;
+            }
+            generation = m_generation;
+            if (_index >= m_activeWorkers)
+            {
+                continue;
+            }
+            lock.unlock();
+            runJobs();
+            lock.lock();
+            if (--m_busyWorkers == 0)
+            {
+                m_done.notify_one();
+            }
+        }
+    }
+
+public:
+    std::vector<ExpandJob> m_jobs; // filled by the caller while holding lockDispatch()
+
+    ~ExpandPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_wake.notify_all();
+        for (auto &worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    std::unique_lock<std::mutex> lockDispatch() { return std::unique_lock<std::mutex>(m_dispatchMutex); }
+
+    // Run jobs on _threadCount threads including the caller, return once all are done.
+    void run(U32 _threadCount, const float _viewProj[16], const Vec2 &_viewport)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (m_workers.size() < _threadCount - 1)
+            {
+                m_workers.emplace_back(&ExpandPool::workerMain, this, (U32)m_workers.size());
+            }
+            m_viewProj = _viewProj;
+            m_viewport = _viewport;
+            m_nextJob.store(0, std::memory_order_relaxed);
+            m_activeWorkers = _threadCount - 1;
+            m_busyWorkers = _threadCount - 1;
+            ++m_generation;
+        }
+        m_wake.notify_all();
+        runJobs();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&]() { return m_busyWorkers == 0; });
+    }
+};
+
+ExpandPool &GetExpandPool()
+{
+    static ExpandPool pool;
+    return pool;
+}
+} // namespace
+
+U32 GetExpandedVertexCount(DrawPrimitiveType _primType, U32 _primCount)
+{
+    return _primCount * ExpandedVertsPerDrawPrimitive[_primType];
+}
+
+U32 GetExpandedVertexCount(const DrawList *_drawLists, U32 _drawListCount)
+{
+    U32 ret = 0;
+    for (U32 i = 0; i < _drawListCount; ++i)
+    {
+        const DrawList &dl = _drawLists[i];
+        ret += GetExpandedVertexCount(dl.m_primType, dl.m_vertexCount / VertsPerDrawPrimitive[dl.m_primType]);
+    }
+    return ret;
+}
+
+void ExpandPrimitives(const DrawList &_drawList, U32 _firstPrim, U32 _primCount, const float _viewProj[16], const Vec2 &_viewport, ExpandedVertex *_out_)
+{
+    U32 primSize = VertsPerDrawPrimitive[_drawList.m_primType];
+    IM3D_ASSERT((_firstPrim + _primCount) * primSize <= _drawList.m_vertexCount);
+    const VertexData *vdata = _drawList.m_vertexData + _firstPrim * primSize;
+    switch (_drawList.m_primType)
+    {
+    case DrawPrimitive_Points:
+        ExpandPoints(vdata, _primCount, _viewProj, _viewport, _out_);
+        break;
+    case DrawPrimitive_Lines:
+        ExpandLines(vdata, _primCount * 2, _viewProj, _viewport, _out_);
+        break;
+    case DrawPrimitive_Triangles:
+        ExpandTriangles(vdata, _primCount * 3, _viewProj, _out_);
+        break;
+    default:
+        IM3D_ASSERT(false);
+        break;
+    };
+}
+
+U32 ExpandDrawLists(const DrawList *_drawLists, U32 _drawListCount, const float _viewProj[16], const Vec2 &_viewport, ExpandedVertex *_out_, int _threadCount)
+{
+    // split the primitives into ~equal jobs, a job never spans draw lists
+    U32 totalPrims = 0;
+    for (U32 i = 0; i < _drawListCount; ++i)
+    {
+        totalPrims += _drawLists[i].m_vertexCount / VertsPerDrawPrimitive[_drawLists[i].m_primType];
+    }
+    const U32 kMinPrimsPerJob = 1024; // below this threading costs more than it saves
+    U32 threadCount = _threadCount > 1 ? (U32)_threadCount : 1;
+    U32 primsPerJob = (totalPrims + threadCount - 1) / threadCount;
+    primsPerJob = primsPerJob > kMinPrimsPerJob ? primsPerJob : kMinPrimsPerJob;
+    if (threadCount == 1 || totalPrims <= primsPerJob)
+    {
+        ExpandedVertex *out = _out_;
+        for (U32 i = 0; i < _drawListCount; ++i)
+        {
+            const DrawList &dl = _drawLists[i];
+            U32 primCount = dl.m_vertexCount / VertsPerDrawPrimitive[dl.m_primType];
+            ExpandPrimitives(dl, 0, primCount, _viewProj, _viewport, out);
+            out += GetExpandedVertexCount(dl.m_primType, primCount);
+        }
+        return (U32)(out - _out_);
+    }
+
+    ExpandPool &pool = GetExpandPool();
+    auto dispatch = pool.lockDispatch();
+    pool.m_jobs.clear();
+    ExpandedVertex *out = _out_;
+    for (U32 i = 0; i < _drawListCount; ++i)
+    {
+        const DrawList &dl = _drawLists[i];
+        U32 primCount = dl.m_vertexCount / VertsPerDrawPrimitive[dl.m_primType];
+        for (U32 first = 0; first < primCount; first += primsPerJob)
+        {
+            U32 count = primCount - first < primsPerJob ? primCount - first : primsPerJob;
+            pool.m_jobs.push_back({&dl, first, count, out});
+            out += GetExpandedVertexCount(dl.m_primType, count);
+        }
+    }
+    U32 jobCount = (U32)pool.m_jobs.size();
+    pool.run(threadCount < jobCount ? threadCount : jobCount, _viewProj, _viewport);
+    return (U32)(out - _out_);
+}
+
+} // namespace Im3d
@@ -0,0 +1,32 @@
+#pragma once
+#include "im3d_context.h"
+
+namespace Im3d
+{
+
+// CPU point/line expansion, the same work the vertex shader does in shaders/im3d.glsl (or the geometry shaders in im3d.hlsl).
+// Points and lines become view-aligned quads (2 triangles each) with the antialiasing attributes the fragment shader needs,
+// triangles are passed through. The output is a flat triangle list which any backend can draw with a single call.
+struct ExpandedVertex
+{
+    Vec4 m_position; // Clip space.
+    Vec4 m_edge;     // xy = point uv in [0,1] or line edge distance in x (pixels), z = size (pixels), w = DrawPrimitiveType.
+    Color m_color;   // Alpha includes the thin line fade.
+};
+
+constexpr float kExpandAntialiasing = 2.0f; // Must match kAntialiasing in the shader.
+
+// Return the number of output vertices for _primCount primitives of _primType.
+U32 GetExpandedVertexCount(DrawPrimitiveType _primType, U32 _primCount);
+// Return the number of output vertices for all of _drawLists.
+U32 GetExpandedVertexCount(const DrawList *_drawLists, U32 _drawListCount);
+
+// Expand _primCount primitives of _drawList starting at _firstPrim into _out_. Ranges are independent so a draw list can be split
+// across threads. _viewProj is column-major (as passed to glUniformMatrix4fv), clip = _viewProj * position.
+void ExpandPrimitives(const DrawList &_drawList, U32 _firstPrim, U32 _primCount, const float _viewProj[16], const Vec2 &_viewport, ExpandedVertex *_out_);
+
+// Expand all of _drawLists into _out_, which must have room for GetExpandedVertexCount(_drawLists, _drawListCount) vertices.
+// Work is split evenly between _threadCount threads (including the calling thread). Return the number of vertices written.
+U32 ExpandDrawLists(const DrawList *_drawLists, U32 _drawListCount, const float _viewProj[16], const Vec2 &_viewport, ExpandedVertex *_out_, int _threadCount = 1);
+
+} // namespace Im3d
@@ -5,6 +5,7 @@
 // im3d_math.h is optional - include only if you want to use the Im3d math types directly
 
 #include "im3d_types.h"
+#include "im3d_simd.h"
 
 #include <cmath>
 
@@ -97,25 +98,15 @@ Mat3 Rotation(const Vec3 &_axis, float _rads); // _axis must be unit length
 Mat3 Scale(const Vec3 &_s);
 
 // Mat4
+#ifdef IM3D_MATRIX_ROW_MAJOR
+constexpr simd::Layout MatrixLayout = simd::Layout::RowMajor;
+#else
+constexpr simd::Layout MatrixLayout = simd::Layout::ColumnMajor;
+#endif
 inline Mat4 operator*(const Mat4 &_lhs, const Mat4 &_rhs)
 {
     Mat4 ret;
-    ret(0, 0) = _lhs(0, 0) * _rhs(0, 0) + _lhs(0, 1) * _rhs(1, 0) + _lhs(0, 2) * _rhs(2, 0) + _lhs(0, 3) * _rhs(3, 0);
-    ret(0, 1) = _lhs(0, 0) * _rhs(0, 1) + _lhs(0, 1) * _rhs(1, 1) + _lhs(0, 2) * _rhs(2, 1) + _lhs(0, 3) * _rhs(3, 1);
-    ret(0, 2) = _lhs(0, 0) * _rhs(0, 2) + _lhs(0, 1) * _rhs(1, 2) + _lhs(0, 2) * _rhs(2, 2) + _lhs(0, 3) * _rhs(3, 2);
-    ret(0, 3) = _lhs(0, 0) * _rhs(0, 3) + _lhs(0, 1) * _rhs(1, 3) + _lhs(0, 2) * _rhs(2, 3) + _lhs(0, 3) * _rhs(3, 3);
-    ret(1, 0) = _lhs(1, 0) * _rhs(0, 0) + _lhs(1, 1) * _rhs(1, 0) + _lhs(1, 2) * _rhs(2, 0) + _lhs(1, 3) * _rhs(3, 0);
-    ret(1, 1) = _lhs(1, 0) * _rhs(0, 1) + _lhs(1, 1) * _rhs(1, 1) + _lhs(1, 2) * _rhs(2, 1) + _lhs(1, 3) * _rhs(3, 1);
-    ret(1, 2) = _lhs(1, 0) * _rhs(0, 2) + _lhs(1, 1) * _rhs(1, 2) + _lhs(1, 2) * _rhs(2, 2) + _lhs(1, 3) * _rhs(3, 2);
-    ret(1, 3) = _lhs(1, 0) * _rhs(0, 3) + _lhs(1, 1) * _rhs(1, 3) + _lhs(1, 2) * _rhs(2, 3) + _lhs(1, 3) * _rhs(3, 3);
-    ret(2, 0) = _lhs(2, 0) * _rhs(0, 0) + _lhs(2, 1) * _rhs(1, 0) + _lhs(2, 2) * _rhs(2, 0) + _lhs(2, 3) * _rhs(3, 0);
-    ret(2, 1) = _lhs(2, 0) * _rhs(0, 1) + _lhs(2, 1) * _rhs(1, 1) + _lhs(2, 2) * _rhs(2, 1) + _lhs(2, 3) * _rhs(3, 1);
-    ret(2, 2) = _lhs(2, 0) * _rhs(0, 2) + _lhs(2, 1) * _rhs(1, 2) + _lhs(2, 2) * _rhs(2, 2) + _lhs(2, 3) * _rhs(3, 2);
-    ret(2, 3) = _lhs(2, 0) * _rhs(0, 3) + _lhs(2, 1) * _rhs(1, 3) + _lhs(2, 2) * _rhs(2, 3) + _lhs(2, 3) * _rhs(3, 3);
-    ret(3, 0) = _lhs(3, 0) * _rhs(0, 0) + _lhs(3, 1) * _rhs(1, 0) + _lhs(3, 2) * _rhs(2, 0) + _lhs(3, 3) * _rhs(3, 0);
-    ret(3, 1) = _lhs(3, 0) * _rhs(0, 1) + _lhs(3, 1) * _rhs(1, 1) + _lhs(3, 2) * _rhs(2, 1) + _lhs(3, 3) * _rhs(3, 1);
-    ret(3, 2) = _lhs(3, 0) * _rhs(0, 2) + _lhs(3, 1) * _rhs(1, 2) + _lhs(3, 2) * _rhs(2, 2) + _lhs(3, 3) * _rhs(3, 2);
-    ret(3, 3) = _lhs(3, 0) * _rhs(0, 3) + _lhs(3, 1) * _rhs(1, 3) + _lhs(3, 2) * _rhs(2, 3) + _lhs(3, 3) * _rhs(3, 3);
+    simd::Mul<MatrixLayout>(_lhs.m, _rhs.m, ret.m);
     return ret;
 }
 inline Vec3 operator*(const Mat4 &_m, const Vec3 &_pos)
@@ -127,12 +118,12 @@ inline Vec3 operator*(const Mat4 &_m, const Vec3 &_pos)
 }
 inline Vec4 operator*(const Mat4 &_m, const Vec4 &_v)
 {
-    return Vec4(
-        _m(0, 0) * _v.x + _m(0, 1) * _v.y + _m(0, 2) * _v.z + _m(0, 3) * _v.w,
-        _m(1, 0) * _v.x + _m(1, 1) * _v.y + _m(1, 2) * _v.z + _m(1, 3) * _v.w,
-        _m(2, 0) * _v.x + _m(2, 1) * _v.y + _m(2, 2) * _v.z + _m(2, 3) * _v.w,
-        _m(3, 0) * _v.x + _m(3, 1) * _v.y + _m(3, 2) * _v.z + _m(3, 3) * _v.w);
+    Vec4 ret;
+    simd::Transform<MatrixLayout>(_m.m, &_v.x, &ret.x, 1);
+    return ret;
 }
+// _out_[i] = _m * _v[i]
+inline void Transform(const Mat4 &_m, const Vec4 *_v, Vec4 *_out_, int _count) { simd::Transform<MatrixLayout>(_m.m, &_v->x, &_out_->x, _count); }
 Mat4 Inverse(const Mat4 &_m);
 Mat4 Transpose(const Mat4 &_m);
 Mat4 Translation(const Vec3 &_t);
@@ -0,0 +1,190 @@
+#include "im3d_polyline.h"
+#include "im3d_math.h"
+
+namespace Im3d
+{
+
+void Polyline::build(const float *_positions, U32 _count, U32 _stride)
+{
+    clear();
+    update(_positions, _count, _stride);
+}
+
+void Polyline::update(const float *_positions, U32 _count, U32 _stride)
+{
+    IM3D_ASSERT(_count >= m_count); // samples may only be appended, call build() otherwise
+    U32 prevCount = m_count;
+    m_positions = _positions;
+    m_stride = _stride ? _stride : (U32)sizeof(float) * 3;
+    m_count = _count;
+    if (m_count == prevCount)
+    {
+        return;
+    }
+
+    // bounds/length of the new samples
+    for (U32 i = prevCount; i < m_count; ++i)
+    {
+        Vec3 p = getPosition(i);
+        if (i == 0)
+        {
+            m_boundsMin = m_boundsMax = p;
+            continue;
+        }
+        m_boundsMin = Min(m_boundsMin, p);
+        m_boundsMax = Max(m_boundsMax, p);
+        m_length += Length(p - getPosition(i - 1));
+    }
+
+    // rebuild the tail of each level, starting at the (possibly partial) node which contained the previous last sample
+    m_levelCount = 1;
+    for (int level = 1; level < kMaxLevels && getNodeCount(level - 1) > 1; ++level)
+    {
+        Vector<U32> &nodes = m_levels[level];
+        U32 nodeCount = getNodeCount(level);
+        if (nodes.capacity() < nodeCount * 2)
+        {
+            nodes.reserve(nodeCount * 3); // amortize growth when streaming
+        }
+        nodes.resize(nodeCount * 2, 0);
+
+        U32 childCount = getNodeCount(level - 1);
+        for (U32 i = prevCount >> level; i < nodeCount; ++i)
+        {
+            U32 lo, hi;
+            U32 child = i * 2;
+            getNode(level - 1, child, lo, hi);
+            float loValue = getValue(lo);
+            float hiValue = getValue(hi);
+            if (loValue > hiValue)
+            {
+                U32 tmp = lo;
+                lo = hi;
+                hi = tmp;
+                loValue = getValue(lo);
+                hiValue = getValue(hi);
+            }
+            if (child + 1 < childCount)
+            {
+                U32 candidates[2];
+                getNode(level - 1, child + 1, candidates[0], candidates[1]);
+                for (U32 j : candidates)
+                {
+                    float v = getValue(j);
+                    if (v < loValue)
+                    {
+                        lo = j;
+                        loValue = v;
+                    }
+                    if (v > hiValue)
+                    {
+                        hi = j;
+                        hiValue = v;
+                    }
+                }
+            }
+            nodes[i * 2 + 0] = lo;
+            nodes[i * 2 + 1] = hi;
+        }
+
+        if (level >= kBoundsLevel)
+        {
+            Vector<Vec3> &bounds = m_bounds[level];
+            if (bounds.capacity() < nodeCount * 2)
+            {
+                bounds.reserve(nodeCount * 3);
+            }
+            bounds.resize(nodeCount * 2, Vec3(0.0f));
+            for (U32 i = prevCount >> level; i < nodeCount; ++i)
+            {
+                Vec3 bmin, bmax;
+                if (level == kBoundsLevel)
+                {
+                    U32 first = i << level;
+                    U32 end = m_count - first > (1u << level) ? first + (1u << level) : m_count;
+                    bmin = bmax = getPosition(first);
+                    for (U32 j = first + 1; j < end; ++j)
+                    {
+                        Vec3 p = getPosition(j);
+                        bmin = Min(bmin, p);
+                        bmax = Max(bmax, p);
+                    }
+                }
+                else
+                {
+                    U32 child = i * 2;
+                    getNodeBounds(level - 1, child, bmin, bmax);
+                    if (child + 1 < childCount)
+                    {
+                        Vec3 cmin, cmax;
+                        getNodeBounds(level - 1, child + 1, cmin, cmax);
+                        bmin = Min(bmin, cmin);
+                        bmax = Max(bmax, cmax);
+                    }
+                }
+                bounds[i * 2 + 0] = bmin;
+                bounds[i * 2 + 1] = bmax;
+            }
+        }
+        m_levelCount = level + 1;
+    }
+}
+
+void Polyline::clear()
+{
+    m_positions = nullptr;
+    m_count = 0;
+    m_levelCount = 0;
+    for (auto &level : m_levels)
+    {
+        level.clear();
+    }
+    for (auto &bounds : m_bounds)
+    {
+        bounds.clear();
+    }
+    m_boundsMin = m_boundsMax = Vec3(0.0f);
+    m_length = 0.0f;
+}
+
+void Polyline::getNode(int _level, U32 _i, U32 &_first_, U32 &_second_) const
+{
+    IM3D_ASSERT(_level < m_levelCount);
+    if (_level == 0)
+    {
+        _first_ = _second_ = _i;
+        return;
+    }
+    _first_ = m_levels[_level][_i * 2 + 0];
+    _second_ = m_levels[_level][_i * 2 + 1];
+    if (_first_ > _second_)
+    {
+        U32 tmp = _first_;
+        _first_ = _second_;
+        _second_ = tmp;
+    }
+}
+
+void Polyline::getNodeBounds(int _level, U32 _i, Vec3 &_min_, Vec3 &_max_) const
+{
+    IM3D_ASSERT(_level >= kBoundsLevel && _level < m_levelCount);
+    _min_ = m_bounds[_level][_i * 2 + 0];
+    _max_ = m_bounds[_level][_i * 2 + 1];
+}
+
+int Polyline::selectLevel(U32 _maxVertices, U32 _sampleCount) const
+{
+    // level 0 emits 1 vertex per node, higher levels up to 2
+    if (_sampleCount <= _maxVertices)
+    {
+        return 0;
+    }
+    int level = 1;
+    while (level < m_levelCount - 1 && (U32)(((unsigned long long)_sampleCount + (1u << level) - 1) >> level) * 2 > _maxVertices)
+    {
+        ++level;
+    }
+    return level;
+}
+
+} // namespace Im3d
@@ -0,0 +1,73 @@
+#pragma once
+#include "im3d_context.h"
+#include <cstddef>
+
+namespace Im3d
+{
+
+// Min/max decimation pyramid over a strided array of positions, for drawing very long polylines (e.g. time series trajectories).
+// Level 0 is the source data, each level k > 0 stores one node per 2^k samples. A node keeps the indices of the samples with the
+// min/max value along the value axis, so that spikes survive decimation. The position array is not copied; it must remain valid
+// while the polyline is drawn. Call update() after appending samples, only the tail of each level is rebuilt.
+// Levels >= kBoundsLevel also store the bounding box of each node, DrawPolyline() walks them to skip the spans outside the
+// cull frustum and to pick a level per visible span.
+class Polyline
+{
+public:
+    static constexpr int kMaxLevels = 32;
+    static constexpr int kBoundsLevel = 6; // 64 samples per node
+
+    // _valueAxis selects the component (0 = x, 1 = y, 2 = z) whose extrema are preserved.
+    Polyline(int _valueAxis = 1) : m_valueAxis(_valueAxis) {}
+
+    // Rebuild the pyramid from scratch. _stride is in bytes, 0 = tightly packed xyz.
+    void build(const float *_positions, U32 _count, U32 _stride = 0);
+    // Extend the pyramid to cover _count samples; samples before the previous count must not have changed.
+    void update(const float *_positions, U32 _count, U32 _stride = 0);
+    void clear();
+
+    U32 getCount() const { return m_count; }
+    int getValueAxis() const { return m_valueAxis; }
+    int getLevelCount() const { return m_levelCount; }
+    U32 getNodeCount(int _level) const { return (m_count + (1u << _level) - 1) >> _level; }
+    const Vec3 &getBoundsMin() const { return m_boundsMin; }
+    const Vec3 &getBoundsMax() const { return m_boundsMax; }
+    float getLength() const { return m_length; } // Sum of segment lengths.
+
+    Vec3 getPosition(U32 _i) const
+    {
+        const float *p = getSample(_i);
+        return Vec3(p[0], p[1], p[2]);
+    }
+
+    // Sample indices of the min/max of node _i at _level, in ascending order (_first_ <= _second_).
+    void getNode(int _level, U32 _i, U32 &_first_, U32 &_second_) const;
+
+    // Bounds of node _i at _level, _level >= kBoundsLevel.
+    void getNodeBounds(int _level, U32 _i, Vec3 &_min_, Vec3 &_max_) const;
+
+    // Select the finest level with at most _maxVertices output vertices, for the whole polyline or a span of _sampleCount.
+    int selectLevel(U32 _maxVertices) const { return selectLevel(_maxVertices, m_count); }
+    int selectLevel(U32 _maxVertices, U32 _sampleCount) const;
+
+private:
+    const float *m_positions = nullptr;
+    U32 m_stride = 0;
+    U32 m_count = 0;
+    int m_valueAxis;
+    int m_levelCount = 0;
+    Vector<U32> m_levels[kMaxLevels]; // 2 sample indices per node (min, max), m_levels[0] unused.
+    Vector<Vec3> m_bounds[kMaxLevels]; // 2 corners per node (min, max), levels < kBoundsLevel unused.
+    Vec3 m_boundsMin = Vec3(0.0f);
+    Vec3 m_boundsMax = Vec3(0.0f);
+    float m_length = 0.0f;
+
+    const float *getSample(U32 _i) const
+    {
+        IM3D_ASSERT(_i < m_count);
+        return (const float *)((const char *)m_positions + (std::size_t)_i * m_stride);
+    }
+    float getValue(U32 _i) const { return getSample(_i)[m_valueAxis]; }
+};
+
+} // namespace Im3d
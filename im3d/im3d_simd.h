@@ -0,0 +1,334 @@
+#pragma once
+#ifndef im3d_simd_h
+#define im3d_simd_h
+
+// 4x4 float matrix kernels, shared by the Im3d math types (im3d_math.h) and amth (screenstate/array_math.h).
+//
+// Matrices are 16 contiguous floats, the storage layout is a template parameter. Products follow the usual math convention
+// (_out_ = _a * _b, _out_ = _m * v) whatever the layout. The scalar:: versions are constexpr. The unqualified versions use
+// SSE2, which every x86-64 compiler targets by default (MSVC included, which never defines __SSE*__), and AVX on top when
+// the compiler targets it (-mavx, /arch:AVX). Define IM3D_SIMD 0 to force the scalar path. Outputs must not alias inputs.
+
+#ifndef IM3D_SIMD
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IM3D_SIMD 1
+#else
+#define IM3D_SIMD 0
+#endif
+#endif
+
+#if IM3D_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Im3d
+{
+namespace simd
+{
+
+enum class Layout
+{
+    ColumnMajor,
+    RowMajor
+};
+
+namespace scalar
+{
+
+// _out_ = _a * _b, column-major.
+constexpr void MulColumnMajor(const float *_a, const float *_b, float *_out_)
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            _out_[c * 4 + r] = _a[r] * _b[c * 4] + _a[4 + r] * _b[c * 4 + 1] + _a[8 + r] * _b[c * 4 + 2] + _a[12 + r] * _b[c * 4 + 3];
+        }
+    }
+}
+
+// _out_ = _a * _b. A row-major matrix is the column-major transpose, (A * B)^T = B^T * A^T.
+template <Layout L>
+constexpr void Mul(const float *_a, const float *_b, float *_out_)
+{
+    if (L == Layout::ColumnMajor)
+    {
+        MulColumnMajor(_a, _b, _out_);
+    }
+    else
+    {
+        MulColumnMajor(_b, _a, _out_);
+    }
+}
+
+// _out_[i] = _m * _v[i] for _count vectors of 4 floats.
+template <Layout L>
+constexpr void Transform(const float *_m, const float *_v, float *_out_, int _count)
+{
+    for (int i = 0; i < _count; ++i, _v += 4, _out_ += 4)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            if (L == Layout::ColumnMajor)
+            {
+                _out_[r] = _m[r] * _v[0] + _m[4 + r] * _v[1] + _m[8 + r] * _v[2] + _m[12 + r] * _v[3];
+            }
+            else
+            {
+                _out_[r] = _m[r * 4] * _v[0] + _m[r * 4 + 1] * _v[1] + _m[r * 4 + 2] * _v[2] + _m[r * 4 + 3] * _v[3];
+            }
+        }
+    }
+}
+
+// Same for either layout.
+constexpr void Transpose(const float *_m, float *_out_)
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            _out_[c * 4 + r] = _m[r * 4 + c];
+        }
+    }
+}
+
+// Cofactor expansion, the same for either layout (inverse(M^T) = inverse(M)^T). Return false if _m is singular, in which
+// case _out_ is the adjugate divided by 0.
+constexpr bool Inverse(const float *_m, float *_out_)
+{
+    float s0 = _m[0] * _m[5] - _m[4] * _m[1];
+    float s1 = _m[0] * _m[6] - _m[4] * _m[2];
+    float s2 = _m[0] * _m[7] - _m[4] * _m[3];
+    float s3 = _m[1] * _m[6] - _m[5] * _m[2];
+    float s4 = _m[1] * _m[7] - _m[5] * _m[3];
+    float s5 = _m[2] * _m[7] - _m[6] * _m[3];
+    float c5 = _m[10] * _m[15] - _m[14] * _m[11];
+    float c4 = _m[9] * _m[15] - _m[13] * _m[11];
+    float c3 = _m[9] * _m[14] - _m[13] * _m[10];
+    float c2 = _m[8] * _m[15] - _m[12] * _m[11];
+    float c1 = _m[8] * _m[14] - _m[12] * _m[10];
+    float c0 = _m[8] * _m[13] - _m[12] * _m[9];
+
+    float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    float invDet = 1.0f / det;
+
+    _out_[0] = (_m[5] * c5 - _m[6] * c4 + _m[7] * c3) * invDet;
+    _out_[1] = (-_m[1] * c5 + _m[2] * c4 - _m[3] * c3) * invDet;
+    _out_[2] = (_m[13] * s5 - _m[14] * s4 + _m[15] * s3) * invDet;
+    _out_[3] = (-_m[9] * s5 + _m[10] * s4 - _m[11] * s3) * invDet;
+    _out_[4] = (-_m[4] * c5 + _m[6] * c2 - _m[7] * c1) * invDet;
+    _out_[5] = (_m[0] * c5 - _m[2] * c2 + _m[3] * c1) * invDet;
+    _out_[6] = (-_m[12] * s5 + _m[14] * s2 - _m[15] * s1) * invDet;
+    _out_[7] = (_m[8] * s5 - _m[10] * s2 + _m[11] * s1) * invDet;
+    _out_[8] = (_m[4] * c4 - _m[5] * c2 + _m[7] * c0) * invDet;
+    _out_[9] = (-_m[0] * c4 + _m[1] * c2 - _m[3] * c0) * invDet;
+    _out_[10] = (_m[12] * s4 - _m[13] * s2 + _m[15] * s0) * invDet;
+    _out_[11] = (-_m[8] * s4 + _m[9] * s2 - _m[11] * s0) * invDet;
+    _out_[12] = (-_m[4] * c3 + _m[5] * c1 - _m[6] * c0) * invDet;
+    _out_[13] = (_m[0] * c3 - _m[1] * c1 + _m[2] * c0) * invDet;
+    _out_[14] = (-_m[12] * s3 + _m[13] * s1 - _m[14] * s0) * invDet;
+    _out_[15] = (_m[8] * s3 - _m[9] * s1 + _m[10] * s0) * invDet;
+    return det != 0.0f;
+}
+
+} // namespace scalar
+
+#if IM3D_SIMD
+namespace sse
+{
+
+inline void MulColumnMajor(const float *_a, const float *_b, float *_out_)
+{
+    __m128 a0 = _mm_loadu_ps(_a);
+    __m128 a1 = _mm_loadu_ps(_a + 4);
+    __m128 a2 = _mm_loadu_ps(_a + 8);
+    __m128 a3 = _mm_loadu_ps(_a + 12);
+    for (int c = 0; c < 4; ++c)
+    {
+        const float *b = _b + c * 4;
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[3])));
+        _mm_storeu_ps(_out_ + c * 4, r);
+    }
+}
+
+inline void Transpose(const float *_m, float *_out_)
+{
+    __m128 r0 = _mm_loadu_ps(_m);
+    __m128 r1 = _mm_loadu_ps(_m + 4);
+    __m128 r2 = _mm_loadu_ps(_m + 8);
+    __m128 r3 = _mm_loadu_ps(_m + 12);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(_out_, r0);
+    _mm_storeu_ps(_out_ + 4, r1);
+    _mm_storeu_ps(_out_ + 8, r2);
+    _mm_storeu_ps(_out_ + 12, r3);
+}
+
+// _out_[i] = _m * _v[i], _m column-major.
+inline void TransformColumnMajor(const float *_m, const float *_v, float *_out_, int _count)
+{
+    __m128 c0 = _mm_loadu_ps(_m);
+    __m128 c1 = _mm_loadu_ps(_m + 4);
+    __m128 c2 = _mm_loadu_ps(_m + 8);
+    __m128 c3 = _mm_loadu_ps(_m + 12);
+    int i = 0;
+#ifdef __AVX__
+    // 2 vectors per iteration, one per 128 bit lane
+    __m256 cc0 = _mm256_set_m128(c0, c0);
+    __m256 cc1 = _mm256_set_m128(c1, c1);
+    __m256 cc2 = _mm256_set_m128(c2, c2);
+    __m256 cc3 = _mm256_set_m128(c3, c3);
+    for (; i + 2 <= _count; i += 2)
+    {
+        __m256 v = _mm256_loadu_ps(_v + i * 4);
+        __m256 r = _mm256_mul_ps(cc0, _mm256_permute_ps(v, 0x00));
+        r = _mm256_add_ps(r, _mm256_mul_ps(cc1, _mm256_permute_ps(v, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(cc2, _mm256_permute_ps(v, 0xaa)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(cc3, _mm256_permute_ps(v, 0xff)));
+        _mm256_storeu_ps(_out_ + i * 4, r);
+    }
+#endif
+    for (; i < _count; ++i)
+    {
+        __m128 v = _mm_loadu_ps(_v + i * 4);
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xaa)));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, 0xff)));
+        _mm_storeu_ps(_out_ + i * 4, r);
+    }
+}
+
+// 2x2 block inverse on rows (works on columns just the same). Each __m128 holds a 2x2 block, row-major.
+inline __m128 Mat2Mul(__m128 _a, __m128 _b)
+{
+    return _mm_add_ps(_mm_mul_ps(_a, _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(3, 0, 3, 0))),
+                      _mm_mul_ps(_mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+// adjugate(_a) * _b
+inline __m128 Mat2AdjMul(__m128 _a, __m128 _b)
+{
+    return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(_a, _a, _MM_SHUFFLE(0, 0, 3, 3)), _b),
+                      _mm_mul_ps(_mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+// _a * adjugate(_b)
+inline __m128 Mat2MulAdj(__m128 _a, __m128 _b)
+{
+    return _mm_sub_ps(_mm_mul_ps(_a, _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(0, 3, 0, 3))),
+                      _mm_mul_ps(_mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+inline bool Inverse(const float *_m, float *_out_)
+{
+    __m128 r0 = _mm_loadu_ps(_m);
+    __m128 r1 = _mm_loadu_ps(_m + 4);
+    __m128 r2 = _mm_loadu_ps(_m + 8);
+    __m128 r3 = _mm_loadu_ps(_m + 12);
+
+    // 2x2 blocks A B / C D
+    __m128 A = _mm_movelh_ps(r0, r1);
+    __m128 B = _mm_movehl_ps(r1, r0);
+    __m128 C = _mm_movelh_ps(r2, r3);
+    __m128 D = _mm_movehl_ps(r3, r2);
+
+    // determinants of A, B, C, D
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+        _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+    __m128 detA = _mm_shuffle_ps(detSub, detSub, 0x00);
+    __m128 detB = _mm_shuffle_ps(detSub, detSub, 0x55);
+    __m128 detC = _mm_shuffle_ps(detSub, detSub, 0xaa);
+    __m128 detD = _mm_shuffle_ps(detSub, detSub, 0xff);
+
+    __m128 D_C = Mat2AdjMul(D, C);
+    __m128 A_B = Mat2AdjMul(A, B);
+    __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+
+    // det(M) = det(A) * det(D) + det(B) * det(C) - tr(adj(A) * B * adj(D) * C)
+    __m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+    __m128 tr = _mm_mul_ps(A_B, _mm_shuffle_ps(D_C, D_C, _MM_SHUFFLE(3, 1, 2, 0)));
+    tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1))); // horizontal sum without SSE3
+    tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+    detM = _mm_sub_ps(detM, tr);
+
+    __m128 rcpDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    X = _mm_mul_ps(X, rcpDetM);
+    Y = _mm_mul_ps(Y, rcpDetM);
+    Z = _mm_mul_ps(Z, rcpDetM);
+    W = _mm_mul_ps(W, rcpDetM);
+
+    _mm_storeu_ps(_out_, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(_out_ + 4, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+    _mm_storeu_ps(_out_ + 8, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(_out_ + 12, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+    return _mm_cvtss_f32(detM) != 0.0f;
+}
+
+} // namespace sse
+#endif // IM3D_SIMD
+
+template <Layout L>
+inline void Mul(const float *_a, const float *_b, float *_out_)
+{
+#if IM3D_SIMD
+    if (L == Layout::ColumnMajor)
+    {
+        sse::MulColumnMajor(_a, _b, _out_);
+    }
+    else
+    {
+        sse::MulColumnMajor(_b, _a, _out_);
+    }
+#else
+    scalar::Mul<L>(_a, _b, _out_);
+#endif
+}
+
+template <Layout L>
+inline void Transform(const float *_m, const float *_v, float *_out_, int _count)
+{
+#if IM3D_SIMD
+    if (L == Layout::ColumnMajor)
+    {
+        sse::TransformColumnMajor(_m, _v, _out_, _count);
+    }
+    else
+    {
+        float m[16];
+        sse::Transpose(_m, m);
+        sse::TransformColumnMajor(m, _v, _out_, _count);
+    }
+#else
+    scalar::Transform<L>(_m, _v, _out_, _count);
+#endif
+}
+
+inline void Transpose(const float *_m, float *_out_)
+{
+#if IM3D_SIMD
+    sse::Transpose(_m, _out_);
+#else
+    scalar::Transpose(_m, _out_);
+#endif
+}
+
+inline bool Inverse(const float *_m, float *_out_)
+{
+#if IM3D_SIMD
+    return sse::Inverse(_m, _out_);
+#else
+    return scalar::Inverse(_m, _out_);
+#endif
+}
+
+} // namespace simd
+} // namespace Im3d
+
+#endif // im3d_simd_h
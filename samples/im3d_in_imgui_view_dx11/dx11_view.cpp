@@ -6,7 +6,12 @@
 
 #include "im3d_impl.h"
 #include "im3d_impl_dx11.h"
+#include "frame_telemetry.h"
 #include <im3d.h>
+#include <im3d_context.h>
+#include <im3d_polyline.h>
+#include <math.h>
+#include <vector>
 
 class DX11ViewImpl
 {
@@ -16,18 +21,72 @@ class DX11ViewImpl
     DX11Renderer renderer;
     Im3dImplDx11 im3dImplDx11;
 
+    // a long oscillating series drawn with Im3d::DrawPolyline, its cost shows in the Im3dUser, Im3dEndFrame and
+    // DrawIm3d phases. zoom in and out to see the vertex count follow the on screen width.
+    std::vector<float> series;
+    Im3d::Polyline polyline;
+
+    // markers placed along the series, their gizmos overlap on screen and only the nearest one under the cursor runs
+    // (Context::m_gizmoTwoPhasePicking). the sample under the cursor is found with Context::pickRay() after EndFrame().
+    std::array<std::array<float, 3>, 3> markers = {{{-3.0f, 2.0f, -2.0f}, {-2.5f, 2.0f, -1.0f}, {-2.0f, 2.0f, 0.0f}}};
+    bool hasPick = false;
+    Im3d::Vec3 pickPosition;
+
 public:
-    void *Draw(void *deviceContext, const screenstate::ScreenState &viewState)
+    DX11ViewImpl()
+    {
+        const uint32_t count = 1000000;
+        series.resize(count * 3);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            series[i * 3 + 0] = -5.0f + 10.0f * (float)i / (float)count;
+            series[i * 3 + 1] = 2.0f + sinf((float)i * 0.7f) * (0.5f + 0.5f * sinf((float)i * 0.00002f));
+            series[i * 3 + 2] = -2.0f;
+        }
+        polyline.build(series.data(), count);
+    }
+
+    void *Draw(void *deviceContext, const screenstate::ScreenState &viewState, FrameTelemetry &telemetry)
     {
         camera.WindowInput(viewState);
+        telemetry.Mark(FramePhase::Input);
 
         //
         // gizmo update
         //
         Im3d_Impl_NewFrame(&camera.state, &viewState);
+        telemetry.Mark(FramePhase::Im3dNewFrame);
+        auto &ctx = Im3d::GetContext();
+        ctx.m_gizmoTwoPhasePicking = true;
         // process gizmo, not draw, build draw list.
         Im3d::Gizmo("GizmoUnified", world.data());
+        for (int i = 0; i < (int)markers.size(); ++i)
+        {
+            Im3d::PushId(i);
+            Im3d::GizmoTranslation("Marker", markers[i].data());
+            Im3d::PopId();
+        }
+        // the series goes on its own layer so that the pick marker drawn below never hits itself
+        const Im3d::Id seriesLayer = Im3d::MakeId("Series");
+        Im3d::PushLayerId(seriesLayer);
+        Im3d::PushColor(Im3d::Color_Cyan);
+        Im3d::DrawPolyline(polyline);
+        Im3d::PopColor();
+        Im3d::PopLayerId();
+        if (hasPick)
+        {
+            Im3d::DrawPoint(pickPosition, 12.0f, Im3d::Color_Yellow);
+        }
+        telemetry.Mark(FramePhase::Im3dUser);
         Im3d::EndFrame();
+        Im3d::RayHit hit;
+        auto &appData = Im3d::GetAppData();
+        hasPick = ctx.pickRay(appData.m_cursorRayOrigin, appData.m_cursorRayDirection, hit, seriesLayer);
+        if (hasPick)
+        {
+            pickPosition = hit.m_position;
+        }
+        telemetry.Mark(FramePhase::Im3dEndFrame);
 
         //
         // render to viewport
@@ -38,8 +97,10 @@ public:
 
         // use manipulated world
         renderer.DrawTeapot(deviceContext, camera.state.viewProjection.data(), world.data());
+        telemetry.Mark(FramePhase::DrawTeapot);
         // draw gizmo
         im3dImplDx11.Draw(deviceContext, camera.state.viewProjection.data());
+        telemetry.Mark(FramePhase::DrawIm3d);
 
         return renderTarget;
     }
@@ -55,7 +116,7 @@ DX11View::~DX11View()
     delete m_impl;
 }
 
-void *DX11View::Draw(void *deviceContext, const struct screenstate::ScreenState &viewState)
+void *DX11View::Draw(void *deviceContext, const struct screenstate::ScreenState &viewState, FrameTelemetry &telemetry)
 {
-    return m_impl->Draw(deviceContext, viewState);
+    return m_impl->Draw(deviceContext, viewState, telemetry);
 }
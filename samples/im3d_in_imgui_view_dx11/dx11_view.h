@@ -1,6 +1,7 @@
 #pragma once
 
 class DX11ViewImpl;
+class FrameTelemetry;
 namespace screenstate
 {
     struct ScreenState;
@@ -12,5 +13,5 @@ class DX11View
 public:
     DX11View();
     ~DX11View();
-    void *Draw(void *deviceContext, const screenstate::ScreenState &viewState);
+    void *Draw(void *deviceContext, const screenstate::ScreenState &viewState, FrameTelemetry &telemetry);
 };
@@ -1,6 +1,9 @@
 #include <Win32Window.h>
+#include <frame_scheduler.h>
 #include "dx11_context.h"
 #include "dx11_view.h"
+#include <telemetry_window.h>
+#include <frame_telemetry.h>
 
 #include <imgui.h>
 #include <imgui_impl_win32.h>
@@ -44,9 +47,24 @@ int main(int argc, char **argv)
 
     DX11View view;
 
+    // collected only while the window is shown
+    FrameTelemetry telemetry;
+    bool show_telemetry_window = true;
+
+    // render only on input. the view's gizmo drag is driven by mouse input, so no keep alive is needed
+    screenstate::FrameScheduler scheduler;
+
     screenstate::ScreenState windowState;
     while (window.Update(&windowState))
     {
+        if (!scheduler.ShouldRender(windowState, window.FrameEvents()))
+        {
+            scheduler.Wait([&window](int64_t us) { window.WaitEvents(us); });
+            continue;
+        }
+        telemetry.SetEnabled(show_telemetry_window);
+        telemetry.BeginFrame();
+
         // Start the Dear ImGui frame
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
@@ -62,15 +80,32 @@ int main(int argc, char **argv)
             io.MouseWheel = 100;
         }
         ImGui::NewFrame();
+        telemetry.Mark(FramePhase::Input);
 
         ////////////////////////////////////////////////////////////
 
         {
+            // closed windows are reopened from here
+            if (ImGui::BeginMainMenuBar())
+            {
+                if (ImGui::BeginMenu("Windows"))
+                {
+                    ImGui::MenuItem("frame telemetry", nullptr, &show_telemetry_window);
+                    ImGui::MenuItem("imgui demo", nullptr, &show_demo_window);
+                    ImGui::EndMenu();
+                }
+                ImGui::EndMainMenuBar();
+            }
+
             // 1. Show the big demo window (Most of the sample code is in ImGui::ShowDemoWindow()! You can browse its code to learn more about Dear ImGui!).
             if (show_demo_window)
             {
                 ImGui::ShowDemoWindow(&show_demo_window);
             }
+            if (show_telemetry_window)
+            {
+                ShowTelemetryWindow(telemetry, &show_telemetry_window);
+            }
 
             ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
             if (ImGui::Begin("render target", nullptr,
@@ -82,12 +117,14 @@ int main(int argc, char **argv)
 
                 // update view camera
                 auto viewState = windowState.Crop(pos.x, pos.y + frameHeight, size.x, size.y);
-                auto renderTarget = view.Draw(deviceContext, viewState);
+                telemetry.Mark(FramePhase::ImGuiUser);
+                auto renderTarget = view.Draw(deviceContext, viewState, telemetry);
                 ImGui::ImageButton((ImTextureID)renderTarget, size, ImVec2(0.0f, 0.0f), ImVec2(1.0f, 1.0f), 0);
             }
             ImGui::End();
             ImGui::PopStyleVar();
         }
+        telemetry.Mark(FramePhase::ImGuiUser);
 
         {
             // render to backbuffer
@@ -97,12 +134,20 @@ int main(int argc, char **argv)
             // imgui Rendering
             ImGui::Render();
             ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+            telemetry.Mark(FramePhase::ImGuiRender);
 
             // transfer backbuffer
             dx11.Present();
+            telemetry.Mark(FramePhase::Present);
         }
+        telemetry.EndFrame();
+
+        scheduler.Wait([&window](int64_t us) { window.WaitEvents(us); });
     }
 
+    auto stats = scheduler.GetStats();
+    LOGI << "rendered " << stats.RenderedFrames << ", skipped " << stats.SkippedFrames;
+
     ImGui_ImplDX11_Shutdown();
 
     return 0;
@@ -0,0 +1,365 @@
+///
+/// Accuracy and speed of the im3d_simd.h kernels against the scalar code they replaced.
+///
+/// im3d_math_bench [accuracy|speed] [iterations]
+///
+/// accuracy exits with 1 if a kernel disagrees with the reference, so the suite can gate a build.
+///
+#include <im3d.h>
+#include <im3d_math.h>
+#include <im3d_simd.h>
+#include <array_math.h>
+#include <plog/Log.h>
+#include <plog/Appenders/ConsoleAppender.h>
+#include <plog/Formatters/TxtFormatter.h>
+#include <plog/Init.h>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <math.h>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace Im3d;
+
+using clock_type = std::chrono::steady_clock;
+static double Ms(clock_type::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - begin).count();
+}
+
+// the scalar code before im3d_simd.h, on column-major storage
+namespace reference
+{
+
+inline float At(const float *_m, int _row, int _col) { return _m[_col * 4 + _row]; }
+
+void Mul(const float *_lhs, const float *_rhs, float *_out_)
+{
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            _out_[c * 4 + r] = At(_lhs, r, 0) * At(_rhs, 0, c) + At(_lhs, r, 1) * At(_rhs, 1, c) + At(_lhs, r, 2) * At(_rhs, 2, c) + At(_lhs, r, 3) * At(_rhs, 3, c);
+        }
+    }
+}
+
+void Transform(const float *_m, const float *_v, float *_out_, int _count)
+{
+    for (int i = 0; i < _count; ++i, _v += 4, _out_ += 4)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            _out_[r] = At(_m, r, 0) * _v[0] + At(_m, r, 1) * _v[1] + At(_m, r, 2) * _v[2] + At(_m, r, 3) * _v[3];
+        }
+    }
+}
+
+void Transpose(const float *_m, float *_out_)
+{
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            _out_[c * 4 + r] = At(_m, c, r);
+        }
+    }
+}
+
+// Gaussian elimination with partial pivoting in double, the accuracy reference for the inverse
+bool Inverse(const float *_m, float *_out_)
+{
+    double a[4][8];
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            a[r][c] = At(_m, r, c);
+            a[r][c + 4] = r == c ? 1.0 : 0.0;
+        }
+    }
+    for (int c = 0; c < 4; ++c)
+    {
+        int pivot = c;
+        for (int r = c + 1; r < 4; ++r)
+        {
+            if (fabs(a[r][c]) > fabs(a[pivot][c]))
+            {
+                pivot = r;
+            }
+        }
+        if (a[pivot][c] == 0.0)
+        {
+            return false;
+        }
+        for (int k = 0; k < 8; ++k)
+        {
+            std::swap(a[c][k], a[pivot][k]);
+        }
+        for (int r = 0; r < 4; ++r)
+        {
+            if (r != c)
+            {
+                const double f = a[r][c] / a[c][c];
+                for (int k = 0; k < 8; ++k)
+                {
+                    a[r][k] -= f * a[c][k];
+                }
+            }
+        }
+    }
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            _out_[c * 4 + r] = (float)(a[r][c + 4] / a[r][r]);
+        }
+    }
+    return true;
+}
+
+// amth::Mult before it used the kernels: row-major, dot of a row of l with a column of r
+std::array<float, 16> AmthMult(const std::array<float, 16> &l, const std::array<float, 16> &r)
+{
+    std::array<float, 16> m;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            m[i * 4 + j] = l[i * 4] * r[j] + l[i * 4 + 1] * r[4 + j] + l[i * 4 + 2] * r[8 + j] + l[i * 4 + 3] * r[12 + j];
+        }
+    }
+    return m;
+}
+
+} // namespace reference
+
+// the scalar path is usable at compile time
+static constexpr std::array<float, 16> ConstexprProduct()
+{
+    std::array<float, 16> a{}, b{}, out{};
+    for (int i = 0; i < 16; ++i)
+    {
+        a[i] = (float)(i + 1);
+        b[i] = (float)(16 - i);
+    }
+    simd::scalar::Mul<simd::Layout::ColumnMajor>(a.data(), b.data(), out.data());
+    return out;
+}
+static_assert(ConstexprProduct()[0] == 1 * 16 + 5 * 15 + 9 * 14 + 13 * 13, "constexpr column-major product");
+
+// well conditioned affine transforms, as the gizmos and cameras produce
+static std::vector<float> CreateMatrices(int count, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+    std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+    std::uniform_real_distribution<float> offset(-100.0f, 100.0f);
+    std::vector<float> matrices(count * 16);
+    for (int i = 0; i < count; ++i)
+    {
+        Mat4 m(Vec3(offset(rng), offset(rng), offset(rng)),
+               Rotation(Normalize(Vec3(offset(rng), offset(rng), offset(rng) + 0.1f)), angle(rng)),
+               Vec3(scale(rng), scale(rng), scale(rng)));
+        memcpy(&matrices[i * 16], m.m, sizeof(m.m));
+    }
+    return matrices;
+}
+
+// largest |a - b| / max(1, |b|)
+static float MaxError(const float *_a, const float *_b, int _count)
+{
+    float error = 0.0f;
+    for (int i = 0; i < _count; ++i)
+    {
+        error = std::max(error, fabsf(_a[i] - _b[i]) / std::max(1.0f, fabsf(_b[i])));
+    }
+    return error;
+}
+
+static bool Accuracy(int iterations)
+{
+    std::mt19937 rng(1);
+    auto matrices = CreateMatrices(iterations + 1, rng);
+    std::vector<float> vectors(iterations * 4);
+    std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+    for (auto &v : vectors)
+    {
+        v = value(rng);
+    }
+
+    float mul = 0.0f, mulRow = 0.0f, transform = 0.0f, transformRow = 0.0f, transpose = 0.0f, inverse = 0.0f, amth = 0.0f;
+    for (int i = 0; i < iterations; ++i)
+    {
+        const float *a = &matrices[i * 16];
+        const float *b = &matrices[(i + 1) * 16];
+        float expected[16], actual[16], at[16], bt[16];
+
+        reference::Mul(a, b, expected);
+        simd::Mul<simd::Layout::ColumnMajor>(a, b, actual);
+        mul = std::max(mul, MaxError(actual, expected, 16));
+
+        // the same product on transposed storage must be the transposed result
+        reference::Transpose(a, at);
+        reference::Transpose(b, bt);
+        simd::Mul<simd::Layout::RowMajor>(at, bt, actual);
+        reference::Transpose(expected, at);
+        mulRow = std::max(mulRow, MaxError(actual, at, 16));
+
+        float v[4], w[4];
+        reference::Transform(a, &vectors[i * 4], v, 1);
+        simd::Transform<simd::Layout::ColumnMajor>(a, &vectors[i * 4], w, 1);
+        transform = std::max(transform, MaxError(w, v, 4));
+        reference::Transpose(a, at);
+        simd::Transform<simd::Layout::RowMajor>(at, &vectors[i * 4], w, 1);
+        transformRow = std::max(transformRow, MaxError(w, v, 4));
+
+        reference::Transpose(a, expected);
+        simd::Transpose(a, actual);
+        transpose = std::max(transpose, MaxError(actual, expected, 16));
+
+        if (reference::Inverse(a, expected) && simd::Inverse(a, actual))
+        {
+            inverse = std::max(inverse, MaxError(actual, expected, 16));
+        }
+
+        std::array<float, 16> l, r;
+        memcpy(l.data(), a, sizeof(float) * 16);
+        memcpy(r.data(), b, sizeof(float) * 16);
+        auto m0 = reference::AmthMult(l, r);
+        auto m1 = amth::Mult(l, r);
+        amth = std::max(amth, MaxError(m1.data(), m0.data(), 16));
+    }
+
+    // products reorder nothing but the final sums, the inverse is a different algorithm
+    const float productTolerance = 1e-5f;
+    const float inverseTolerance = 1e-4f;
+    struct
+    {
+        const char *name;
+        float error;
+        float tolerance;
+    } results[] = {
+        {"Mul column-major", mul, productTolerance},
+        {"Mul row-major", mulRow, productTolerance},
+        {"Transform column-major", transform, productTolerance},
+        {"Transform row-major", transformRow, productTolerance},
+        {"Transpose", transpose, 0.0f},
+        {"Inverse", inverse, inverseTolerance},
+        {"amth::Mult", amth, productTolerance},
+    };
+
+    bool ok = true;
+    for (auto &result : results)
+    {
+        const bool pass = result.error <= result.tolerance;
+        if (pass)
+        {
+            LOGI << result.name << ": max relative error " << result.error;
+        }
+        else
+        {
+            LOGE << result.name << ": max relative error " << result.error << " > " << result.tolerance;
+        }
+        ok &= pass;
+    }
+    return ok;
+}
+
+static bool Speed(int iterations)
+{
+    std::mt19937 rng(2);
+    const int count = 1024;
+    auto matrices = CreateMatrices(count, rng);
+    std::vector<float> vectors(count * 4, 1.0f);
+    std::vector<float> out(count * 16);
+    float sink = 0.0f;
+
+    auto run = [&](const char *name, const std::function<void()> &before, const std::function<void()> &after) {
+        auto begin = clock_type::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            before();
+        }
+        const double beforeMs = Ms(begin);
+        begin = clock_type::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            after();
+        }
+        const double afterMs = Ms(begin);
+        sink += out[0];
+        LOGI << name << ": " << beforeMs * 1e6 / ((double)iterations * count) << " -> " << afterMs * 1e6 / ((double)iterations * count) << " ns";
+    };
+
+    run("Mul", [&]() {
+            for (int i = 0; i + 1 < count; ++i)
+                reference::Mul(&matrices[i * 16], &matrices[(i + 1) * 16], &out[i * 16]);
+        },
+        [&]() {
+            for (int i = 0; i + 1 < count; ++i)
+                simd::Mul<simd::Layout::ColumnMajor>(&matrices[i * 16], &matrices[(i + 1) * 16], &out[i * 16]);
+        });
+    run("Transform (per vector)", [&]() { reference::Transform(&matrices[0], vectors.data(), out.data(), count); },
+        [&]() { simd::Transform<simd::Layout::ColumnMajor>(&matrices[0], vectors.data(), out.data(), count); });
+    run("Transpose", [&]() {
+            for (int i = 0; i < count; ++i)
+                reference::Transpose(&matrices[i * 16], &out[i * 16]);
+        },
+        [&]() {
+            for (int i = 0; i < count; ++i)
+                simd::Transpose(&matrices[i * 16], &out[i * 16]);
+        });
+    run("Inverse (scalar cofactors -> dispatch)", [&]() {
+            for (int i = 0; i < count; ++i)
+                simd::scalar::Inverse(&matrices[i * 16], &out[i * 16]);
+        },
+        [&]() {
+            for (int i = 0; i < count; ++i)
+                simd::Inverse(&matrices[i * 16], &out[i * 16]);
+        });
+
+    LOGI << "IM3D_SIMD " << IM3D_SIMD << " (" << sink << ")";
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    static plog::ConsoleAppender<plog::TxtFormatter> consoleAppender;
+    plog::init(plog::info, &consoleAppender);
+
+    const struct
+    {
+        const char *name;
+        std::function<bool(int)> run;
+        int iterations;
+    } suites[] = {
+        {"accuracy", Accuracy, 100000},
+        {"speed", Speed, 2000},
+    };
+
+    const char *name = argc > 1 ? argv[1] : nullptr;
+    const int iterations = argc > 2 ? atoi(argv[2]) : 0;
+
+    bool found = false;
+    bool ok = true;
+    for (auto &suite : suites)
+    {
+        if (!name || strcmp(name, suite.name) == 0)
+        {
+            LOGI << "== " << suite.name;
+            ok &= suite.run(iterations > 0 ? iterations : suite.iterations);
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        LOGE << "usage: im3d_math_bench [accuracy|speed] [iterations]";
+        return 1;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -4,7 +4,10 @@
 #include "orbit_camera.h"
 #include "im3d_impl.h"
 #include "im3d_impl_dx11.h"
+#include "input_trace.h"
+#include "frame_scheduler.h"
 #include <im3d.h>
+#include <im3d_context.h>
 #include <plog/Log.h>
 #include <plog/Appenders/DebugOutputAppender.h>
 #include <plog/Formatters/TxtFormatter.h>
@@ -36,12 +39,29 @@ int main(int argc, char **argv)
     auto world = amth::IdentityMatrix();
     OrbitCamera camera;
 
+    // optional: record the input for im3d_trace_replay
+    screenstate::InputTraceWriter trace;
+    if (argc > 1 && !trace.Open(argv[1]))
+    {
+        LOGE << "fail to open " << argv[1];
+    }
+
+    // render only on input or gizmo drag
+    screenstate::FrameScheduler scheduler;
+
     // window state and mouse input
     screenstate::ScreenState state;
     while (window.Update(&state))
     {
+        trace.Write(state);
+        if (!scheduler.ShouldRender(state, window.FrameEvents()))
+        {
+            scheduler.Wait([&window](int64_t us) { window.WaitEvents(us); });
+            continue;
+        }
+
         // camera update
-        camera.WindowInput(state);
+        camera.WindowInput(state, window.FrameEvents());
 
         //
         // gizmo update
@@ -62,7 +82,12 @@ int main(int argc, char **argv)
         im3dImplDx11.Draw(deviceContext, camera.state.viewProjection.data());
         // transfer backbuffer
         dx11.Present();
+
+        scheduler.SetAnimating(Im3d::GetActiveId() != Im3d::Id_Invalid);
+        scheduler.Wait([&window](int64_t us) { window.WaitEvents(us); });
     }
 
+    auto stats = scheduler.GetStats();
+    LOGI << "rendered " << stats.RenderedFrames << ", skipped " << stats.SkippedFrames;
     return 0;
 }
@@ -28,6 +28,7 @@ int main(int argc, char **argv)
 
     GL3Renderer renderer("#version 300 es");
     Im3dImplGL3 im3dImplES3("#version 300 es");
+    im3dImplES3.SetCpuExpansion(true); // avoid the uniform buffer size limit of low end drivers
 
     auto world = amth::IdentityMatrix();
     OrbitCamera camera;
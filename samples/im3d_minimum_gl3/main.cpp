@@ -4,11 +4,17 @@
 #include "orbit_camera.h"
 #include "im3d_impl.h"
 #include "im3d_impl_gl3.h"
+#include "im3d_shm.h"
+#include "frame_scheduler.h"
+#include "mesh_file.h"
 #include <im3d.h>
+#include <im3d_context.h>
 #include <plog/Log.h>
 #include <plog/Appenders/DebugOutputAppender.h>
 #include <plog/Formatters/TxtFormatter.h>
 #include <plog/Init.h>
+#include <chrono>
+#include <string>
 
 int main(int argc, char **argv)
 {
@@ -24,7 +30,8 @@ int main(int argc, char **argv)
     window.Show();
 
     WGLContext wgl;
-    if (!wgl.Create(hwnd, 3, 0))
+    // 3.3 for the instanced mesh path (glVertexAttribDivisor), GL3Renderer falls back to one draw per mesh below that
+    if (!wgl.Create(hwnd, 3, 3))
     {
         return 2;
     }
@@ -36,25 +43,92 @@ int main(int argc, char **argv)
 
     OrbitCamera camera;
 
+    // im3d_minimum_gl3 [shm_name] [--mesh path.mesh]
+    const char *shmName = nullptr;
+    const char *meshPath = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--mesh" && i + 1 < argc)
+        {
+            meshPath = argv[++i];
+        }
+        else
+        {
+            shmName = argv[i];
+        }
+    }
+
+    // optional: draw vertex data published by another process, e.g. im3d_shm_producer
+    Im3dShmConsumer shm;
+    if (shmName)
+    {
+        shm.Open(shmName);
+    }
+
+    // optional: draw a mesh converted by mesh_convert instead of the teapot. uploaded straight from the mapping
+    uint32_t mesh = ~0u;
+    if (meshPath)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        MappedMeshFile file;
+        if (file.Open(meshPath) && file.IsPositionNormalUInt32())
+        {
+            mesh = renderer.RegisterMesh((const float *)file.Vertices(), file.VertexCount(), (const uint32_t *)file.Indices(),
+                                         file.IndexCount());
+            auto ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            LOGI << meshPath << ": " << file.VertexCount() << " vertices, loaded in " << ms << " ms";
+        }
+        else
+        {
+            LOGE << "fail to load " << meshPath;
+        }
+    }
+
+    // render only on input, gizmo drag or shared memory updates
+    screenstate::FrameScheduler scheduler;
+
     screenstate::ScreenState state;
     while (window.Update(&state))
     {
+        if (!scheduler.ShouldRender(state, window.FrameEvents()))
+        {
+            scheduler.Wait([&window](int64_t us) { window.WaitEvents(us); });
+            continue;
+        }
+
         // camera update
-        camera.WindowInput(state);
+        camera.WindowInput(state, window.FrameEvents());
 
         Im3d_Impl_NewFrame(&camera.state, &state);
         // process gizmo, not draw, build draw list.
         Im3d::Gizmo("GizmoUnified", world.data());
+        if (shm.IsOpen())
+        {
+            shm.Merge(Im3d::GetContext());
+        }
         Im3d::EndFrame();
 
         // render
         renderer.NewFrame(state.Width, state.Height);              // setViewPort & clear background
-        renderer.DrawTeapot(camera.state.viewProjection.data(), world.data()); // use manipulated world
+        if (mesh != ~0u)
+        {
+            GL3MeshInstances instances{mesh, world.data(), 1};
+            renderer.DrawMeshes(camera.state.viewProjection.data(), &instances, 1);
+        }
+        else
+        {
+            renderer.DrawTeapot(camera.state.viewProjection.data(), world.data()); // use manipulated world
+        }
         im3dImplGL3.Draw(camera.state.viewProjection.data());
 
         // transfer backbuffer
         wgl.Present();
+
+        scheduler.SetAnimating(shm.IsOpen() || Im3d::GetActiveId() != Im3d::Id_Invalid);
+        scheduler.Wait([&window](int64_t us) { window.WaitEvents(us); });
     }
 
+    auto stats = scheduler.GetStats();
+    LOGI << "rendered " << stats.RenderedFrames << ", skipped " << stats.SkippedFrames;
     return 0;
 }
@@ -0,0 +1,58 @@
+///
+/// Headless producer, publishes animated Im3d primitives through shared memory.
+/// Run a viewer with the same ring name, e.g. `im3d_minimum_gl3 im3d_debug`.
+///
+#include "im3d_shm.h"
+#include <im3d.h>
+#include <im3d_context.h>
+#include <im3d_math.h>
+#include <plog/Log.h>
+#include <plog/Appenders/ConsoleAppender.h>
+#include <plog/Formatters/TxtFormatter.h>
+#include <plog/Init.h>
+#include <chrono>
+#include <thread>
+
+int main(int argc, char **argv)
+{
+    static plog::ConsoleAppender<plog::TxtFormatter> consoleAppender;
+    plog::init(plog::verbose, &consoleAppender);
+
+    std::string name = argc > 1 ? argv[1] : "im3d_debug";
+    Im3dShmProducer producer;
+    if (!producer.Create(name))
+    {
+        return 1;
+    }
+    LOGI << "publishing to " << name;
+
+    auto &ad = Im3d::GetAppData();
+    ad.m_deltaTime = 1.0f / 60.0f;
+    ad.m_viewportSize = Im3d::Vec2(640.0f, 480.0f);
+    ad.m_worldUp = Im3d::Vec3(0.0f, 1.0f, 0.0f);
+    ad.m_viewDirection = Im3d::Vec3(0.0f, 0.0f, -1.0f);
+
+    float time = 0.0f;
+    for (uint32_t frame = 0;; ++frame)
+    {
+        time += ad.m_deltaTime;
+
+        Im3d::NewFrame();
+        Im3d::PushColor(Im3d::Color_Yellow);
+        Im3d::DrawCircle(Im3d::Vec3(0.0f), Im3d::Vec3(0.0f, 1.0f, 0.0f), 2.0f + sinf(time), 64);
+        Im3d::PopColor();
+        Im3d::DrawPoint(Im3d::Vec3(2.0f * cosf(time), 1.0f, 2.0f * sinf(time)), 16.0f, Im3d::Color_Magenta);
+        Im3d::EndFrame();
+
+        producer.WriteDrawLists();
+        if (!producer.Publish() && frame % 60 == 0)
+        {
+            auto stats = producer.GetStats();
+            LOGW << "viewer is behind, dropped " << stats.DroppedFrames << "/" << stats.PublishedFrames + stats.DroppedFrames;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+
+    return 0;
+}
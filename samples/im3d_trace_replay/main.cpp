@@ -0,0 +1,161 @@
+///
+/// Headless replay of an input trace recorded by a sample, e.g. `im3d_minimum_dx11 orbit.trace`.
+/// Runs the per frame CPU work of the samples (camera, Im3d frame, gizmo, vertex expansion) without a window and reports
+/// frame time statistics per phase, for A/B comparisons.
+///
+/// im3d_trace_replay <trace> [fixed|unpaced|original] [repeat]
+///
+#include "input_trace.h"
+#include "orbit_camera.h"
+#include "im3d_impl.h"
+#include <im3d.h>
+#include <im3d_context.h>
+#include <im3d_expand.h>
+#include <plog/Log.h>
+#include <plog/Appenders/ConsoleAppender.h>
+#include <plog/Formatters/TxtFormatter.h>
+#include <plog/Init.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum Phase
+{
+    Phase_Camera,
+    Phase_NewFrame,
+    Phase_Gizmo,
+    Phase_EndFrame,
+    Phase_Expand,
+    Phase_Frame,
+    Phase_Count,
+};
+static const char *PhaseNames[Phase_Count] = {"camera", "newframe", "gizmo", "endframe", "expand", "frame"};
+
+struct PhaseTimer
+{
+    using clock = std::chrono::steady_clock;
+    std::vector<float> Samples[Phase_Count]; // microseconds
+    clock::time_point m_begin;
+
+    void Begin()
+    {
+        m_begin = clock::now();
+    }
+
+    void End(Phase phase)
+    {
+        auto now = clock::now();
+        Samples[phase].push_back(std::chrono::duration<float, std::micro>(now - m_begin).count());
+        m_begin = now;
+    }
+
+    void Report()
+    {
+        LOGI << "phase        min     mean      p50      p95      p99      max (us)";
+        for (int i = 0; i < Phase_Count; ++i)
+        {
+            auto &s = Samples[i];
+            if (s.empty())
+            {
+                continue;
+            }
+            std::sort(s.begin(), s.end());
+            double sum = 0;
+            for (auto x : s)
+            {
+                sum += x;
+            }
+            auto percentile = [&s](float p) { return s[std::min(s.size() - 1, (size_t)(p * s.size()))]; };
+            char line[256];
+            snprintf(line, sizeof(line), "%-8s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f", PhaseNames[i], s.front(), sum / s.size(),
+                     percentile(0.5f), percentile(0.95f), percentile(0.99f), s.back());
+            LOGI << line;
+        }
+    }
+};
+
+int main(int argc, char **argv)
+{
+    static plog::ConsoleAppender<plog::TxtFormatter> consoleAppender;
+    plog::init(plog::info, &consoleAppender);
+
+    if (argc < 2)
+    {
+        LOGE << "usage: im3d_trace_replay <trace> [fixed|unpaced|original] [repeat]";
+        return 1;
+    }
+
+    screenstate::InputTraceReader trace;
+    if (!trace.Open(argv[1]))
+    {
+        LOGE << "fail to open " << argv[1];
+        return 2;
+    }
+    std::string pacing = argc > 2 ? argv[2] : "fixed";
+    if (pacing == "original")
+    {
+        trace.SetPacing(screenstate::InputTracePacing::Original);
+    }
+    else if (pacing == "unpaced")
+    {
+        trace.SetPacing(screenstate::InputTracePacing::Unpaced);
+    }
+    else
+    {
+        trace.SetPacing(screenstate::InputTracePacing::Fixed);
+    }
+    int repeat = argc > 3 ? std::max(1, atoi(argv[3])) : 1;
+    LOGI << argv[1] << ": " << trace.FrameCount() << " frames, " << pacing << " pacing, x" << repeat;
+
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Im3d::ExpandedVertex> expanded;
+    PhaseTimer timer;
+    std::unique_ptr<Im3d::Context> context;
+    for (int r = 0; r < repeat; ++r)
+    {
+        // every run starts from the same state, Im3d's included (active/hot ids, gizmo drag, timed primitives)
+        trace.Rewind();
+        OrbitCamera camera;
+        auto world = amth::IdentityMatrix();
+        context = std::make_unique<Im3d::Context>();
+        Im3d::SetContext(*context);
+
+        screenstate::ScreenState state;
+        while (trace.Next(&state))
+        {
+            auto frameBegin = PhaseTimer::clock::now();
+            timer.Begin();
+
+            camera.WindowInput(state);
+            timer.End(Phase_Camera);
+
+            Im3d_Impl_NewFrame(&camera.state, &state);
+            timer.End(Phase_NewFrame);
+
+            Im3d::Gizmo("GizmoUnified", world.data());
+            timer.End(Phase_Gizmo);
+
+            Im3d::EndFrame();
+            timer.End(Phase_EndFrame);
+
+            // what a CPU expanding backend uploads, see Im3dImplGL3::SetCpuExpansion
+            auto drawLists = Im3d::GetDrawLists();
+            auto drawListCount = Im3d::GetDrawListCount();
+            auto &ad = Im3d::GetAppData();
+            expanded.resize(Im3d::GetExpandedVertexCount(drawLists, drawListCount));
+            // row vectors (amth) read as column-major, as passed to glUniformMatrix4fv
+            Im3d::ExpandDrawLists(drawLists, drawListCount, camera.state.viewProjection.data(), ad.m_viewportSize, expanded.data(),
+                                  threadCount);
+            timer.End(Phase_Expand);
+
+            timer.Samples[Phase_Frame].push_back(
+                std::chrono::duration<float, std::micro>(PhaseTimer::clock::now() - frameBegin).count());
+        }
+    }
+    timer.Report();
+
+    return 0;
+}
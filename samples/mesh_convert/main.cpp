@@ -0,0 +1,293 @@
+///
+/// Convert a Wavefront OBJ to the memory-mapped mesh format (mesh_file.h) and benchmark loading it.
+///
+/// mesh_convert <input.obj> <output.mesh>
+///
+#include "mesh_file.h"
+#include <plog/Log.h>
+#include <plog/Appenders/ConsoleAppender.h>
+#include <plog/Formatters/TxtFormatter.h>
+#include <plog/Init.h>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using clock_type = std::chrono::steady_clock;
+static double Ms(clock_type::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - begin).count();
+}
+
+struct ObjMesh
+{
+    std::vector<float> Vertices; // position + normal
+    std::vector<uint32_t> Indices;
+};
+
+// resolve a 1 based or negative (relative) obj index
+static int ObjIndex(long index, size_t count)
+{
+    return index < 0 ? (int)(count + index) : (int)(index - 1);
+}
+
+static void CalcFaceNormal(const float *a, const float *b, const float *c, float *n)
+{
+    float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    n[0] = u[1] * v[2] - u[2] * v[1];
+    n[1] = u[2] * v[0] - u[0] * v[2];
+    n[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+// positions, normals and triangulated (fan) faces. vertices without a normal get the area weighted face normals.
+static bool LoadObj(const char *path, ObjMesh *mesh)
+{
+    std::ifstream io(path);
+    if (!io)
+    {
+        return false;
+    }
+
+    std::vector<std::array<float, 3>> positions;
+    std::vector<std::array<float, 3>> normals;
+    // (position, normal) -> output vertex
+    std::unordered_map<uint64_t, uint32_t> vertexMap;
+    std::vector<bool> needsNormal;
+
+    std::string line;
+    std::vector<uint32_t> face;
+    while (std::getline(io, line))
+    {
+        auto p = line.c_str();
+        if (p[0] == 'v' && p[1] == ' ')
+        {
+            std::array<float, 3> v;
+            char *end = (char *)p + 2;
+            for (auto &x : v)
+            {
+                x = strtof(end, &end);
+            }
+            positions.push_back(v);
+        }
+        else if (p[0] == 'v' && p[1] == 'n' && p[2] == ' ')
+        {
+            std::array<float, 3> v;
+            char *end = (char *)p + 3;
+            for (auto &x : v)
+            {
+                x = strtof(end, &end);
+            }
+            normals.push_back(v);
+        }
+        else if (p[0] == 'f' && p[1] == ' ')
+        {
+            face.clear();
+            char *end = (char *)p + 2;
+            while (true)
+            {
+                // v, v/vt, v//vn, v/vt/vn
+                char *next;
+                auto vi = strtol(end, &next, 10);
+                if (next == end)
+                {
+                    break;
+                }
+                end = next;
+                long ni = 0;
+                if (*end == '/')
+                {
+                    ++end;
+                    strtol(end, &next, 10); // texcoord, unused
+                    end = next;
+                    if (*end == '/')
+                    {
+                        ++end;
+                        ni = strtol(end, &next, 10);
+                        end = next;
+                    }
+                }
+                auto pos = ObjIndex(vi, positions.size());
+                auto nrm = ni ? ObjIndex(ni, normals.size()) : -1;
+                if (pos < 0 || pos >= (int)positions.size() || nrm >= (int)normals.size())
+                {
+                    LOGE << "invalid face: " << line;
+                    return false;
+                }
+                auto key = ((uint64_t)(uint32_t)pos << 32) | (uint32_t)nrm;
+                auto found = vertexMap.find(key);
+                if (found == vertexMap.end())
+                {
+                    auto index = (uint32_t)(mesh->Vertices.size() / 6);
+                    auto &v = positions[pos];
+                    mesh->Vertices.insert(mesh->Vertices.end(), v.begin(), v.end());
+                    if (nrm >= 0)
+                    {
+                        auto &n = normals[nrm];
+                        mesh->Vertices.insert(mesh->Vertices.end(), n.begin(), n.end());
+                    }
+                    else
+                    {
+                        mesh->Vertices.insert(mesh->Vertices.end(), {0.0f, 0.0f, 0.0f});
+                    }
+                    needsNormal.push_back(nrm < 0);
+                    found = vertexMap.emplace(key, index).first;
+                }
+                face.push_back(found->second);
+            }
+            for (size_t i = 2; i < face.size(); ++i)
+            {
+                mesh->Indices.insert(mesh->Indices.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+    }
+
+    // accumulate face normals into the vertices that had none
+    auto &vertices = mesh->Vertices;
+    for (size_t i = 0; i + 2 < mesh->Indices.size(); i += 3)
+    {
+        auto a = &vertices[mesh->Indices[i] * 6];
+        auto b = &vertices[mesh->Indices[i + 1] * 6];
+        auto c = &vertices[mesh->Indices[i + 2] * 6];
+        float n[3];
+        CalcFaceNormal(a, b, c, n);
+        for (auto v : {mesh->Indices[i], mesh->Indices[i + 1], mesh->Indices[i + 2]})
+        {
+            if (needsNormal[v])
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    vertices[v * 6 + 3 + k] += n[k];
+                }
+            }
+        }
+    }
+    for (size_t v = 0; v < needsNormal.size(); ++v)
+    {
+        if (needsNormal[v])
+        {
+            auto n = &vertices[v * 6 + 3];
+            auto len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (len > 0)
+            {
+                n[0] /= len;
+                n[1] /= len;
+                n[2] /= len;
+            }
+        }
+    }
+    return true;
+}
+
+// drop the file from the OS page cache so the next read comes from disk, as on a first launch
+static bool EvictFromCache(const char *path)
+{
+#ifdef _WIN32
+    // opening without buffering flushes and purges the cached pages of the file
+    auto file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING,
+                            nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    CloseHandle(file);
+    return true;
+#else
+    auto fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+    // dirty pages are not evicted, write them back first
+    fdatasync(fd);
+    auto ret = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    return ret == 0;
+#endif
+}
+
+// stands in for glBufferData/CreateBuffer: the driver copies the data into its own allocation
+struct UploadBuffers
+{
+    std::vector<uint8_t> Vertices;
+    std::vector<uint8_t> Indices;
+
+    void Upload(const void *vertices, uint64_t vertexBytes, const void *indices, uint64_t indexBytes)
+    {
+        Vertices.assign((const uint8_t *)vertices, (const uint8_t *)vertices + vertexBytes);
+        Indices.assign((const uint8_t *)indices, (const uint8_t *)indices + indexBytes);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    static plog::ConsoleAppender<plog::TxtFormatter> consoleAppender;
+    plog::init(plog::info, &consoleAppender);
+
+    if (argc < 3)
+    {
+        LOGE << "usage: mesh_convert <input.obj> <output.mesh>";
+        return 1;
+    }
+
+    // both loaders are timed from a cold page cache up to the buffer creation, the cost a renderer pays at startup
+    bool cold = EvictFromCache(argv[1]);
+    auto begin = clock_type::now();
+    ObjMesh obj;
+    if (!LoadObj(argv[1], &obj))
+    {
+        LOGE << "fail to load " << argv[1];
+        return 2;
+    }
+    auto parseMs = Ms(begin);
+    UploadBuffers objBuffers;
+    objBuffers.Upload(obj.Vertices.data(), obj.Vertices.size() * sizeof(float), obj.Indices.data(),
+                      obj.Indices.size() * sizeof(uint32_t));
+    auto objMs = Ms(begin);
+    auto vertexCount = (uint32_t)(obj.Vertices.size() / 6);
+    LOGI << argv[1] << ": " << vertexCount << " vertices, " << obj.Indices.size() / 3 << " triangles, parsed in " << parseMs
+         << " ms, parse + upload " << objMs << " ms";
+
+    begin = clock_type::now();
+    if (!WriteMeshFile(argv[2], obj.Vertices.data(), vertexCount, obj.Indices.data(), (uint32_t)obj.Indices.size()))
+    {
+        LOGE << "fail to write " << argv[2];
+        return 3;
+    }
+    LOGI << argv[2] << ": written in " << Ms(begin) << " ms";
+
+    // the file was just written, it is in the page cache unless evicted
+    cold = EvictFromCache(argv[2]) && cold;
+    if (!cold)
+    {
+        LOGW << "fail to evict the files from the page cache, timings are warm";
+    }
+    begin = clock_type::now();
+    MappedMeshFile mesh;
+    if (!mesh.Open(argv[2]))
+    {
+        LOGE << "fail to map " << argv[2];
+        return 4;
+    }
+    auto mapMs = Ms(begin);
+    auto &header = mesh.Header();
+    UploadBuffers meshBuffers;
+    meshBuffers.Upload(mesh.Vertices(), (uint64_t)header.VertexStride * header.VertexCount, mesh.Indices(),
+                       (uint64_t)header.IndexSize * header.IndexCount);
+    auto meshMs = Ms(begin);
+    LOGI << "mmap: open + validate " << mapMs << " ms, open + upload " << meshMs << " ms";
+    LOGI << "obj / mmap (" << (cold ? "cold" : "warm") << " cache, including upload): " << objMs / (meshMs > 0 ? meshMs : 1e-3)
+         << "x";
+
+    return 0;
+}
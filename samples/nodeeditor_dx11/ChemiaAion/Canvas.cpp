@@ -1,7 +1,8 @@
 #include "Canvas.h"
 #include "Node.h"
 #include "Connection.h"
-#include "Bezier.h"
+#include "../nodegraph/bezier_cache.h"
+#include <algorithm>
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui_internal.h>
 
@@ -18,6 +19,13 @@ ImVec2 Canvas::NewNodePosition() const
     return (canvas_mouse_ - canvas_scroll_) / canvas_scale_;
 }
 
+ImRect Canvas::GetVisibleRect(float margin) const
+{
+    ImVec2 min = (ImVec2(-margin, -margin) - canvas_scroll_) / canvas_scale_;
+    ImVec2 max = (canvas_size_ + ImVec2(margin, margin) - canvas_scroll_) / canvas_scale_;
+    return ImRect(min, max);
+}
+
 ImVec2 Canvas::Update()
 {
     if (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows))
@@ -97,43 +105,60 @@ void Canvas::UpdateScroll()
     }
 }
 
-float Canvas::RenderLines(ImDrawList *draw_list, ImVec2 offset,
-                          const std::unique_ptr<Node> &node,
-                          const std::unique_ptr<Connection> &connection,
+float Canvas::RenderLines(ImDrawList *draw_list, ImVec2 offset, const ImRect &visible,
+                          const Node &from_node, const Connection &output,
+                          const Node &to_node, const Connection &input,
+                          nodegraph::BezierCache &curve,
                           bool selected)
 {
-    ImVec2 p1 = offset;
-    if (connection->target_->state_ > 0)
+    ImVec2 from;
+    if (from_node.state_ > 0)
     { // we are connected to output of not a collapsed node
-        p1 += ((connection->target_->position_ + connection->input_->position_) * canvas_scale_);
+        from = from_node.position_ + output.position_;
     }
     else
     { // we are connected to output of a collapsed node
-        p1 += ((connection->target_->position_ + ImVec2(connection->target_->size_.x, connection->target_->size_.y / 2.0f)) * canvas_scale_);
+        from = from_node.position_ + ImVec2(from_node.size_.x, from_node.size_.y / 2.0f);
     }
 
-    ImVec2 p4 = offset;
-    if (node->state_ > 0)
+    ImVec2 to;
+    if (to_node.state_ > 0)
     { // we are not a collapsed node
-        p4 += ((node->position_ + connection->position_) * canvas_scale_);
+        to = to_node.position_ + input.position_;
     }
     else
     { // we are a collapsed node
-        p4 += ((node->position_ + ImVec2(0.0f, node->size_.y / 2.0f)) * canvas_scale_);
+        to = to_node.position_ + ImVec2(0.0f, to_node.size_.y / 2.0f);
+    }
+
+    // the control points are 50 canvas units out, so the curve does not change with zoom or scroll
+    curve.Update(from, to, 50.0f);
+
+    if (!curve.Overlaps(visible.Min, visible.Max))
+    {
+        return FLT_MAX;
     }
 
-    // default bezier control points
-    ImVec2 p2 = p1 + (ImVec2(+50.0f, 0.0f) * canvas_scale_);
-    ImVec2 p3 = p4 + (ImVec2(-50.0f, 0.0f) * canvas_scale_);
+    // zoomed out links draw every 3rd or 6th cached sample, the hover test still uses all of them
+    static_assert(nodegraph::BezierCache::Segments % 6 == 0, "decimated polylines must end on the last sample");
+    const NodeDetail detail = std::max(to_node.GetDetail(canvas_scale_), from_node.GetDetail(canvas_scale_));
+    const int stride = detail == NodeDetail_Full ? 1 : (detail == NodeDetail_Ports ? 3 : 6);
+
+    ImVec2 points[nodegraph::BezierCache::Segments + 1];
+    int count = 0;
+    for (int i = 0; i <= nodegraph::BezierCache::Segments; i += stride)
+    {
+        points[count++] = offset + (curve.GetPoint(i) * canvas_scale_);
+    }
 
-    draw_list->AddBezierCurve(p1, p2, p3, p4, ImColor(0.5f, 0.5f, 0.5f, 1.0f), 2.0f * canvas_scale_);
+    draw_list->AddPolyline(points, count, ImColor(0.5f, 0.5f, 0.5f, 1.0f), false, 2.0f * canvas_scale_);
 
     if (selected)
     {
-        draw_list->AddBezierCurve(p1, p2, p3, p4, ImColor(1.0f, 1.0f, 1.0f, 0.25f), 4.0f * canvas_scale_);
+        draw_list->AddPolyline(points, count, ImColor(1.0f, 1.0f, 1.0f, 0.25f), false, 4.0f * canvas_scale_);
     }
 
-    return GetSquaredDistanceToBezierCurve(ImGui::GetIO().MousePos, p1, p2, p3, p4);
+    return curve.GetSquaredScreenDistance(ImGui::GetIO().MousePos, offset, canvas_scale_, 10.0f);
 }
 
 } // namespace ChemiaAion
\ No newline at end of file
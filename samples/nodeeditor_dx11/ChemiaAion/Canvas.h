@@ -2,6 +2,12 @@
 #include <imgui.h>
 #include <memory>
 
+struct ImRect;
+namespace nodegraph
+{
+class BezierCache;
+}
+
 namespace ChemiaAion
 {
 
@@ -18,6 +24,8 @@ struct Canvas
 
     ImVec2 GetOffset() const;
     ImVec2 NewNodePosition() const;
+    // canvas space rect on screen, with margin screen pixels around it
+    ImRect GetVisibleRect(float margin) const;
 
     ImVec2 Update();
 
@@ -26,9 +34,13 @@ private:
     void UpdateScroll();
 
 public:
-    float RenderLines(ImDrawList *draw_list, ImVec2 offset,
-                      const std::unique_ptr<Node> &node,
-                      const std::unique_ptr<Connection> &connection,
+    // link from output of from_node into input of to_node, curve is the link's cache.
+    // returns the squared mouse distance to the curve, FLT_MAX if it is off screen and was not drawn
+    // or further than 10 pixels
+    float RenderLines(ImDrawList *draw_list, ImVec2 offset, const ImRect &visible,
+                      const Node &from_node, const Connection &output,
+                      const Node &to_node, const Connection &input,
+                      nodegraph::BezierCache &curve,
                       bool selected);
 };
 
@@ -1,10 +1,14 @@
 #pragma once
+#include "../nodegraph/bezier_cache.h"
+#include "../nodegraph/node_pool.h"
 #include <imgui.h>
 #include <string>
 
 namespace ChemiaAion
 {
 
+using nodegraph::BezierCache;
+
 enum NodeStateFlag : int32_t
 {
     NodeStateFlag_Default = 1,
@@ -24,19 +28,18 @@ struct Connection
     ImVec2 position_;
     std::string name_;
     ConnectionType type_;
+    uint32_t index_; // in the node's inputs_ or outputs_
 
-    Node *target_;
-    Connection *input_;
-    uint32_t connections_;
+    nodegraph::EdgeHandle edge_; // inputs only: the link into this input, null while unconnected
+    uint32_t connections_;       // links at this connector
 
     Connection()
     {
         position_ = ImVec2(0.0f, 0.0f);
 
         type_ = ConnectionType_None;
+        index_ = 0;
 
-        target_ = nullptr;
-        input_ = nullptr;
         connections_ = 0;
     }
 
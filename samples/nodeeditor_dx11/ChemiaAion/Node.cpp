@@ -32,6 +32,7 @@ std::unique_ptr<Node> Node::Create(ImVec2 pos, const NodeType &type, int32_t id)
                 auto connection = std::make_unique<Connection>();
                 connection->name_ = element.first;
                 connection->type_ = element.second;
+                connection->index_ = (uint32_t)inputs.size();
 
                 inputs.push_back(std::move(connection));
             });
@@ -44,6 +45,7 @@ std::unique_ptr<Node> Node::Create(ImVec2 pos, const NodeType &type, int32_t id)
                 auto connection = std::make_unique<Connection>();
                 connection->name_ = element.first;
                 connection->type_ = element.second;
+                connection->index_ = (uint32_t)outputs.size();
 
                 outputs.push_back(std::move(connection));
             });
@@ -111,9 +113,48 @@ std::unique_ptr<Node> Node::Create(ImVec2 pos, const NodeType &type, int32_t id)
     return node;
 }
 
-void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, NodesElement &element_)
+void Connect(NodeGraph &graph_, Node &from, Connection &output, Node &to, Connection &input)
 {
-    ImGui::PushID(abs(id_));
+    Disconnect(graph_, input);
+
+    input.edge_ = graph_.Connect(from.handle_, output.index_, to.handle_, input.index_);
+    input.connections_ = 1;
+    output.connections_++;
+}
+
+void Disconnect(NodeGraph &graph_, Connection &input)
+{
+    if (auto edge = graph_.Get(input.edge_))
+    {
+        (*graph_.Get(edge->From))->outputs_[edge->Output]->connections_--;
+        graph_.Disconnect(input.edge_);
+    }
+
+    input.edge_ = nodegraph::EdgeHandle();
+    input.connections_ = 0;
+}
+
+NodeDetail Node::GetDetail(float canvas_scale_) const
+{
+    // collapsed_height is two title lines
+    const float text_height = (collapsed_height / 2.0f) * canvas_scale_;
+
+    if (text_height >= 8.0f)
+    {
+        return NodeDetail_Full;
+    }
+
+    if (text_height >= 5.0f)
+    {
+        return NodeDetail_Ports;
+    }
+
+    return NodeDetail_Rect;
+}
+
+void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, NodesElement &element_, NodeGraph &graph_)
+{
+    ImGui::PushID(id_);
     ImGui::BeginGroup();
 
     ImVec2 node_rect_min = offset + (position_ * canvas_scale_);
@@ -135,7 +176,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
 
             if (node_active)
             {
-                id_ = -abs(id_); // add "selected" flag
+                element_.selection_.Add(handle_);
                 element_.state_ = NodesState_DragingSelected;
             }
         }
@@ -146,7 +187,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
 
             if (node_active)
             {
-                id_ = -abs(id_); // add "selected" flag
+                element_.selection_.Add(handle_);
                 element_.state_ = NodesState_DragingSelected;
             }
             else
@@ -168,12 +209,8 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
 
     bool consider_hover = element_.node_ ? element_.node_ == this : false;
 
-    ////////////////////////////////////////////////////////////////////////////////
-
-    if (element_.state_ != NodesState_Selected && element_.state_ != NodesState_DragingSelected && element_.state_ != NodesState_SelectingMore)
-    {
-        id_ = abs(id_); // remove "selected" flag
-    }
+    // connectors lie inside the node rectangle, skip their hover tests unless the spatial index put the mouse over us
+    const bool under_mouse = element_.IsUnderMouse(this);
 
     ////////////////////////////////////////////////////////////////////////////////
 
@@ -202,13 +239,36 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
 
         if (select_it && element_.state_ != NodesState_SelectingMore)
         {
-            id_ = -abs(id_); // add "selected" flag
+            element_.selection_.Add(handle_);
             element_.state_ = NodesState_SelectingValid;
         }
     }
 
+    const bool selected = element_.selection_.Contains(handle_);
+
     ////////////////////////////////////////////////////////////////////////////////
 
+    const NodeDetail detail = GetDetail(canvas_scale_);
+
+    if (detail == NodeDetail_Rect)
+    {
+        // connectors are neither drawn nor hit tested, drop a hover on one of them
+        if (element_.state_ == NodesState_HoverIO && element_.node_ == this)
+        {
+            element_.Reset();
+        }
+
+        bool highlight = (consider_select && consider_hover) || selected;
+        drawList->AddRectFilled(node_rect_min, node_rect_max, highlight ? ImColor(0.45f, 0.25f, 0.35f, 0.9f) : ImColor(0.25f, 0.0f, 0.125f, 0.9f));
+
+        ImGui::EndGroup();
+        ImGui::PopID();
+        return;
+    }
+
+    // rings get fewer segments once labels are gone
+    const int ring_segments = detail == NodeDetail_Full ? ((int)(6.0f * canvas_scale_) + 10) : 6;
+
     ImVec2 title_name_size = ImGui::CalcTextSize(name_.c_str());
     const float corner = title_name_size.y / 2.0f;
 
@@ -234,8 +294,11 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
             title_pos.y = node_rect_min.y + ((node_rect_max.y - node_rect_min.y) / 2.0f) - (title_name_size.y / 2.0f);
         }
 
-        ImGui::SetCursorScreenPos(title_pos);
-        ImGui::Text("%s", name_.c_str());
+        if (detail == NodeDetail_Full)
+        {
+            ImGui::SetCursorScreenPos(title_pos);
+            ImGui::Text("%s", name_.c_str());
+        }
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -256,6 +319,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
             ImVec2 input_name_size = ImGui::CalcTextSize(connection->name_.c_str());
             ImVec2 connection_pos = node_rect_min + (connection->position_ * canvas_scale_);
 
+            if (detail == NodeDetail_Full)
             {
                 ImVec2 pos = connection_pos;
                 pos += ImVec2(input_name_size.y * 0.75f, -input_name_size.y / 2.0f);
@@ -264,7 +328,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
                 ImGui::Text("%s", connection->name_.c_str());
             }
 
-            if (IsConnectorHovered(connection_pos, (input_name_size.y / 2.0f)))
+            if (under_mouse && IsConnectorHovered(connection_pos, (input_name_size.y / 2.0f)))
             {
                 consider_io |= element_.state_ == NodesState_Default;
                 consider_io |= element_.state_ == NodesState_HoverConnection;
@@ -285,14 +349,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
                     element_.state_ = NodesState_DragingInput;
 
                     // remove connection from this input
-                    if (connection->input_)
-                    {
-                        connection->input_->connections_--;
-                    }
-
-                    connection->target_ = nullptr;
-                    connection->input_ = nullptr;
-                    connection->connections_ = 0;
+                    Disconnect(graph_, *connection);
                 }
 
                 consider_io = true;
@@ -326,15 +383,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
 
                         if (!ImGui::IsMouseDown(0))
                         {
-                            if (connection->input_)
-                            {
-                                connection->input_->connections_--;
-                            }
-
-                            connection->target_ = element_.node_;
-                            connection->input_ = element_.connection_;
-                            connection->connections_ = 1;
-                            element_.connection_->connections_++;
+                            Connect(graph_, *element_.node_, *element_.connection_, *this, *connection);
 
                             element_.Reset(NodesState_HoverIO);
                             element_.node_ = this;
@@ -360,7 +409,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
                 }
             }
 
-            drawList->AddCircle(connection_pos, (input_name_size.y / 3.0f), color, ((int)(6.0f * canvas_scale_) + 10), (1.5f * canvas_scale_));
+            drawList->AddCircle(connection_pos, (input_name_size.y / 3.0f), color, ring_segments, (1.5f * canvas_scale_));
         }
 
         ////////////////////////////////////////////////////////////////////////////////
@@ -377,6 +426,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
             ImVec2 output_name_size = ImGui::CalcTextSize(connection->name_.c_str());
             ImVec2 connection_pos = node_rect_min + (connection->position_ * canvas_scale_);
 
+            if (detail == NodeDetail_Full)
             {
                 ImVec2 pos = connection_pos;
                 pos += ImVec2(-output_name_size.x - (output_name_size.y * 0.75f), -output_name_size.y / 2.0f);
@@ -385,7 +435,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
                 ImGui::Text("%s", connection->name_.c_str());
             }
 
-            if (IsConnectorHovered(connection_pos, (output_name_size.y / 2.0f)))
+            if (under_mouse && IsConnectorHovered(connection_pos, (output_name_size.y / 2.0f)))
             {
                 consider_io |= element_.state_ == NodesState_Default;
                 consider_io |= element_.state_ == NodesState_HoverConnection;
@@ -437,11 +487,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
 
                         if (!ImGui::IsMouseDown(0))
                         {
-                            element_.connection_->target_ = this;
-                            element_.connection_->input_ = connection.get();
-                            element_.connection_->connections_ = 1;
-
-                            connection->connections_++;
+                            Connect(graph_, *this, *connection, *element_.node_, *element_.connection_);
 
                             element_.Reset(NodesState_HoverIO);
                             element_.node_ = this;
@@ -467,7 +513,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
                 }
             }
 
-            drawList->AddCircle(connection_pos, (output_name_size.y / 3.0f), color, ((int)(6.0f * canvas_scale_) + 10), (1.5f * canvas_scale_));
+            drawList->AddCircle(connection_pos, (output_name_size.y / 3.0f), color, ring_segments, (1.5f * canvas_scale_));
         }
 
         ////////////////////////////////////////////////////////////////////////////////
@@ -475,7 +521,7 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
 
     ////////////////////////////////////////////////////////////////////////////////
 
-    if ((consider_select && consider_hover) || (id_ < 0))
+    if ((consider_select && consider_hover) || selected)
     {
         drawList->AddRectFilled(node_rect_min, node_rect_max, ImColor(1.0f, 1.0f, 1.0f, 0.25f), corner, ImDrawCornerFlags_All);
     }
@@ -483,4 +529,13 @@ void Node::Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, Nod
     ImGui::EndGroup();
     ImGui::PopID();
 }
+
+void Node::Cull(NodesElement &element_)
+{
+    // the mouse cannot be over us, so a hover on this node or its connectors ends
+    if (element_.node_ == this && (element_.state_ == NodesState_HoverNode || element_.state_ == NodesState_HoverIO))
+    {
+        element_.Reset();
+    }
+}
 } // namespace ChemiaAion
@@ -15,12 +15,32 @@ struct NodeType
     std::vector<std::pair<std::string, ConnectionType>> outputs_;
 };
 
+// level of detail, from the on-screen height of a node's title line
+enum NodeDetail : uint32_t
+{
+    NodeDetail_Full = 0, // text, connector rings
+    NodeDetail_Ports,    // header color and connector dots, no text
+    NodeDetail_Rect,     // a single filled rect, no connectors
+};
+
 struct NodesElement;
 struct Connection;
+struct Node;
+
+// a link from an output into an input, endpoints are kept by the pool
+struct Link
+{
+    BezierCache curve_; // canvas space
+};
+
+// nodes stay behind unique_ptr, the spatial index and NodesElement keep their addresses
+using NodeGraph = nodegraph::NodePool<std::unique_ptr<Node>, Link>;
+
 struct Node
 {
-    int32_t id_ = 0; // 0 = empty, positive/negative = not selected/selected
+    int32_t id_ = 0; // 0 = empty, creation order otherwise. Selection is kept in NodesElement::selection_
     int32_t state_ = NodeStateFlag_Default;
+    nodegraph::NodeHandle handle_;
 
     ImVec2 position_ = ImVec2(0.0f, 0.0f);
     ImVec2 size_ = ImVec2(0.0f, 0.0f);
@@ -32,9 +52,17 @@ struct Node
     std::vector<std::unique_ptr<Connection>> inputs_;
     std::vector<std::unique_ptr<Connection>> outputs_;
 
-    void Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, NodesElement &element_);
+    NodeDetail GetDetail(float canvas_scale_) const;
+
+    void Display(ImDrawList *drawList, ImVec2 offset, float canvas_scale_, NodesElement &element_, NodeGraph &graph_);
+    // instead of Display for a node off screen: keeps the hover state machine going, draws nothing
+    void Cull(NodesElement &element_);
 
     static std::unique_ptr<Node> Create(ImVec2 pos, const NodeType &type, int32_t id);
 };
 
+// replaces whatever was connected to input
+void Connect(NodeGraph &graph_, Node &from, Connection &output, Node &to, Connection &input);
+void Disconnect(NodeGraph &graph_, Connection &input);
+
 } // namespace ChemiaAion
\ No newline at end of file
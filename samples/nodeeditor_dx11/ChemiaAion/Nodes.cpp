@@ -10,6 +10,7 @@
 #include "Node.h"
 #include "NodesElement.h"
 #include "Canvas.h"
+#include "SpatialIndex.h"
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui_internal.h>
 
@@ -65,7 +66,8 @@ static const std::vector<NodeType> nodes_types_ =
 
 class NodesImpl
 {
-    std::vector<std::unique_ptr<Node>> nodes_;
+    NodeGraph graph_;
+    SpatialIndex index_;
 
     int32_t id_ = 0;
     NodesElement element_;
@@ -107,19 +109,37 @@ private:
         {
             if (type.name_ == key)
             {
-                auto n = Node::Create(pos, type, ++id_);
-                nodes_.push_back(std::move(n));
+                Insert(Node::Create(pos, type, ++id_));
                 return;
             }
         }
     }
 
+    Node *Insert(std::unique_ptr<Node> n)
+    {
+        Node *node = n.get();
+        node->handle_ = graph_.AddNode(std::move(n));
+        index_.Update(node);
+        return node;
+    }
+
     void DisplayNodes(ImDrawList *drawList, ImVec2 offset)
     {
+        // only nodes overlapping the canvas are submitted to the draw list
+        ImRect visible = m_canvas.GetVisibleRect(2.0f);
+
         ImGui::SetWindowFontScale(m_canvas.canvas_scale_);
-        for (auto &node : nodes_)
+        for (uint32_t i = 0; i < graph_.GetNodeCount(); ++i)
         {
-            node->Display(drawList, offset, m_canvas.canvas_scale_, element_);
+            Node *node = graph_.GetNodeAt(i).get();
+            if (visible.Overlaps(ImRect(node->position_, node->position_ + node->size_)))
+            {
+                node->Display(drawList, offset, m_canvas.canvas_scale_, element_, graph_);
+            }
+            else
+            {
+                node->Cull(element_);
+            }
         }
         ImGui::SetWindowFontScale(1.0f);
     }
@@ -153,9 +173,7 @@ private:
                 if (ImGui::MenuItem(node.name_.c_str()))
                 {
                     element_.Reset();
-                    auto n = Node::Create(m_canvas.NewNodePosition(), node, ++id_);
-                    nodes_.push_back(std::move(n));
-                    element_.node_ = nodes_.back().get();
+                    element_.node_ = Insert(Node::Create(m_canvas.NewNodePosition(), node, ++id_));
                 }
             }
             ImGui::EndPopup();
@@ -165,38 +183,39 @@ private:
 
     void DisplayCurves(ImDrawList *draw_list, const ImVec2 &offset)
     {
-        element_.UpdateState(offset, m_canvas.canvas_size_, m_canvas.canvas_mouse_, m_canvas.canvas_scale_, nodes_);
+        element_.UpdateState(offset, m_canvas.canvas_size_, m_canvas.canvas_mouse_, m_canvas.canvas_scale_, graph_, index_);
+
+        // curves are culled by their cached bounds, line width is a few pixels at most
+        ImRect visible = m_canvas.GetVisibleRect(4.0f);
 
         // connection curve
-        for (auto &node : nodes_)
+        for (uint32_t i = 0; i < graph_.GetEdgeCount(); ++i)
         {
-            for (auto &connection : node->inputs_)
-            {
-                if (connection->connections_ == 0)
-                {
-                    continue;
-                }
+            auto &link = graph_.GetEdgeAt(i);
+            Node *from = graph_.Get(link.From)->get();
+            Node *node = graph_.Get(link.To)->get();
+            Connection *output = from->outputs_[link.Output].get();
+            Connection *connection = node->inputs_[link.Input].get();
 
-                bool selected = false;
-                selected |= element_.state_ == NodesState_SelectedConnection;
-                selected |= element_.state_ == NodesState_DragingConnection;
-                selected &= element_.connection_ == connection.get();
+            bool selected = false;
+            selected |= element_.state_ == NodesState_SelectedConnection;
+            selected |= element_.state_ == NodesState_DragingConnection;
+            selected &= element_.connection_ == connection;
 
-                const float distance_squared = m_canvas.RenderLines(draw_list, offset, node, connection, selected);
+            const float distance_squared = m_canvas.RenderLines(draw_list, offset, visible, *from, *output, *node, *connection, link.Data.curve_, selected);
 
-                if (element_.state_ == NodesState_Default)
-                {
+            if (element_.state_ == NodesState_Default)
+            {
 
-                    if (distance_squared < (10.0f * 10.0f))
-                    {
-                        element_.Reset(NodesState_HoverConnection);
+                if (distance_squared < (10.0f * 10.0f))
+                {
+                    element_.Reset(NodesState_HoverConnection);
 
-                        element_.rectMin_ = (connection->target_->position_ + connection->input_->position_);
-                        element_.rectMax_ = (node->position_ + connection->position_);
+                    element_.rectMin_ = (from->position_ + output->position_);
+                    element_.rectMax_ = (node->position_ + connection->position_);
 
-                        element_.node_ = &*node;
-                        element_.connection_ = connection.get();
-                    }
+                    element_.node_ = node;
+                    element_.connection_ = connection;
                 }
             }
         }
@@ -1,33 +1,34 @@
 #include "NodesElement.h"
 #include "Node.h"
-#include "Bezier.h"
+#include "SpatialIndex.h"
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui_internal.h>
 
 namespace ChemiaAion
 {
-static Node *GetHoverNode(std::vector<std::unique_ptr<Node>> &nodes_, ImVec2 offset, ImVec2 pos, float canvas_scale_)
+static Node *GetHoverNode(const std::vector<Node *> &under_mouse_)
 {
-    for (auto &node : nodes_)
+    // oldest node wins, as nodes_ is in creation order
+    Node *hovered = nullptr;
+    for (auto node : under_mouse_)
     {
-        ImRect rect((node->position_ * canvas_scale_) + offset, ((node->position_ + node->size_) * canvas_scale_) + offset);
-
-        rect.Expand(2.0f);
-
-        if (rect.Contains(pos))
+        if (!hovered || node->id_ < hovered->id_)
         {
-            return &*node;
+            hovered = node;
         }
     }
 
-    return nullptr;
+    return hovered;
 }
 
 void NodesElement::UpdateState(ImVec2 offset,
                                const ImVec2 &canvas_size_, const ImVec2 &canvas_mouse_, float canvas_scale_,
-                               std::vector<std::unique_ptr<Node>> &nodes_)
+                               NodeGraph &graph_, SpatialIndex &index_)
 {
+    under_mouse_.clear();
+    index_.QueryPoint((ImGui::GetIO().MousePos - offset) / canvas_scale_, 2.0f / canvas_scale_, under_mouse_);
+
     if (state_ == NodesState_HoverNode && ImGui::IsMouseDoubleClicked(0))
     {
         if (node_->state_ < 0)
@@ -40,6 +41,7 @@ void NodesElement::UpdateState(ImVec2 offset,
         }
 
         node_->state_ = -node_->state_;
+        index_.Update(node_);
     }
 
     switch (state_)
@@ -73,12 +75,15 @@ void NodesElement::UpdateState(ImVec2 offset,
 
     case NodesState_HoverConnection:
     {
-        const float distance_squared = GetSquaredDistanceToBezierCurve(
-            ImGui::GetIO().MousePos,
-            offset + (rectMin_ * canvas_scale_),
-            offset + (rectMin_ * canvas_scale_) + (ImVec2(+50.0f, 0.0f) * canvas_scale_),
-            offset + (rectMax_ * canvas_scale_) + (ImVec2(-50.0f, 0.0f) * canvas_scale_),
-            offset + (rectMax_ * canvas_scale_));
+        // the link is gone if its node was deleted
+        auto link = graph_.Get(connection_->edge_);
+        if (!link)
+        {
+            Reset();
+            break;
+        }
+
+        const float distance_squared = link->Data.curve_.GetSquaredScreenDistance(ImGui::GetIO().MousePos, offset, canvas_scale_, 10.0f);
 
         if (distance_squared > (10.0f * 10.0f))
         {
@@ -203,27 +208,17 @@ void NodesElement::UpdateState(ImVec2 offset,
             break;
         }
 
-        for (auto &node : nodes_)
-        {
-            ImVec2 node_rect_min = offset + (node->position_ * canvas_scale_);
-            ImVec2 node_rect_max = node_rect_min + (node->size_ * canvas_scale_);
-
-            ImRect node_rect(node_rect_min, node_rect_max);
-
-            ImRect rect_(rectMin_, rectMax_);
-
-            if (ImGui::GetIO().KeyCtrl && rect_.Overlaps(node_rect))
-            {
-                node->id_ = -abs(node->id_); // add "selected" flag
-                continue;
-            }
+        // ctrl selects overlapped nodes, otherwise only fully contained ones
+        std::vector<Node *> selected;
+        index_.QueryRect((rectMin_ - offset) / canvas_scale_, (rectMax_ - offset) / canvas_scale_, !ImGui::GetIO().KeyCtrl, selected);
 
-            if (!ImGui::GetIO().KeyCtrl && rect_.Contains(node_rect))
-            {
-                node->id_ = -abs(node->id_); // add "selected" flag
-                continue;
-            }
+        std::vector<nodegraph::NodeHandle> handles;
+        handles.reserve(selected.size());
+        for (auto node : selected)
+        {
+            handles.push_back(node->handle_);
         }
+        selection_.Add(handles.data(), handles.size());
 
         Reset(NodesState_Selected);
     }
@@ -234,43 +229,26 @@ void NodesElement::UpdateState(ImVec2 offset,
         // delete all selected nodes
         if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Delete]))
         {
-            std::vector<std::unique_ptr<Node>> replacement;
-            replacement.reserve(nodes_.size());
-
-            // delete connections
-            for (auto &node : nodes_)
+            for (auto handle : selection_)
             {
-                for (auto &connection : node->inputs_)
-                {
-                    if (connection->connections_ == 0)
-                    {
-                        continue;
-                    }
-
-                    if (node->id_ < 0)
-                    {
-                        connection->input_->connections_--;
-                    }
-
-                    if (connection->target_->id_ < 0)
-                    {
-                        connection->target_ = nullptr;
-                        connection->input_ = nullptr;
-                        connection->connections_ = 0;
-                    }
-                }
+                index_.Remove(graph_.Get(handle)->get());
             }
 
-            // save not selected nodes
-            for (auto &node : nodes_)
-            {
-                if (node->id_ > 0)
+            // the pool drops the links with the nodes, the connectors on their surviving end are ours to update
+            graph_.RemoveNodes(selection_.data(), selection_.size(), [this](const auto &link, nodegraph::NodeHandle survivor) {
+                if (survivor == link.To)
                 {
-                    replacement.push_back(std::move(node));
+                    Connection &input = *(*graph_.Get(link.To))->inputs_[link.Input];
+                    input.edge_ = nodegraph::EdgeHandle();
+                    input.connections_ = 0;
                 }
-            }
+                else
+                {
+                    (*graph_.Get(link.From))->outputs_[link.Output]->connections_--;
+                }
+            });
 
-            nodes_ = std::move(replacement);
+            under_mouse_.clear();
 
             Reset();
             break;
@@ -283,7 +261,7 @@ void NodesElement::UpdateState(ImVec2 offset,
         }
 
         Reset();
-        auto hovered = GetHoverNode(nodes_, offset, ImGui::GetIO().MousePos, canvas_scale_);
+        auto hovered = GetHoverNode(under_mouse_);
 
         // empty area under the mouse
         if (!hovered)
@@ -306,7 +284,7 @@ void NodesElement::UpdateState(ImVec2 offset,
         // lets select node under the mouse
         if (ImGui::GetIO().KeyShift)
         {
-            hovered->id_ = -abs(hovered->id_);
+            selection_.Add(hovered->handle_);
             state_ = NodesState_DragingSelected;
             break;
         }
@@ -314,34 +292,26 @@ void NodesElement::UpdateState(ImVec2 offset,
         // lets toggle selection of a node under the mouse
         if (!ImGui::GetIO().KeyShift && ImGui::GetIO().KeyCtrl)
         {
-            if (hovered->id_ > 0)
+            if (selection_.Toggle(hovered->handle_))
             {
-                hovered->id_ = -abs(hovered->id_);
                 state_ = NodesState_DragingSelected;
             }
             else
             {
-                hovered->id_ = abs(hovered->id_);
                 state_ = NodesState_Selected;
             }
             break;
         }
 
         // lets start dragging
-        if (hovered->id_ < 0)
+        if (selection_.Contains(hovered->handle_))
         {
             state_ = NodesState_DragingSelected;
             break;
         }
 
         // not selected node clicked, lets jump selection to it
-        for (auto &node : nodes_)
-        {
-            if (node.get() != hovered)
-            {
-                node->id_ = abs(node->id_);
-            }
-        }
+        selection_.Clear();
     }
     break;
 
@@ -349,6 +319,15 @@ void NodesElement::UpdateState(ImVec2 offset,
     {
         if (!ImGui::IsMouseDown(0))
         {
+            // the grid was left alone during the drag, re-bucket the selection once
+            for (auto handle : selection_)
+            {
+                index_.Update(graph_.Get(handle)->get());
+            }
+
+            under_mouse_.clear();
+            index_.QueryPoint((ImGui::GetIO().MousePos - offset) / canvas_scale_, 2.0f / canvas_scale_, under_mouse_);
+
             if (node_)
             {
                 if (ImGui::GetIO().KeyShift || ImGui::GetIO().KeyCtrl)
@@ -366,12 +345,11 @@ void NodesElement::UpdateState(ImVec2 offset,
         }
         else
         {
-            for (auto &node : nodes_)
+            // the spatial index still has the nodes where the drag started, until the mouse is released
+            const ImVec2 delta = ImGui::GetIO().MouseDelta / canvas_scale_;
+            for (auto handle : selection_)
             {
-                if (node->id_ < 0)
-                {
-                    node->position_ += ImGui::GetIO().MouseDelta / canvas_scale_;
-                }
+                graph_.Get(handle)->get()->position_ += delta;
             }
         }
     }
@@ -385,14 +363,16 @@ void NodesElement::UpdateState(ImVec2 offset,
             break;
         }
 
+        auto link = graph_.Get(connection_->edge_);
+        if (!link)
+        {
+            Reset();
+            break;
+        }
+
         if (ImGui::IsMouseDown(0))
         {
-            const float distance_squared = GetSquaredDistanceToBezierCurve(
-                ImGui::GetIO().MousePos,
-                offset + (rectMin_ * canvas_scale_),
-                offset + (rectMin_ * canvas_scale_) + (ImVec2(+50.0f, 0.0f) * canvas_scale_),
-                offset + (rectMax_ * canvas_scale_) + (ImVec2(-50.0f, 0.0f) * canvas_scale_),
-                offset + (rectMax_ * canvas_scale_));
+            const float distance_squared = link->Data.curve_.GetSquaredScreenDistance(ImGui::GetIO().MousePos, offset, canvas_scale_, 10.0f);
 
             if (distance_squared > (10.0f * 10.0f))
             {
@@ -419,11 +399,27 @@ void NodesElement::UpdateState(ImVec2 offset,
             break;
         }
 
+        auto link = graph_.Get(connection_->edge_);
+        if (!link)
+        {
+            Reset();
+            break;
+        }
+
+        Node *target = graph_.Get(link->From)->get();
         node_->position_ += ImGui::GetIO().MouseDelta / canvas_scale_;
-        connection_->target_->position_ += ImGui::GetIO().MouseDelta / canvas_scale_;
+        target->position_ += ImGui::GetIO().MouseDelta / canvas_scale_;
+
+        index_.Update(node_);
+        index_.Update(target);
     }
     break;
     }
+
+    if (state_ != NodesState_Selected && state_ != NodesState_DragingSelected && state_ != NodesState_SelectingMore)
+    {
+        selection_.Clear();
+    }
 }
 
 } // namespace ChemiaAion
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+#include "Node.h"
+#include "../nodegraph/selection.h"
 #include <imgui.h>
 #include <cstdint>
 #include <vector>
@@ -29,6 +31,7 @@ enum NodesState : uint32_t
 
 struct Node;
 struct Connection;
+struct SpatialIndex;
 struct NodesElement
 {
     NodesState state_;
@@ -40,6 +43,12 @@ struct NodesElement
     Node *node_;
     Connection *connection_;
 
+    // nodes under the mouse this frame (spatial index query), only these can be hovered or be a drop target
+    std::vector<Node *> under_mouse_;
+
+    // selected nodes, outlives Reset(). Cleared at the end of UpdateState unless the state keeps a selection.
+    nodegraph::Selection<nodegraph::NodeHandle> selection_;
+
     NodesElement()
     {
         Reset();
@@ -57,9 +66,21 @@ struct NodesElement
         connection_ = nullptr;
     }
 
+    bool IsUnderMouse(const Node *node) const
+    {
+        for (auto under : under_mouse_)
+        {
+            if (under == node)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     void UpdateState(ImVec2 offset,
                      const ImVec2 &canvas_size_, const ImVec2 &canvas_mouse_, float canvas_scale_,
-                     std::vector<std::unique_ptr<Node>> &nodes_);
+                     NodeGraph &graph_, SpatialIndex &index_);
 };
 
 } // namespace ChemiaAion
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "SpatialIndex.h"
+#include "Node.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ChemiaAion
+{
+
+uint64_t SpatialIndex::GetKey(int32_t x, int32_t y)
+{
+    return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y;
+}
+
+SpatialIndex::CellRange SpatialIndex::GetRange(const ImVec2 &min, const ImVec2 &max)
+{
+    CellRange range;
+    range.x0_ = (int32_t)floorf(min.x / cell_size_);
+    range.y0_ = (int32_t)floorf(min.y / cell_size_);
+    range.x1_ = (int32_t)floorf(max.x / cell_size_);
+    range.y1_ = (int32_t)floorf(max.y / cell_size_);
+    return range;
+}
+
+void SpatialIndex::Link(Node *node, const CellRange &range)
+{
+    for (int32_t y = range.y0_; y <= range.y1_; ++y)
+    {
+        for (int32_t x = range.x0_; x <= range.x1_; ++x)
+        {
+            cells_[GetKey(x, y)].push_back({node, range.x0_, range.y0_});
+        }
+    }
+}
+
+void SpatialIndex::Unlink(Node *node, const CellRange &range)
+{
+    for (int32_t y = range.y0_; y <= range.y1_; ++y)
+    {
+        for (int32_t x = range.x0_; x <= range.x1_; ++x)
+        {
+            auto cell = cells_.find(GetKey(x, y));
+            if (cell == cells_.end())
+            {
+                continue;
+            }
+
+            auto &entries = cell->second;
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (entries[i].node_ == node)
+                {
+                    entries[i] = entries.back();
+                    entries.pop_back();
+                    break;
+                }
+            }
+
+            if (entries.empty())
+            {
+                cells_.erase(cell);
+            }
+        }
+    }
+}
+
+void SpatialIndex::Update(Node *node)
+{
+    ImVec2 max(node->position_.x + node->size_.x, node->position_.y + node->size_.y);
+    CellRange range = GetRange(node->position_, max);
+
+    auto it = ranges_.find(node);
+    if (it == ranges_.end())
+    {
+        ranges_.emplace(node, range);
+        Link(node, range);
+        return;
+    }
+
+    if (it->second == range)
+    {
+        return; // still in the same cells, the exact rectangle is read from the node on query
+    }
+
+    Unlink(node, it->second);
+    Link(node, range);
+    it->second = range;
+}
+
+void SpatialIndex::Remove(Node *node)
+{
+    auto it = ranges_.find(node);
+    if (it == ranges_.end())
+    {
+        return;
+    }
+
+    Unlink(node, it->second);
+    ranges_.erase(it);
+}
+
+void SpatialIndex::Clear()
+{
+    cells_.clear();
+    ranges_.clear();
+}
+
+void SpatialIndex::QueryPoint(const ImVec2 &point, float margin, std::vector<Node *> &out) const
+{
+    // a margin smaller than a cell means the point's own cell plus at most one neighbour per axis
+    QueryRect(ImVec2(point.x - margin, point.y - margin), ImVec2(point.x + margin, point.y + margin), false, out);
+}
+
+void SpatialIndex::QueryRect(const ImVec2 &min, const ImVec2 &max, bool contained, std::vector<Node *> &out) const
+{
+    const CellRange query = GetRange(min, max);
+
+    auto visit = [&](int32_t x, int32_t y, const std::vector<Entry> &entries) {
+        for (auto &entry : entries)
+        {
+            // report a node from the first cell it shares with the query only
+            if (x != std::max(entry.x0_, query.x0_) || y != std::max(entry.y0_, query.y0_))
+            {
+                continue;
+            }
+
+            const Node *node = entry.node_;
+            ImVec2 node_min = node->position_;
+            ImVec2 node_max(node_min.x + node->size_.x, node_min.y + node->size_.y);
+
+            bool hit;
+            if (contained)
+            {
+                hit = node_min.x >= min.x && node_min.y >= min.y && node_max.x <= max.x && node_max.y <= max.y;
+            }
+            else
+            {
+                hit = node_min.x <= max.x && node_min.y <= max.y && node_max.x >= min.x && node_max.y >= min.y;
+            }
+
+            if (hit)
+            {
+                out.push_back(entry.node_);
+            }
+        }
+    };
+
+    // a query covering more cells than are occupied (zoomed out box selection) walks the occupied cells instead
+    const uint64_t query_cells = (uint64_t)(query.x1_ - query.x0_ + 1) * (uint64_t)(query.y1_ - query.y0_ + 1);
+    if (query_cells > cells_.size())
+    {
+        for (auto &cell : cells_)
+        {
+            int32_t x = (int32_t)(uint32_t)(cell.first >> 32);
+            int32_t y = (int32_t)(uint32_t)(cell.first & 0xffffffff);
+            if (x >= query.x0_ && x <= query.x1_ && y >= query.y0_ && y <= query.y1_)
+            {
+                visit(x, y, cell.second);
+            }
+        }
+        return;
+    }
+
+    for (int32_t y = query.y0_; y <= query.y1_; ++y)
+    {
+        for (int32_t x = query.x0_; x <= query.x1_; ++x)
+        {
+            auto cell = cells_.find(GetKey(x, y));
+            if (cell != cells_.end())
+            {
+                visit(x, y, cell->second);
+            }
+        }
+    }
+}
+
+} // namespace ChemiaAion
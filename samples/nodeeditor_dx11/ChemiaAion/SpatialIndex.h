@@ -0,0 +1,61 @@
+#pragma once
+#include <imgui.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ChemiaAion
+{
+
+struct Node;
+
+// Uniform grid over node rectangles in canvas space (node position_/size_, before scroll and scale),
+// so zooming and scrolling never invalidate it. A node is linked into every cell its rectangle touches,
+// moving a node only touches the grid when its rectangle crosses a cell border.
+struct SpatialIndex
+{
+    static constexpr float cell_size_ = 256.0f;
+
+    // insert a new node or re-bucket a moved/resized one
+    void Update(Node *node);
+    void Remove(Node *node);
+    void Clear();
+
+    // nodes whose rectangle expanded by margin contains point, in no particular order
+    void QueryPoint(const ImVec2 &point, float margin, std::vector<Node *> &out) const;
+    // nodes whose rectangle overlaps (or lies inside, if contained) [min, max], in no particular order
+    void QueryRect(const ImVec2 &min, const ImVec2 &max, bool contained, std::vector<Node *> &out) const;
+
+    size_t Size() const
+    {
+        return ranges_.size();
+    }
+
+private:
+    struct CellRange
+    {
+        int32_t x0_, y0_, x1_, y1_;
+
+        bool operator==(const CellRange &other) const
+        {
+            return x0_ == other.x0_ && y0_ == other.y0_ && x1_ == other.x1_ && y1_ == other.y1_;
+        }
+    };
+
+    struct Entry
+    {
+        Node *node_;
+        int32_t x0_, y0_; // first cell of the node, a node spanning several cells is reported from one cell only
+    };
+
+    static uint64_t GetKey(int32_t x, int32_t y);
+    static CellRange GetRange(const ImVec2 &min, const ImVec2 &max);
+
+    void Link(Node *node, const CellRange &range);
+    void Unlink(Node *node, const CellRange &range);
+
+    std::unordered_map<uint64_t, std::vector<Entry>> cells_;
+    std::unordered_map<const Node *, CellRange> ranges_;
+};
+
+} // namespace ChemiaAion
@@ -0,0 +1,452 @@
+#include "dataflow.h"
+#include "task_pool.h"
+#include <plog/Log.h>
+#include <algorithm>
+
+namespace dataflow
+{
+
+const char *ValueTypeName(ValueType type)
+{
+    switch (type)
+    {
+    case ValueType::None:
+        return "None";
+    case ValueType::Float:
+        return "Float";
+    case ValueType::Int:
+        return "Int";
+    case ValueType::Vec3:
+        return "Vec3";
+    case ValueType::Vector2:
+        return "Vector2";
+    case ValueType::String:
+        return "String";
+    default:
+        return "?";
+    }
+}
+
+Value DefaultValue(ValueType type)
+{
+    switch (type)
+    {
+    case ValueType::Float:
+        return 0.0f;
+    case ValueType::Int:
+        return (int32_t)0;
+    case ValueType::Vec3:
+        return Vec3{0.0f, 0.0f, 0.0f};
+    case ValueType::Vector2:
+        return Vector2{0.0f, 0.0f};
+    case ValueType::String:
+        return std::string();
+    default:
+        return std::monostate();
+    }
+}
+
+KernelId KernelRegistry::Register(const std::string &name, std::vector<ValueType> inputs, std::vector<ValueType> outputs, KernelFunction function,
+                                  BatchKernelFunction batch)
+{
+    if (m_names.find(name) != m_names.end())
+    {
+        LOGE << "dataflow: kernel " << name << " is already registered";
+        return InvalidKernel;
+    }
+
+    KernelId id = (KernelId)m_kernels.size();
+    m_kernels.push_back({name, std::move(inputs), std::move(outputs), std::move(function), batch});
+    m_names.emplace(name, id);
+    return id;
+}
+
+KernelId KernelRegistry::Find(const std::string &name) const
+{
+    auto found = m_names.find(name);
+    return found == m_names.end() ? InvalidKernel : found->second;
+}
+
+NodeId Graph::AddNode(KernelId kernel)
+{
+    if (kernel >= m_registry.Size())
+    {
+        return InvalidNode;
+    }
+
+    const Kernel &k = m_registry.Get(kernel);
+    NodeData node;
+    node.Kernel = kernel;
+    node.Sources.resize(k.Inputs.size());
+    for (ValueType type : k.Inputs)
+    {
+        node.Constants.push_back(DefaultValue(type));
+    }
+    m_nodes.push_back(std::move(node));
+    return (NodeId)(m_nodes.size() - 1);
+}
+
+NodeId Graph::AddNode(const std::string &kernel)
+{
+    return AddNode(m_registry.Find(kernel));
+}
+
+bool Graph::Connect(NodeId from, uint32_t output, NodeId to, uint32_t input)
+{
+    if (from >= m_nodes.size() || to >= m_nodes.size())
+    {
+        return false;
+    }
+
+    const Kernel &source = m_registry.Get(m_nodes[from].Kernel);
+    const Kernel &target = m_registry.Get(m_nodes[to].Kernel);
+    if (output >= source.Outputs.size() || input >= target.Inputs.size())
+    {
+        return false;
+    }
+    if (source.Outputs[output] != target.Inputs[input])
+    {
+        LOGW << "dataflow: cannot connect " << ValueTypeName(source.Outputs[output]) << " output of " << source.Name
+             << " to " << ValueTypeName(target.Inputs[input]) << " input of " << target.Name;
+        return false;
+    }
+
+    m_nodes[to].Sources[input] = {from, output};
+    return true;
+}
+
+void Graph::Disconnect(NodeId to, uint32_t input)
+{
+    if (to < m_nodes.size() && input < m_nodes[to].Sources.size())
+    {
+        m_nodes[to].Sources[input] = PortRef();
+    }
+}
+
+bool Graph::SetConstant(NodeId node, uint32_t input, Value value)
+{
+    if (node >= m_nodes.size() || input >= m_nodes[node].Constants.size())
+    {
+        return false;
+    }
+    if (TypeOf(value) != m_registry.Get(m_nodes[node].Kernel).Inputs[input])
+    {
+        return false;
+    }
+
+    m_nodes[node].Constants[input] = std::move(value);
+    return true;
+}
+
+bool Program::Compile(const Graph &graph)
+{
+    const KernelRegistry &registry = graph.GetRegistry();
+    const uint32_t count = (uint32_t)graph.Size();
+
+    m_registry = &registry;
+    m_kernels.resize(count);
+    m_firstInput.assign(count + 1, 0);
+    m_firstOutput.assign(count + 1, 0);
+    for (NodeId i = 0; i < count; ++i)
+    {
+        const Kernel &kernel = registry.Get(graph.GetNode(i).Kernel);
+        m_kernels[i] = graph.GetNode(i).Kernel;
+        m_firstInput[i + 1] = m_firstInput[i] + (uint32_t)kernel.Inputs.size();
+        m_firstOutput[i + 1] = m_firstOutput[i] + (uint32_t)kernel.Outputs.size();
+    }
+
+    // sized once, the bound input pointers point into both
+    m_values.clear();
+    m_values.reserve(m_firstOutput[count]);
+    m_constants.clear();
+    m_constants.reserve(m_firstInput[count]);
+    m_inputs.resize(m_firstInput[count]);
+    m_inputPorts.resize(m_firstInput[count]);
+    for (NodeId i = 0; i < count; ++i)
+    {
+        for (ValueType type : registry.Get(graph.GetNode(i).Kernel).Outputs)
+        {
+            m_values.push_back(DefaultValue(type));
+        }
+    }
+    for (NodeId i = 0; i < count; ++i)
+    {
+        const Graph::NodeData &node = graph.GetNode(i);
+        for (uint32_t j = 0; j < node.Sources.size(); ++j)
+        {
+            const PortRef &source = node.Sources[j];
+            m_constants.push_back(node.Constants[j]);
+            m_inputPorts[m_firstInput[i] + j] = source.Node == InvalidNode ? ~0u : m_firstOutput[source.Node] + source.Port;
+            m_inputs[m_firstInput[i] + j] = source.Node == InvalidNode
+                                                ? &m_constants.back()
+                                                : &m_values[m_inputPorts[m_firstInput[i] + j]];
+        }
+    }
+
+    // distinct upstream/downstream nodes, a node reading several outputs of another waits for it once
+    std::vector<NodeId> stamp(count, InvalidNode);
+    std::vector<std::pair<NodeId, NodeId>> edges; // (from, to)
+    m_predecessorCount.assign(count, 0);
+    m_firstPredecessor.assign(count + 1, 0);
+    m_firstSuccessor.assign(count + 1, 0);
+    for (NodeId i = 0; i < count; ++i)
+    {
+        for (const PortRef &source : graph.GetNode(i).Sources)
+        {
+            if (source.Node == InvalidNode || stamp[source.Node] == i)
+            {
+                continue;
+            }
+            stamp[source.Node] = i;
+            edges.push_back({source.Node, i});
+            ++m_predecessorCount[i];
+            ++m_firstSuccessor[source.Node + 1];
+        }
+        m_firstPredecessor[i + 1] = (uint32_t)edges.size();
+    }
+    for (NodeId i = 0; i < count; ++i)
+    {
+        m_firstSuccessor[i + 1] += m_firstSuccessor[i];
+    }
+    // edges are grouped by their downstream node already
+    m_predecessors.resize(edges.size());
+    for (size_t e = 0; e < edges.size(); ++e)
+    {
+        m_predecessors[e] = edges[e].first;
+    }
+    m_successors.resize(edges.size());
+    std::vector<uint32_t> fill(m_firstSuccessor.begin(), m_firstSuccessor.end() - 1);
+    for (auto &edge : edges)
+    {
+        m_successors[fill[edge.first]++] = edge.second;
+    }
+
+    // Kahn's algorithm, m_order doubles as the queue
+    std::vector<uint32_t> pending(m_predecessorCount);
+    m_order.clear();
+    m_order.reserve(count);
+    m_roots.clear();
+    for (NodeId i = 0; i < count; ++i)
+    {
+        if (pending[i] == 0)
+        {
+            m_roots.push_back(i);
+            m_order.push_back(i);
+        }
+    }
+    for (size_t head = 0; head < m_order.size(); ++head)
+    {
+        NodeId node = m_order[head];
+        for (uint32_t s = m_firstSuccessor[node]; s < m_firstSuccessor[node + 1]; ++s)
+        {
+            if (--pending[m_successors[s]] == 0)
+            {
+                m_order.push_back(m_successors[s]);
+            }
+        }
+    }
+
+    m_cycle.clear();
+    if (m_order.size() != count)
+    {
+        // every node left over has an upstream node that is left over too, walking those upstream must close a loop
+        NodeId node = 0;
+        while (pending[node] == 0)
+        {
+            ++node;
+        }
+        std::vector<uint32_t> visited(count, ~0u); // position on the walk
+        std::vector<NodeId> walk;
+        while (visited[node] == ~0u)
+        {
+            visited[node] = (uint32_t)walk.size();
+            walk.push_back(node);
+            for (const PortRef &source : graph.GetNode(node).Sources)
+            {
+                if (source.Node != InvalidNode && pending[source.Node] != 0)
+                {
+                    node = source.Node;
+                    break;
+                }
+            }
+        }
+        m_cycle.assign(walk.begin() + visited[node], walk.end());
+        std::reverse(m_cycle.begin(), m_cycle.end());
+
+        LOGE << "dataflow: the graph has a cycle of " << m_cycle.size() << " nodes through node " << m_cycle.front()
+             << ", " << (count - m_order.size()) << " nodes cannot run";
+        m_kernels.clear();
+        m_order.clear();
+        m_roots.clear();
+        return false;
+    }
+
+    m_pending.reset(new std::atomic<uint32_t>[count]);
+
+    // nothing has run, everything is stale until pulled or executed
+    m_clock = 0;
+    m_portVersions.assign(m_values.size(), 0);
+    m_runVersions.assign(count, 0);
+    m_constantVersions.assign(count, 0);
+    m_stale.assign(count, 1);
+    return true;
+}
+
+void Program::Execute(TaskPool *pool)
+{
+    const uint32_t count = (uint32_t)m_kernels.size();
+
+    // every node and output is as new as the run
+    ++m_clock;
+    std::fill(m_portVersions.begin(), m_portVersions.end(), m_clock);
+    std::fill(m_runVersions.begin(), m_runVersions.end(), m_clock);
+    std::fill(m_stale.begin(), m_stale.end(), (uint8_t)0);
+    m_stats.NodesRun += count;
+
+    if (!pool || pool->GetThreadCount() <= 1)
+    {
+        for (NodeId node : m_order)
+        {
+            RunNode(node);
+        }
+        return;
+    }
+
+    for (NodeId i = 0; i < count; ++i)
+    {
+        m_pending[i].store(m_predecessorCount[i], std::memory_order_relaxed);
+    }
+    pool->Run(count, m_roots.data(), m_roots.size(), [this, pool](uint32_t node, int worker) {
+        RunNode(node);
+        for (uint32_t s = m_firstSuccessor[node]; s < m_firstSuccessor[node + 1]; ++s)
+        {
+            // the last upstream node to finish queues it
+            if (m_pending[m_successors[s]].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                pool->Push(worker, m_successors[s]);
+            }
+        }
+    });
+}
+
+bool Program::SetConstant(NodeId node, uint32_t input, Value value)
+{
+    if (node >= m_kernels.size() || input >= m_firstInput[node + 1] - m_firstInput[node])
+    {
+        return false;
+    }
+
+    const uint32_t slot = m_firstInput[node] + input;
+    if (m_inputPorts[slot] != ~0u || value.index() != m_constants[slot].index())
+    {
+        return false;
+    }
+    if (m_constants[slot] == value)
+    {
+        return true;
+    }
+
+    m_constants[slot] = std::move(value);
+    Invalidate(node);
+    return true;
+}
+
+void Program::Invalidate(NodeId node)
+{
+    m_constantVersions[node] = ++m_clock; // reruns even if none of its inputs changed
+    if (m_stale[node])
+    {
+        return; // downstream nodes are stale already
+    }
+
+    m_stale[node] = 1;
+    m_stack.clear();
+    m_stack.push_back({node, false});
+    while (!m_stack.empty())
+    {
+        NodeId current = m_stack.back().first;
+        m_stack.pop_back();
+        for (uint32_t s = m_firstSuccessor[current]; s < m_firstSuccessor[current + 1]; ++s)
+        {
+            NodeId successor = m_successors[s];
+            if (!m_stale[successor])
+            {
+                m_stale[successor] = 1;
+                m_stack.push_back({successor, false});
+            }
+        }
+    }
+}
+
+void Program::Refresh(NodeId node)
+{
+    uint64_t newest = m_constantVersions[node];
+    for (uint32_t i = m_firstInput[node]; i < m_firstInput[node + 1]; ++i)
+    {
+        if (m_inputPorts[i] != ~0u)
+        {
+            newest = std::max(newest, m_portVersions[m_inputPorts[i]]);
+        }
+    }
+
+    m_stale[node] = 0;
+    if (m_runVersions[node] != 0 && newest <= m_runVersions[node])
+    {
+        ++m_stats.NodesReused;
+        return;
+    }
+
+    const uint32_t first = m_firstOutput[node], last = m_firstOutput[node + 1];
+    m_previous.assign(m_values.begin() + first, m_values.begin() + last);
+    RunNode(node);
+
+    // memoized outputs keep their stamp when the rerun reproduced them
+    ++m_clock;
+    for (uint32_t i = first; i < last; ++i)
+    {
+        if (m_runVersions[node] == 0 || !(m_values[i] == m_previous[i - first]))
+        {
+            m_portVersions[i] = m_clock;
+        }
+    }
+    m_runVersions[node] = m_clock;
+    ++m_stats.NodesRun;
+}
+
+void Program::Update(NodeId node)
+{
+    if (!m_stale[node])
+    {
+        return;
+    }
+
+    // depth first over the stale upstream nodes, a node is refreshed once all of its upstream nodes are
+    m_stack.clear();
+    m_stack.push_back({node, false});
+    while (!m_stack.empty())
+    {
+        auto &top = m_stack.back();
+        const NodeId current = top.first;
+        if (!m_stale[current])
+        {
+            m_stack.pop_back();
+            continue;
+        }
+        if (!top.second)
+        {
+            top.second = true;
+            for (uint32_t p = m_firstPredecessor[current]; p < m_firstPredecessor[current + 1]; ++p)
+            {
+                if (m_stale[m_predecessors[p]])
+                {
+                    m_stack.push_back({m_predecessors[p], false});
+                }
+            }
+            continue;
+        }
+        m_stack.pop_back();
+        Refresh(current);
+    }
+}
+
+} // namespace dataflow
@@ -0,0 +1,234 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+///
+/// Evaluation of node graphs, independent of the editors that draw them.
+///
+/// KernelRegistry registry;
+/// registry.Register("Add", {ValueType::Float, ValueType::Float}, {ValueType::Float},
+///                   [](const Value *const *in, Value *out) { out[0] = std::get<float>(*in[0]) + std::get<float>(*in[1]); });
+/// Graph graph(registry);
+/// NodeId a = graph.AddNode("Add"), b = graph.AddNode("Add");
+/// graph.SetConstant(a, 0, 1.0f);
+/// graph.Connect(a, 0, b, 1);
+/// Program program;
+/// if (program.Compile(graph))
+///     program.Execute(&pool);
+/// std::get<float>(program.GetOutput(b, 0));
+///
+/// Compile() sorts the nodes topologically and rejects cycles. Execute() runs the kernels in that order, or with a
+/// TaskPool, runs every node as soon as all of its upstream nodes have finished, independent nodes in parallel.
+///
+/// After an edit, instead of Execute():
+/// program.SetConstant(a, 0, 2.0f); // marks a and everything downstream of it stale
+/// program.Pull(b, 0);              // reruns the stale nodes b depends on, nothing else
+///
+
+namespace dataflow
+{
+
+enum class ValueType : uint8_t
+{
+    None, // carries no value, only orders execution (spacechase0's Sequence pins)
+    Float,
+    Int,
+    Vec3,
+    Vector2,
+    String,
+    Count,
+};
+const char *ValueTypeName(ValueType type);
+
+struct Vector2
+{
+    float X, Y;
+
+    bool operator==(const Vector2 &other) const { return X == other.X && Y == other.Y; }
+};
+
+struct Vec3
+{
+    float X, Y, Z;
+
+    bool operator==(const Vec3 &other) const { return X == other.X && Y == other.Y && Z == other.Z; }
+};
+
+// the alternative index is the ValueType
+using Value = std::variant<std::monostate, float, int32_t, Vec3, Vector2, std::string>;
+Value DefaultValue(ValueType type);
+inline ValueType TypeOf(const Value &value) { return (ValueType)value.index(); }
+
+// inputs[i] points at the upstream output or the node's constant, outputs are the node's own slots, initialized to
+// DefaultValue() of the declared types. A kernel may run concurrently with other kernels, but never with itself
+// on the same node.
+using KernelFunction = std::function<void(const Value *const *inputs, Value *outputs)>;
+
+// Optional form of a kernel for Tape, over count samples at once: one array of count floats per component of
+// every port (Float 1, Vector2 2, Vec3 3), inputs[] and outputs[] list the components of all ports in order.
+// Must be pure, Tape folds nodes with constant inputs by running it once at compile time.
+using BatchKernelFunction = void (*)(const float *const *inputs, float *const *outputs, uint32_t count);
+
+struct Kernel
+{
+    std::string Name;
+    std::vector<ValueType> Inputs;
+    std::vector<ValueType> Outputs;
+    KernelFunction Function;
+    BatchKernelFunction Batch;
+};
+
+using KernelId = uint32_t;
+static const KernelId InvalidKernel = ~0u;
+
+class KernelRegistry
+{
+    std::vector<Kernel> m_kernels;
+    std::unordered_map<std::string, KernelId> m_names;
+
+public:
+    // Return InvalidKernel if name is already registered.
+    KernelId Register(const std::string &name, std::vector<ValueType> inputs, std::vector<ValueType> outputs, KernelFunction function,
+                      BatchKernelFunction batch = nullptr);
+    KernelId Find(const std::string &name) const;
+    const Kernel &Get(KernelId id) const { return m_kernels[id]; }
+    size_t Size() const { return m_kernels.size(); }
+};
+
+using NodeId = uint32_t;
+static const NodeId InvalidNode = ~0u;
+
+struct PortRef
+{
+    NodeId Node = InvalidNode;
+    uint32_t Port = 0;
+};
+
+class Graph
+{
+public:
+    struct NodeData
+    {
+        KernelId Kernel;
+        std::vector<PortRef> Sources;  // per input, Node is InvalidNode while unconnected
+        std::vector<Value> Constants;  // per input, read while unconnected
+    };
+
+private:
+    const KernelRegistry &m_registry;
+    std::vector<NodeData> m_nodes;
+
+public:
+    explicit Graph(const KernelRegistry &registry) : m_registry(registry) {}
+    const KernelRegistry &GetRegistry() const { return m_registry; }
+
+    // Return InvalidNode for an unknown kernel.
+    NodeId AddNode(KernelId kernel);
+    NodeId AddNode(const std::string &kernel);
+    // Replaces an existing connection into the input. Return false if a port is out of range or the types differ.
+    bool Connect(NodeId from, uint32_t output, NodeId to, uint32_t input);
+    void Disconnect(NodeId to, uint32_t input);
+    // Return false if the input is out of range or value has a different type.
+    bool SetConstant(NodeId node, uint32_t input, Value value);
+    void Clear() { m_nodes.clear(); }
+
+    size_t Size() const { return m_nodes.size(); }
+    const NodeData &GetNode(NodeId node) const { return m_nodes[node]; }
+};
+
+class TaskPool;
+
+struct ProgramStats
+{
+    uint64_t NodesRun = 0;
+    uint64_t NodesReused = 0; // stale nodes whose inputs turned out unchanged, the memoized outputs were kept
+};
+
+///
+/// A graph lowered into flat arrays: kernels and their bound input pointers in topological order, all outputs in one
+/// value array, and the successor lists the parallel scheduler counts down. Changing the graph means compiling again,
+/// changing a constant does not.
+///
+/// Incremental evaluation stamps versions from one clock: an output port has the time its value last changed, a
+/// node the time it last ran and the time one of its constants last changed. Stale marks only say "an upstream
+/// node may have changed". A stale node that is pulled reruns only if one of its stamps is newer than its last
+/// run, and its outputs keep their old stamps unless the rerun produced different values, so the edit stops
+/// spreading where a result comes out the same.
+///
+class Program
+{
+    // kernels are looked up by id on each run, registering another kernel may move the registry's storage
+    const KernelRegistry *m_registry = nullptr;
+    std::vector<KernelId> m_kernels;                 // per node
+    std::vector<uint32_t> m_firstInput;              // per node + 1, into m_inputs
+    std::vector<const Value *> m_inputs;             // into m_values or m_constants
+    std::vector<uint32_t> m_inputPorts;              // per input, index into m_values, ~0u for a constant
+    std::vector<uint32_t> m_firstOutput;             // per node + 1, into m_values
+    std::vector<Value> m_values;
+    std::vector<Value> m_constants;
+
+    std::vector<NodeId> m_order;             // topological
+    std::vector<NodeId> m_roots;             // nodes without upstream nodes
+    std::vector<uint32_t> m_firstSuccessor;  // per node + 1, into m_successors
+    std::vector<NodeId> m_successors;        // distinct downstream nodes
+    std::vector<uint32_t> m_predecessorCount; // distinct upstream nodes
+    std::vector<uint32_t> m_firstPredecessor; // per node + 1, into m_predecessors
+    std::vector<NodeId> m_predecessors;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_pending;
+
+    uint64_t m_clock = 0;
+    std::vector<uint64_t> m_portVersions;     // per output, when its value last changed
+    std::vector<uint64_t> m_runVersions;      // per node, when it last ran, 0 = never
+    std::vector<uint64_t> m_constantVersions; // per node, when one of its constants last changed
+    std::vector<uint8_t> m_stale;             // per node, a stale node's downstream nodes are all stale too
+    std::vector<Value> m_previous;            // scratch for comparing a rerun's outputs
+    std::vector<std::pair<NodeId, bool>> m_stack;
+    ProgramStats m_stats;
+
+    std::vector<NodeId> m_cycle;
+
+    void RunNode(NodeId node)
+    {
+        m_registry->Get(m_kernels[node]).Function(m_inputs.data() + m_firstInput[node], m_values.data() + m_firstOutput[node]);
+    }
+    void Refresh(NodeId node);
+
+public:
+    // Return false and fill GetCycle() if the graph has a cycle.
+    bool Compile(const Graph &graph);
+    // Run every node once. Without a pool (or with a single thread pool) the nodes run in topological order on the calling thread.
+    void Execute(TaskPool *pool = nullptr);
+
+    // Change the constant of an unconnected input and mark the node and its downstream nodes stale, without
+    // running anything. The Graph is not changed. Return false if the input is connected, out of range or of a
+    // different type.
+    bool SetConstant(NodeId node, uint32_t input, Value value);
+    // Mark node and everything downstream of it stale, for kernels reading state outside of their inputs.
+    void Invalidate(NodeId node);
+    // Bring node's outputs up to date, running the stale nodes it depends on, upstream first.
+    void Update(NodeId node);
+    const Value &Pull(NodeId node, uint32_t output)
+    {
+        Update(node);
+        return GetOutput(node, output);
+    }
+    bool IsStale(NodeId node) const { return m_stale[node] != 0; }
+    uint64_t GetPortVersion(NodeId node, uint32_t output) const { return m_portVersions[m_firstOutput[node] + output]; }
+
+    const ProgramStats &GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = ProgramStats(); }
+
+    size_t Size() const { return m_kernels.size(); }
+    const Value &GetOutput(NodeId node, uint32_t output) const { return m_values[m_firstOutput[node] + output]; }
+    const std::vector<NodeId> &GetOrder() const { return m_order; }
+    // the nodes of one cycle in connection order, after a failed Compile()
+    const std::vector<NodeId> &GetCycle() const { return m_cycle; }
+};
+
+} // namespace dataflow
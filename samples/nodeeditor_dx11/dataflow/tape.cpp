@@ -0,0 +1,402 @@
+#include "tape.h"
+#include <plog/Log.h>
+#include <algorithm>
+#include <string.h>
+#include <unordered_map>
+
+namespace dataflow
+{
+
+uint32_t ComponentCount(ValueType type)
+{
+    switch (type)
+    {
+    case ValueType::Float:
+        return 1;
+    case ValueType::Vector2:
+        return 2;
+    case ValueType::Vec3:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+namespace
+{
+// one component of a port while compiling: a constant, or a value computed at run time
+struct Slot
+{
+    bool IsConstant;
+    float Constant;
+    uint32_t Id; // value id
+};
+
+void AppendConstant(const Value &value, std::vector<Slot> &slots)
+{
+    if (auto f = std::get_if<float>(&value))
+    {
+        slots.push_back({true, *f, 0});
+    }
+    else if (auto v = std::get_if<Vector2>(&value))
+    {
+        slots.push_back({true, v->X, 0});
+        slots.push_back({true, v->Y, 0});
+    }
+    else if (auto v = std::get_if<Vec3>(&value))
+    {
+        slots.push_back({true, v->X, 0});
+        slots.push_back({true, v->Y, 0});
+        slots.push_back({true, v->Z, 0});
+    }
+}
+
+// an instruction before register allocation, operands are value ids
+struct VirtualInstruction
+{
+    BatchKernelFunction Function;
+    std::vector<Slot> Inputs;
+    uint32_t FirstOutput; // value ids FirstOutput, FirstOutput + 1, ...
+    uint32_t OutputCount;
+};
+} // namespace
+
+bool Tape::Compile(const Graph &graph, const std::vector<PortRef> &inputs, const std::vector<PortRef> &outputs)
+{
+    m_instructions.clear();
+    m_operands.clear();
+    m_pointers.clear();
+    m_constants.clear();
+    m_inputRegisters.clear();
+    m_outputRegisters.clear();
+    m_registers.clear();
+    m_registerCount = 0;
+    m_foldedCount = 0;
+
+    const KernelRegistry &registry = graph.GetRegistry();
+    const uint32_t count = (uint32_t)graph.Size();
+
+    Program program; // validates and orders
+    if (!program.Compile(graph))
+    {
+        return false;
+    }
+
+    // nodes the outputs depend on
+    std::vector<uint8_t> needed(count, 0);
+    std::vector<NodeId> stack;
+    for (auto &output : outputs)
+    {
+        if (output.Node >= count || output.Port >= registry.Get(graph.GetNode(output.Node).Kernel).Outputs.size())
+        {
+            LOGE << "dataflow: tape output " << output.Node << ":" << output.Port << " does not exist";
+            return false;
+        }
+        stack.push_back(output.Node);
+    }
+    while (!stack.empty())
+    {
+        NodeId node = stack.back();
+        stack.pop_back();
+        if (needed[node])
+        {
+            continue;
+        }
+        needed[node] = 1;
+        for (auto &source : graph.GetNode(node).Sources)
+        {
+            if (source.Node != InvalidNode && !needed[source.Node])
+            {
+                stack.push_back(source.Node);
+            }
+        }
+    }
+
+    // inputs fed per sample are the first values
+    uint32_t valueCount = 0;
+    std::unordered_map<uint64_t, std::vector<Slot>> variables; // (node, input) -> slots
+    for (auto &input : inputs)
+    {
+        if (input.Node >= count || input.Port >= graph.GetNode(input.Node).Sources.size() ||
+            graph.GetNode(input.Node).Sources[input.Port].Node != InvalidNode)
+        {
+            LOGE << "dataflow: tape input " << input.Node << ":" << input.Port << " is connected or does not exist";
+            return false;
+        }
+        const uint32_t components = ComponentCount(registry.Get(graph.GetNode(input.Node).Kernel).Inputs[input.Port]);
+        auto &slots = variables[((uint64_t)input.Node << 32) | input.Port];
+        for (uint32_t c = 0; c < components; ++c)
+        {
+            slots.push_back({false, 0.0f, valueCount++});
+        }
+    }
+    const uint32_t variableCount = valueCount;
+
+    // in topological order: fold or emit
+    std::vector<VirtualInstruction> instructions;
+    std::vector<float> scalarInputs, scalarOutputs;
+    std::vector<const float *> scalarInputPointers;
+    std::vector<float *> scalarOutputPointers;
+    std::vector<std::vector<Slot>> nodeSlots(count); // output components per node
+    for (NodeId node : program.GetOrder())
+    {
+        if (!needed[node])
+        {
+            continue;
+        }
+
+        const Graph::NodeData &data = graph.GetNode(node);
+        const Kernel &kernel = registry.Get(data.Kernel);
+        if (!kernel.Batch)
+        {
+            LOGE << "dataflow: kernel " << kernel.Name << " has no batch form";
+            return false;
+        }
+
+        VirtualInstruction instruction;
+        instruction.Function = kernel.Batch;
+        bool constant = true;
+        for (uint32_t i = 0; i < kernel.Inputs.size(); ++i)
+        {
+            if (ComponentCount(kernel.Inputs[i]) == 0)
+            {
+                LOGE << "dataflow: " << ValueTypeName(kernel.Inputs[i]) << " input of " << kernel.Name << " cannot be lowered";
+                return false;
+            }
+
+            const PortRef &source = data.Sources[i];
+            auto variable = variables.find(((uint64_t)node << 32) | i);
+            if (source.Node != InvalidNode)
+            {
+                const std::vector<Slot> &sourceSlots = nodeSlots[source.Node];
+                uint32_t first = 0;
+                const Kernel &sourceKernel = registry.Get(graph.GetNode(source.Node).Kernel);
+                for (uint32_t o = 0; o < source.Port; ++o)
+                {
+                    first += ComponentCount(sourceKernel.Outputs[o]);
+                }
+                instruction.Inputs.insert(instruction.Inputs.end(), sourceSlots.begin() + first,
+                                          sourceSlots.begin() + first + ComponentCount(kernel.Inputs[i]));
+            }
+            else if (variable != variables.end())
+            {
+                instruction.Inputs.insert(instruction.Inputs.end(), variable->second.begin(), variable->second.end());
+            }
+            else
+            {
+                AppendConstant(data.Constants[i], instruction.Inputs);
+            }
+        }
+        for (auto &slot : instruction.Inputs)
+        {
+            constant &= slot.IsConstant;
+        }
+
+        uint32_t outputComponents = 0;
+        for (ValueType type : kernel.Outputs)
+        {
+            if (ComponentCount(type) == 0)
+            {
+                LOGE << "dataflow: " << ValueTypeName(type) << " output of " << kernel.Name << " cannot be lowered";
+                return false;
+            }
+            outputComponents += ComponentCount(type);
+        }
+
+        std::vector<Slot> &outputSlots = nodeSlots[node];
+        if (constant)
+        {
+            // run it once now, its outputs become constants
+            scalarInputs.clear();
+            for (auto &slot : instruction.Inputs)
+            {
+                scalarInputs.push_back(slot.Constant);
+            }
+            scalarOutputs.assign(outputComponents, 0.0f);
+            scalarInputPointers.clear();
+            for (auto &input : scalarInputs)
+            {
+                scalarInputPointers.push_back(&input);
+            }
+            scalarOutputPointers.clear();
+            for (auto &output : scalarOutputs)
+            {
+                scalarOutputPointers.push_back(&output);
+            }
+            kernel.Batch(scalarInputPointers.data(), scalarOutputPointers.data(), 1);
+            for (float value : scalarOutputs)
+            {
+                outputSlots.push_back({true, value, 0});
+            }
+            ++m_foldedCount;
+            continue;
+        }
+
+        instruction.FirstOutput = valueCount;
+        instruction.OutputCount = outputComponents;
+        for (uint32_t c = 0; c < outputComponents; ++c)
+        {
+            outputSlots.push_back({false, 0.0f, valueCount++});
+        }
+        instructions.push_back(std::move(instruction));
+    }
+
+    // liveness: the last instruction reading a value, requested outputs and inputs live to the end
+    const uint32_t forever = ~0u;
+    std::vector<uint32_t> lastUse(valueCount, 0);
+    std::vector<uint8_t> used(valueCount, 0);
+    for (uint32_t v = 0; v < variableCount; ++v)
+    {
+        lastUse[v] = forever;
+    }
+    for (uint32_t i = 0; i < instructions.size(); ++i)
+    {
+        for (auto &slot : instructions[i].Inputs)
+        {
+            if (!slot.IsConstant)
+            {
+                used[slot.Id] = 1;
+                lastUse[slot.Id] = lastUse[slot.Id] == forever ? forever : i;
+            }
+        }
+    }
+
+    std::vector<Slot> outputSlots;
+    for (auto &output : outputs)
+    {
+        const Kernel &kernel = registry.Get(graph.GetNode(output.Node).Kernel);
+        uint32_t first = 0;
+        for (uint32_t o = 0; o < output.Port; ++o)
+        {
+            first += ComponentCount(kernel.Outputs[o]);
+        }
+        const std::vector<Slot> &slots = nodeSlots[output.Node];
+        outputSlots.insert(outputSlots.end(), slots.begin() + first, slots.begin() + first + ComponentCount(kernel.Outputs[output.Port]));
+    }
+    for (auto &slot : outputSlots)
+    {
+        if (!slot.IsConstant)
+        {
+            lastUse[slot.Id] = forever;
+        }
+    }
+
+    // registers: constants and inputs pinned, the rest from a free list in instruction order
+    std::vector<uint32_t> registerOf(valueCount, forever);
+    std::vector<uint32_t> freeRegisters;
+    std::unordered_map<uint32_t, uint32_t> constantRegisters; // float bits -> register
+    auto constantRegister = [&](float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        auto found = constantRegisters.find(bits);
+        if (found != constantRegisters.end())
+        {
+            return found->second;
+        }
+        m_constants.push_back({m_registerCount, value});
+        constantRegisters.emplace(bits, m_registerCount);
+        return m_registerCount++;
+    };
+    auto release = [&](uint32_t value) {
+        if (registerOf[value] != forever && lastUse[value] != forever)
+        {
+            freeRegisters.push_back(registerOf[value]);
+            lastUse[value] = forever; // released once, also when an instruction reads it twice
+        }
+    };
+
+    for (uint32_t v = 0; v < variableCount; ++v)
+    {
+        registerOf[v] = m_registerCount++;
+        m_inputRegisters.push_back(registerOf[v]);
+    }
+
+    for (uint32_t i = 0; i < instructions.size(); ++i)
+    {
+        const VirtualInstruction &instruction = instructions[i];
+        Instruction lowered;
+        lowered.Function = instruction.Function;
+        lowered.FirstOperand = (uint32_t)m_operands.size();
+        lowered.InputCount = (uint32_t)instruction.Inputs.size();
+        for (auto &slot : instruction.Inputs)
+        {
+            m_operands.push_back(slot.IsConstant ? constantRegister(slot.Constant) : registerOf[slot.Id]);
+        }
+
+        // outputs are allocated before the inputs are released, a kernel may write an output before reading all inputs
+        for (uint32_t c = 0; c < instruction.OutputCount; ++c)
+        {
+            const uint32_t value = instruction.FirstOutput + c;
+            if (freeRegisters.empty())
+            {
+                registerOf[value] = m_registerCount++;
+            }
+            else
+            {
+                registerOf[value] = freeRegisters.back();
+                freeRegisters.pop_back();
+            }
+            m_operands.push_back(registerOf[value]);
+        }
+        m_instructions.push_back(lowered);
+
+        for (auto &slot : instruction.Inputs)
+        {
+            if (!slot.IsConstant && lastUse[slot.Id] == i)
+            {
+                release(slot.Id);
+            }
+        }
+        for (uint32_t c = 0; c < instruction.OutputCount; ++c)
+        {
+            // computed along with a used output but never read
+            const uint32_t value = instruction.FirstOutput + c;
+            if (!used[value])
+            {
+                release(value);
+            }
+        }
+    }
+
+    for (auto &slot : outputSlots)
+    {
+        m_outputRegisters.push_back(slot.IsConstant ? constantRegister(slot.Constant) : registerOf[slot.Id]);
+    }
+
+    m_registers.assign((size_t)m_registerCount * BatchSize, 0.0f);
+    for (auto &constant : m_constants)
+    {
+        std::fill_n(m_registers.begin() + (size_t)constant.Register * BatchSize, BatchSize, constant.Value);
+    }
+    for (uint32_t operand : m_operands)
+    {
+        m_pointers.push_back(m_registers.data() + (size_t)operand * BatchSize);
+    }
+
+    return true;
+}
+
+void Tape::Execute(const float *const *inputs, float *const *outputs, uint32_t count)
+{
+    float *const *pointers = m_pointers.data();
+    for (uint32_t first = 0; first < count; first += BatchSize)
+    {
+        const uint32_t n = std::min(BatchSize, count - first);
+        for (size_t i = 0; i < m_inputRegisters.size(); ++i)
+        {
+            memcpy(m_registers.data() + (size_t)m_inputRegisters[i] * BatchSize, inputs[i] + first, n * sizeof(float));
+        }
+
+        for (const Instruction &instruction : m_instructions)
+        {
+            instruction.Function(pointers + instruction.FirstOperand, pointers + instruction.FirstOperand + instruction.InputCount, n);
+        }
+
+        for (size_t i = 0; i < m_outputRegisters.size(); ++i)
+        {
+            memcpy(outputs[i] + first, m_registers.data() + (size_t)m_outputRegisters[i] * BatchSize, n * sizeof(float));
+        }
+    }
+}
+
+} // namespace dataflow
@@ -0,0 +1,66 @@
+#pragma once
+#include "dataflow.h"
+#include <stdint.h>
+#include <vector>
+
+namespace dataflow
+{
+
+///
+/// A numeric graph lowered into a linear instruction tape over a flat register file, evaluated for many samples at once.
+///
+/// std::vector<PortRef> inputs = {{a, 0}};   // unconnected inputs fed per sample, the rest keep their constants
+/// std::vector<PortRef> outputs = {{b, 0}};  // outputs read back, nodes they do not depend on are dropped
+/// Tape tape;
+/// if (tape.Compile(graph, inputs, outputs))
+///     tape.Execute(in, out, count);         // in/out: one array of count floats per component of every port
+///
+/// A register is a row of BatchSize floats holding one component of one port for BatchSize samples, so every
+/// instruction is one call of a kernel's BatchKernelFunction over the whole row. Nodes whose inputs are all constant
+/// are folded at compile time, and a register is reused as soon as the last instruction reading it has run.
+/// Only Float, Vector2 and Vec3 ports can be lowered, and every kernel needs a batch form.
+///
+class Tape
+{
+public:
+    static constexpr uint32_t BatchSize = 256;
+
+private:
+    struct Instruction
+    {
+        BatchKernelFunction Function;
+        uint32_t FirstOperand; // into m_operands, the input registers then the output registers
+        uint32_t InputCount;   // components
+    };
+
+    struct Constant
+    {
+        uint32_t Register;
+        float Value;
+    };
+
+    std::vector<Instruction> m_instructions;
+    std::vector<uint32_t> m_operands;
+    std::vector<float *> m_pointers;     // m_operands resolved into m_registers
+    std::vector<Constant> m_constants;   // registers filled once
+    std::vector<uint32_t> m_inputRegisters;  // per input component
+    std::vector<uint32_t> m_outputRegisters; // per output component
+    std::vector<float> m_registers;      // register r is m_registers[r * BatchSize, (r + 1) * BatchSize)
+    uint32_t m_registerCount = 0;
+    uint32_t m_foldedCount = 0;
+
+public:
+    // Return false if a node on the way to outputs has a port that is not Float/Vector2/Vec3 or a kernel without a
+    // batch form, if an input is connected, or if the graph has a cycle.
+    bool Compile(const Graph &graph, const std::vector<PortRef> &inputs, const std::vector<PortRef> &outputs);
+    void Execute(const float *const *inputs, float *const *outputs, uint32_t count);
+
+    size_t GetInstructionCount() const { return m_instructions.size(); }
+    uint32_t GetRegisterCount() const { return m_registerCount; }
+    uint32_t GetFoldedCount() const { return m_foldedCount; }
+};
+
+// components of a port on the tape, 0 if the type cannot be lowered
+uint32_t ComponentCount(ValueType type);
+
+} // namespace dataflow
@@ -0,0 +1,151 @@
+#include "task_pool.h"
+#include <assert.h>
+
+namespace dataflow
+{
+
+TaskPool::TaskPool(int threadCount)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = (int)std::thread::hardware_concurrency();
+        threadCount = threadCount > 0 ? threadCount : 1;
+    }
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 1; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&TaskPool::ThreadMain, this, i);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (auto &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+bool TaskPool::Pop(int worker, uint32_t &item)
+{
+    Queue &queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+    if (queue.Items.empty())
+    {
+        return false;
+    }
+    item = queue.Items.back();
+    queue.Items.pop_back();
+    return true;
+}
+
+bool TaskPool::Steal(int worker, uint32_t &item)
+{
+    const int count = (int)m_queues.size();
+    for (int i = 1; i < count; ++i)
+    {
+        Queue &queue = *m_queues[(worker + i) % count];
+        std::unique_lock<std::mutex> lock(queue.Mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.Items.empty())
+        {
+            continue; // contended, try the next victim rather than wait
+        }
+        item = queue.Items.front();
+        queue.Items.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void TaskPool::Push(int worker, uint32_t item)
+{
+    Queue &queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+    queue.Items.push_back(item);
+}
+
+void TaskPool::Work(int worker)
+{
+    uint32_t item;
+    while (m_remaining.load(std::memory_order_acquire) != 0)
+    {
+        if (Pop(worker, item) || Steal(worker, item))
+        {
+            (*m_task)(item, worker);
+            // after the task, so the items it pushed are counted before the run can end
+            m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TaskPool::ThreadMain(int worker)
+{
+    uint64_t generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_quit || m_generation != generation; });
+            if (m_quit)
+            {
+                return;
+            }
+            generation = m_generation;
+            m_busy.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // a thread waking after its run ended finds m_remaining at 0 and goes back to sleep
+        Work(worker);
+        m_busy.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void TaskPool::Run(uint32_t itemCount, const uint32_t *roots, size_t rootCount, const Task &task)
+{
+    if (itemCount == 0)
+    {
+        return;
+    }
+    assert(rootCount > 0);
+
+    // published by the release store, a worker reads m_task only after seeing m_remaining != 0 with acquire. a thread
+    // woken late for an earlier run can get here without taking m_mutex after this store
+    m_task = &task;
+    m_remaining.store(itemCount, std::memory_order_release);
+    for (size_t i = 0; i < rootCount; ++i)
+    {
+        Push((int)(i % m_queues.size()), roots[i]);
+    }
+
+    if (!m_threads.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_generation;
+        }
+        m_wake.notify_all();
+    }
+
+    Work(0);
+
+    // task is the caller's, no thread may still be reading it once we return
+    while (m_busy.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace dataflow
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace dataflow
+{
+
+///
+/// Work-stealing pool for many small dependent tasks, each identified by a uint32_t.
+///
+/// Every worker owns a deque. It pushes and pops its own tasks at the back (depth first, the inputs a task just
+/// produced are still in cache) and, once empty, steals from the front of the others'. The thread calling Run() is
+/// worker 0, the other threads sleep between runs.
+///
+class TaskPool
+{
+public:
+    using Task = std::function<void(uint32_t item, int worker)>;
+
+private:
+    struct alignas(64) Queue
+    {
+        std::mutex Mutex;
+        std::deque<uint32_t> Items;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues; // per worker
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    uint64_t m_generation = 0; // bumped by every Run()
+    bool m_quit = false;
+
+    const Task *m_task = nullptr;
+    std::atomic<uint32_t> m_remaining{0}; // items of the current run not finished yet
+    std::atomic<int> m_busy{0};           // threads inside the current run
+
+    bool Pop(int worker, uint32_t &item);
+    bool Steal(int worker, uint32_t &item);
+    void Work(int worker);
+    void ThreadMain(int worker);
+
+public:
+    // 0 = one worker per hardware thread
+    explicit TaskPool(int threadCount = 0);
+    ~TaskPool();
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    int GetThreadCount() const { return (int)m_queues.size(); }
+
+    // Run task on the roots and on everything the tasks push, return once itemCount tasks have finished.
+    void Run(uint32_t itemCount, const uint32_t *roots, size_t rootCount, const Task &task);
+    // Queue item on the calling worker, from inside a task only.
+    void Push(int worker, uint32_t item);
+};
+
+} // namespace dataflow
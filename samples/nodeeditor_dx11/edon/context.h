@@ -1,4 +1,5 @@
 #pragma once
+#include "../nodegraph/node_pool.h"
 
 namespace edon
 {
@@ -6,12 +7,12 @@ namespace edon
 struct Context
 {
     bool open_context_menu = false;
-    int node_hovered_in_list = -1;
-    int node_hovered_in_scene = -1;
+    nodegraph::NodeHandle node_hovered_in_list;
+    nodegraph::NodeHandle node_hovered_in_scene;
 
-    bool IsHovered(int ID) const
+    bool IsHovered(nodegraph::NodeHandle node) const
     {
-        return node_hovered_in_list == ID || node_hovered_in_scene == ID;
+        return node_hovered_in_list == node || node_hovered_in_scene == node;
     }
 };
 
@@ -1,23 +1,33 @@
 #include "imgui_node_graph_test.h"
 #include "context.h"
 #include "node.h"
+#include "../nodegraph/node_pool.h"
 #include <imgui.h>
 #include <plog/Log.h>
+#include <algorithm>
+#include <float.h>
 #include <vector>
 
 const float MIN_SCALING = 0.3f;
 const float MAX_SCALING = 2.0f;
 
+// an edge from an output slot to an input slot, its endpoints are kept by the NodePool
 struct NodeLink
 {
-    int InputIdx, InputSlot, OutputIdx, OutputSlot;
+    // bounds of the curve's control polygon relative to the canvas origin, rebuilt when an endpoint moves
+    ImVec2 HullFrom = ImVec2(FLT_MAX, FLT_MAX), HullTo = ImVec2(FLT_MAX, FLT_MAX);
+    ImVec2 HullMin, HullMax;
 
-    NodeLink(int input_idx, int input_slot, int output_idx, int output_slot)
+    void UpdateHull(const ImVec2 &from, const ImVec2 &to, float tangent)
     {
-        InputIdx = input_idx;
-        InputSlot = input_slot;
-        OutputIdx = output_idx;
-        OutputSlot = output_slot;
+        if (from.x == HullFrom.x && from.y == HullFrom.y && to.x == HullTo.x && to.y == HullTo.y)
+        {
+            return;
+        }
+        HullFrom = from;
+        HullTo = to;
+        HullMin = ImVec2(std::min(from.x, to.x - tangent), std::min(from.y, to.y));
+        HullMax = ImVec2(std::max(from.x + tangent, to.x), std::max(from.y, to.y));
     }
 };
 
@@ -34,21 +44,27 @@ namespace edon
 {
 class Nodes
 {
-    std::vector<Node> m_nodes;
-    std::vector<NodeLink> m_links;
+    nodegraph::NodePool<Node, NodeLink> m_nodes;
     ImVec2 m_scrolling = ImVec2(0.0f, 0.0f);
     float m_scaling = 1.0f;
     bool m_show_grid = true;
-    int m_node_selected = -1;
+    nodegraph::NodeHandle m_node_selected;
 
 public:
     Nodes()
     {
-        m_nodes.push_back(Node(0, "MainTex", std::array<float, 2>{40, 50}, 0.5f, ImColor(255, 100, 100), 1, 1));
-        m_nodes.push_back(Node(1, "BumpMap", std::array<float, 2>{40, 150}, 0.42f, ImColor(200, 100, 200), 1, 1));
-        m_nodes.push_back(Node(2, "Combine", std::array<float, 2>{270, 80}, 1.0f, ImColor(0, 200, 100), 2, 2));
-        m_links.push_back(NodeLink(0, 0, 2, 0));
-        m_links.push_back(NodeLink(1, 0, 2, 1));
+        auto main_tex = AddNode("MainTex", std::array<float, 2>{40, 50}, 0.5f, ImColor(255, 100, 100), 1, 1);
+        auto bump_map = AddNode("BumpMap", std::array<float, 2>{40, 150}, 0.42f, ImColor(200, 100, 200), 1, 1);
+        auto combine = AddNode("Combine", std::array<float, 2>{270, 80}, 1.0f, ImColor(0, 200, 100), 2, 2);
+        m_nodes.Connect(main_tex, 0, combine, 0);
+        m_nodes.Connect(bump_map, 0, combine, 1);
+    }
+
+    nodegraph::NodeHandle AddNode(const char *name, const std::array<float, 2> &pos, float value, const ImVec4 &color, int inputs_count, int outputs_count)
+    {
+        auto handle = m_nodes.AddNode(Node(name, pos, value, color, inputs_count, outputs_count));
+        m_nodes.Get(handle)->m_handle = handle;
+        return handle;
     }
 
     void ShowLeftPanel(Context *context)
@@ -58,9 +74,9 @@ public:
         ImGui::Text("Nodes");
         ImGui::Separator();
 
-        for (auto &node : m_nodes)
+        for (uint32_t i = 0; i < m_nodes.GetNodeCount(); ++i)
         {
-            node.DrawLeftPanel(&m_node_selected, context);
+            m_nodes.GetNodeAt(i).DrawLeftPanel(&m_node_selected, context);
         }
         ImGui::EndChild();
     }
@@ -86,15 +102,15 @@ public:
     {
         if (!ImGui::IsAnyItemHovered() && ImGui::IsWindowHovered() && ImGui::IsMouseClicked(1))
         {
-            m_node_selected = context->node_hovered_in_list = context->node_hovered_in_scene = -1;
+            m_node_selected = context->node_hovered_in_list = context->node_hovered_in_scene = nodegraph::NodeHandle();
             context->open_context_menu = true;
         }
         if (context->open_context_menu)
         {
             ImGui::OpenPopup("context_menu");
-            if (context->node_hovered_in_list != -1)
+            if (!context->node_hovered_in_list.IsNull())
                 m_node_selected = context->node_hovered_in_list;
-            if (context->node_hovered_in_scene != -1)
+            if (!context->node_hovered_in_scene.IsNull())
                 m_node_selected = context->node_hovered_in_scene;
         }
 
@@ -102,7 +118,9 @@ public:
         ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(8, 8));
         if (ImGui::BeginPopup("context_menu"))
         {
-            Node *node = m_node_selected != -1 ? &m_nodes[m_node_selected] : NULL;
+            // a stale handle finds nothing
+            auto handle = m_node_selected;
+            Node *node = m_nodes.Get(handle);
             ImVec2 scene_pos = ImGui::GetMousePosOnOpeningCurrentPopup() - offset;
             if (node)
             {
@@ -111,8 +129,11 @@ public:
                 if (ImGui::MenuItem("Rename..", NULL, false, false))
                 {
                 }
-                if (ImGui::MenuItem("Delete", NULL, false, false))
+                if (ImGui::MenuItem("Delete"))
                 {
+                    // drops its links too
+                    m_nodes.RemoveNode(handle);
+                    m_node_selected = nodegraph::NodeHandle();
                 }
                 if (ImGui::MenuItem("Copy", NULL, false, false))
                 {
@@ -122,7 +143,7 @@ public:
             {
                 if (ImGui::MenuItem("Add"))
                 {
-                    m_nodes.push_back(Node((int)m_nodes.size(), "New node", std::array<float, 2>{scene_pos.x, scene_pos.y}, 0.5f, ImColor(100, 100, 200), 2, 2));
+                    AddNode("New node", std::array<float, 2>{scene_pos.x, scene_pos.y}, 0.5f, ImColor(100, 100, 200), 2, 2);
                 }
                 if (ImGui::MenuItem("Paste", NULL, false, false))
                 {
@@ -156,6 +177,14 @@ public:
 
         ImDrawList *draw_list = ImGui::GetWindowDrawList();
 
+        // only nodes and links overlapping the canvas are submitted to the draw list
+        ImVec2 clip_min = ImGui::GetWindowPos();
+        ImVec2 clip_max = clip_min + ImGui::GetWindowSize();
+
+        // zoomed out nodes drop their widgets, links are decimated to a few segments
+        NodeDetail detail = GetNodeDetail();
+        int link_segments = detail == NodeDetail::Full ? 0 : (detail == NodeDetail::Header ? 8 : 4);
+
         // Display grid
         if (m_show_grid)
         {
@@ -166,20 +195,31 @@ public:
             draw_list->ChannelsSplit(2);
             draw_list->ChannelsSetCurrent(0); // Background
             // Display links
-            for (auto &link : m_links)
+            for (uint32_t i = 0; i < m_nodes.GetEdgeCount(); ++i)
             {
-                Node *node_inp = &m_nodes[link.InputIdx];
-                Node *node_out = &m_nodes[link.OutputIdx];
-                ImVec2 p1 = offset + node_inp->GetOutputSlotPos(link.InputSlot, m_scaling);
-                ImVec2 p2 = offset + node_out->GetInputSlotPos(link.OutputSlot, m_scaling);
-                draw_list->AddBezierCurve(p1, p1 + ImVec2(+50, 0), p2 + ImVec2(-50, 0), p2, IM_COL32(200, 200, 100, 255), 3.0f * m_scaling);
+                auto &edge = m_nodes.GetEdgeAt(i);
+                NodeLink &link = edge.Data;
+                const Node *node_inp = m_nodes.Get(edge.From);
+                const Node *node_out = m_nodes.Get(edge.To);
+                link.UpdateHull(node_inp->GetOutputSlotPos(edge.Output, m_scaling), node_out->GetInputSlotPos(edge.Input, m_scaling), 50.0f);
+                if (!ImRect(offset + link.HullMin, offset + link.HullMax).Overlaps(ImRect(clip_min, clip_max)))
+                {
+                    continue;
+                }
+                ImVec2 p1 = offset + link.HullFrom;
+                ImVec2 p2 = offset + link.HullTo;
+                draw_list->AddBezierCurve(p1, p1 + ImVec2(+50, 0), p2 + ImVec2(-50, 0), p2, IM_COL32(200, 200, 100, 255), 3.0f * m_scaling, link_segments);
             }
 
             // Display nodes
-            for (auto &node : m_nodes)
+            for (uint32_t i = 0; i < m_nodes.GetNodeCount(); ++i)
             {
+                Node &node = m_nodes.GetNodeAt(i);
                 // move, draw
-                node.Process(draw_list, offset, context, &m_node_selected, m_scaling);
+                if (node.IsVisible(offset, clip_min, clip_max, m_scaling))
+                {
+                    node.Process(draw_list, offset, context, &m_node_selected, m_scaling, detail);
+                }
             }
             draw_list->ChannelsMerge();
         }
@@ -247,7 +287,6 @@ public:
 } // namespace edon
 
 // Really dumb data structure provided for the example.
-// Note that we storing links are INDICES (not ID) to make example code shorter, obviously a bad idea for any general purpose code.
 void ShowExampleAppCustomNodeGraph(bool *opened)
 {
     static edon::Nodes s_nodes;
@@ -6,8 +6,22 @@ const float NODE_SLOT_RADIUS = 4.0f;
 
 namespace edon
 {
-Node::Node(int id, const char *name, const std::array<float, 2> &pos, float value, const ImVec4 &color, int inputs_count, int outputs_count)
-    : m_id(id), m_name(name), m_pos(pos)
+NodeDetail GetNodeDetail()
+{
+    const float text_height = ImGui::GetFontSize();
+    if (text_height >= 8.0f)
+    {
+        return NodeDetail::Full;
+    }
+    if (text_height >= 5.0f)
+    {
+        return NodeDetail::Header;
+    }
+    return NodeDetail::Rect;
+}
+
+Node::Node(const char *name, const std::array<float, 2> &pos, float value, const ImVec4 &color, int inputs_count, int outputs_count)
+    : m_name(name), m_pos(pos)
 {
     Value = value;
     Color = color;
@@ -15,9 +29,9 @@ Node::Node(int id, const char *name, const std::array<float, 2> &pos, float valu
     OutputsCount = outputs_count;
 }
 
-ImColor Node::GetBGColor(const Context &context, int node_selected) const
+ImColor Node::GetBGColor(const Context &context, nodegraph::NodeHandle node_selected) const
 {
-    if (context.IsHovered(m_id) || (context.node_hovered_in_list == -1 && node_selected == m_id))
+    if (context.IsHovered(m_handle) || (context.node_hovered_in_list.IsNull() && node_selected == m_handle))
     {
         return IM_COL32(75, 75, 75, 255);
     }
@@ -27,52 +41,85 @@ ImColor Node::GetBGColor(const Context &context, int node_selected) const
     }
 }
 
-void Node::DrawLeftPanel(int *node_selected, Context *context)
+void Node::DrawLeftPanel(nodegraph::NodeHandle *node_selected, Context *context)
 {
-    ImGui::PushID(m_id);
-    if (ImGui::Selectable(m_name.c_str(), m_id == *node_selected))
+    PushID();
+    if (ImGui::Selectable(m_name.c_str(), m_handle == *node_selected))
     {
-        *node_selected = m_id;
+        *node_selected = m_handle;
     }
     if (ImGui::IsItemHovered())
     {
-        context->node_hovered_in_list = m_id;
+        context->node_hovered_in_list = m_handle;
         (context->open_context_menu) |= ImGui::IsMouseClicked(1);
     }
     ImGui::PopID();
 }
 
+bool Node::IsVisible(const ImVec2 &offset, const ImVec2 &clip_min, const ImVec2 &clip_max, float scaling) const
+{
+    // not laid out yet, it has to be drawn once to get its size
+    if (m_size[0] == 0.0f || m_size[1] == 0.0f)
+    {
+        return true;
+    }
+    ImVec2 node_rect_min = offset + *(ImVec2 *)&m_pos * scaling;
+    ImVec2 node_rect_max = node_rect_min + *(ImVec2 *)&m_size * (scaling / m_size_scaling);
+    return ImRect(node_rect_min, node_rect_max).Overlaps(ImRect(clip_min, clip_max));
+}
+
 ImVec2 Node::GetInputSlotPos(int slot_no, float scaling) const
 {
-    return ImVec2(m_pos[0] * scaling, m_pos[1] * scaling + m_size[1] * ((float)slot_no + 1) / ((float)InputsCount + 1));
+    // m_size may have been laid out at another scaling
+    const float size_y = m_size[1] * (scaling / m_size_scaling);
+    return ImVec2(m_pos[0] * scaling, m_pos[1] * scaling + size_y * ((float)slot_no + 1) / ((float)InputsCount + 1));
 }
 
 ImVec2 Node::GetOutputSlotPos(int slot_no, float scaling) const
 {
-    return ImVec2(m_pos[0] * scaling + m_size[0], m_pos[1] * scaling + m_size[1] * ((float)slot_no + 1) / ((float)OutputsCount + 1));
+    const float size_x = m_size[0] * (scaling / m_size_scaling);
+    const float size_y = m_size[1] * (scaling / m_size_scaling);
+    return ImVec2(m_pos[0] * scaling + size_x, m_pos[1] * scaling + size_y * ((float)slot_no + 1) / ((float)OutputsCount + 1));
 }
 
-void Node::Process(ImDrawList *draw_list, const ImVec2 &offset, Context *context, int *node_selected, float scaling)
+void Node::Process(ImDrawList *draw_list, const ImVec2 &offset, Context *context, nodegraph::NodeHandle *node_selected, float scaling, NodeDetail detail)
 {
     // Node *node = &nodes[node_idx];
-    ImGui::PushID(m_id);
+    PushID();
     ImVec2 node_rect_min = offset + *(ImVec2 *)&m_pos * scaling;
 
-    // Display node contents first
-    draw_list->ChannelsSetCurrent(1); // Foreground
-    bool old_any_active = ImGui::IsAnyItemActive();
-    ImGui::SetCursorScreenPos(node_rect_min + NODE_WINDOW_PADDING);
-    ImGui::BeginGroup(); // Lock horizontal position
-    ImGui::Text("%s", m_name.c_str());
-    ImGui::SliderFloat("##value", &Value, 0.0f, 1.0f, "Alpha %.2f");
-    ImGui::ColorEdit3("##color", &Color.x);
-    ImGui::EndGroup();
-
-    // Save the size of what we have emitted and whether any of the widgets are being used
-    bool node_widgets_active = (!old_any_active && ImGui::IsAnyItemActive());
-    auto size = ImGui::GetItemRectSize() + NODE_WINDOW_PADDING + NODE_WINDOW_PADDING;
-    m_size[0] = size.x;
-    m_size[1] = size.y;
+    // a node is laid out once at full detail to get a size
+    if (m_size[0] == 0.0f)
+    {
+        detail = NodeDetail::Full;
+    }
+
+    bool node_widgets_active = false;
+    ImVec2 size;
+    if (detail == NodeDetail::Full)
+    {
+        // Display node contents first
+        draw_list->ChannelsSetCurrent(1); // Foreground
+        bool old_any_active = ImGui::IsAnyItemActive();
+        ImGui::SetCursorScreenPos(node_rect_min + NODE_WINDOW_PADDING);
+        ImGui::BeginGroup(); // Lock horizontal position
+        ImGui::Text("%s", m_name.c_str());
+        ImGui::SliderFloat("##value", &Value, 0.0f, 1.0f, "Alpha %.2f");
+        ImGui::ColorEdit3("##color", &Color.x);
+        ImGui::EndGroup();
+
+        // Save the size of what we have emitted and whether any of the widgets are being used
+        node_widgets_active = (!old_any_active && ImGui::IsAnyItemActive());
+        size = ImGui::GetItemRectSize() + NODE_WINDOW_PADDING + NODE_WINDOW_PADDING;
+        m_size[0] = size.x;
+        m_size[1] = size.y;
+        m_size_scaling = scaling;
+    }
+    else
+    {
+        // the widgets would be sub-pixel, keep the size they were last laid out at
+        size = *(ImVec2 *)&m_size * (scaling / m_size_scaling);
+    }
     ImVec2 node_rect_max = node_rect_min + size;
 
     // Display node box
@@ -81,12 +128,12 @@ void Node::Process(ImDrawList *draw_list, const ImVec2 &offset, Context *context
     ImGui::InvisibleButton("node", size);
     if (ImGui::IsItemHovered())
     {
-        context->node_hovered_in_scene = m_id;
+        context->node_hovered_in_scene = m_handle;
         context->open_context_menu |= ImGui::IsMouseClicked(1);
     }
     bool node_moving_active = ImGui::IsItemActive();
     if (node_widgets_active || node_moving_active)
-        *node_selected = m_id;
+        *node_selected = m_handle;
     if (node_moving_active && ImGui::IsMouseDragging(0))
     {
         m_pos[0] += ImGui::GetIO().MouseDelta[0] / scaling;
@@ -94,15 +141,30 @@ void Node::Process(ImDrawList *draw_list, const ImVec2 &offset, Context *context
     }
 
     ImU32 node_bg_color = GetBGColor(*context, *node_selected);
+    if (detail == NodeDetail::Rect)
+    {
+        draw_list->AddRectFilled(node_rect_min, node_rect_max, node_bg_color);
+        ImGui::PopID();
+        return;
+    }
+
     draw_list->AddRectFilled(node_rect_min, node_rect_max, node_bg_color, 4.0f);
+    if (detail == NodeDetail::Header)
+    {
+        // stands in for the name line
+        ImVec2 header_max(node_rect_max.x, node_rect_min.y + NODE_WINDOW_PADDING.y + ImGui::GetFontSize());
+        draw_list->AddRectFilled(node_rect_min, header_max, ImColor(Color), 4.0f, ImDrawCornerFlags_Top);
+    }
     draw_list->AddRect(node_rect_min, node_rect_max, IM_COL32(100, 100, 100, 255), 4.0f);
+
+    const int slot_segments = detail == NodeDetail::Full ? 12 : 4;
     for (int slot_idx = 0; slot_idx < InputsCount; slot_idx++)
     {
-        draw_list->AddCircleFilled(offset + GetInputSlotPos(slot_idx, scaling), NODE_SLOT_RADIUS, IM_COL32(150, 150, 150, 150));
+        draw_list->AddCircleFilled(offset + GetInputSlotPos(slot_idx, scaling), NODE_SLOT_RADIUS, IM_COL32(150, 150, 150, 150), slot_segments);
     }
     for (int slot_idx = 0; slot_idx < OutputsCount; slot_idx++)
     {
-        draw_list->AddCircleFilled(offset + GetOutputSlotPos(slot_idx, scaling), NODE_SLOT_RADIUS, IM_COL32(150, 150, 150, 150));
+        draw_list->AddCircleFilled(offset + GetOutputSlotPos(slot_idx, scaling), NODE_SLOT_RADIUS, IM_COL32(150, 150, 150, 150), slot_segments);
     }
 
     ImGui::PopID();
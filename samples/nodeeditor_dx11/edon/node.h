@@ -1,4 +1,5 @@
 #pragma once
+#include "../nodegraph/node_pool.h"
 #include <imgui.h>
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui_internal.h>
@@ -8,28 +9,46 @@
 namespace edon
 {
 
+// level of detail, text and widgets are sub-pixel well before MIN_SCALING
+enum class NodeDetail
+{
+    Full,   // text and widgets
+    Header, // node color header and slot dots
+    Rect,   // a single filled rect
+};
+// from the on-screen text height, call inside the scaled canvas
+NodeDetail GetNodeDetail();
+
 struct Context;
 struct Node
 {
-    int m_id;
+    nodegraph::NodeHandle m_handle; // set by Nodes::AddNode, the ImGui id and what selection refers to
     std::string m_name;
     std::array<float, 2> m_pos;
-    std::array<float, 2> m_size;
+    std::array<float, 2> m_size = {0.0f, 0.0f}; // screen pixels, as laid out by the last Process
+    float m_size_scaling = 1.0f;                 // scaling m_size was laid out at
 
     float Value;
     ImVec4 Color;
     int InputsCount, OutputsCount;
 
-    Node(int id, const char *name, const std::array<float, 2> &pos, float value, const ImVec4 &color, int inputs_count, int outputs_count);
+    Node(const char *name, const std::array<float, 2> &pos, float value, const ImVec4 &color, int inputs_count, int outputs_count);
 
-    ImColor GetBGColor(const Context &context, int node_selected) const;
+    ImColor GetBGColor(const Context &context, nodegraph::NodeHandle node_selected) const;
 
-    void DrawLeftPanel(int *node_selected, Context *context);
+    void DrawLeftPanel(nodegraph::NodeHandle *node_selected, Context *context);
+
+    // node rect overlaps [clip_min, clip_max] (screen space). a node never laid out has no size and is visible
+    // while its position is.
+    bool IsVisible(const ImVec2 &offset, const ImVec2 &clip_min, const ImVec2 &clip_max, float scaling) const;
 
     ImVec2 GetInputSlotPos(int slot_no, float scaling) const;
     ImVec2 GetOutputSlotPos(int slot_no, float scaling) const;
 
-    void Process(ImDrawList *draw_list, const ImVec2 &offset, Context *context, int *node_selected, float scaling);
+    // the handle's slot and generation, a node added in a removed node's slot gets a new id
+    void PushID() const { ImGui::PushID((const char *)&m_handle, (const char *)(&m_handle + 1)); }
+
+    void Process(ImDrawList *draw_list, const ImVec2 &offset, Context *context, nodegraph::NodeHandle *node_selected, float scaling, NodeDetail detail);
 };
 
 } // namespace edon
\ No newline at end of file
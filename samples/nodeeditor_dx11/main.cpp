@@ -1,9 +1,13 @@
-#include "win32_window.h"
+#include <Win32Window.h>
 #include "dx11_context.h"
 #include "dx11_renderer.h"
 #include "orbit_camera.h"
+#include <frame_telemetry.h>
+#include <telemetry_window.h>
 #include <plog/Log.h>
 #include <plog/Appenders/DebugOutputAppender.h>
+#include <plog/Formatters/TxtFormatter.h>
+#include <plog/Init.h>
 
 #include <imgui.h>
 #include <imgui_impl_win32.h>
@@ -18,12 +22,13 @@ int main(int argc, char **argv)
     static plog::DebugOutputAppender<plog::TxtFormatter> debugOutputAppender;
     plog::init(plog::verbose, &debugOutputAppender);
 
-    Win32Window window;
-    auto hwnd = window.Create(640, 480, L"im3d_minimum_dx11");
+    screenstate::Win32Window window(L"nodeeditor_dx11 class");
+    auto hwnd = window.Create(L"nodeeditor_dx11", 640, 480);
     if (!hwnd)
     {
         return 1;
     }
+    window.Show();
 
     DX11Context dx11;
     auto device = dx11.Create(hwnd);
@@ -47,31 +52,71 @@ int main(int argc, char **argv)
     auto world = amth::IdentityMatrix();
     OrbitCamera camera;
 
-    // spacechase0::Graph nodeGraph;
+    spacechase0::Graph nodeGraph;
+    bool show_spacechase0_window = true;
     ChemiaAion::Nodes chemia_nodes;
 
-    while (window.IsRunning())
+    // collected only while the window is shown
+    FrameTelemetry telemetry;
+    bool show_telemetry_window = true;
+
+    // window state and mouse input
+    screenstate::ScreenState windowState;
+    while (window.Update(&windowState))
     {
-        // get window state and mouse input
-        auto &windowState = window.GetState();
+        telemetry.SetEnabled(show_telemetry_window);
+        telemetry.BeginFrame();
 
         // Start the Dear ImGui frame
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
-        io.MouseDown[0] = (int)windowState.Mouse.IsDown(ButtonFlags::Left);
-        io.MouseDown[1] = (int)windowState.Mouse.IsDown(ButtonFlags::Right);
-        io.MouseDown[2] = (int)windowState.Mouse.IsDown(ButtonFlags::Middle);
-        io.MouseWheel = (float)windowState.Mouse.Wheel;
+        io.MouseDown[0] = windowState.Has(screenstate::MouseButtonFlags::LeftDown);
+        io.MouseDown[1] = windowState.Has(screenstate::MouseButtonFlags::RightDown);
+        io.MouseDown[2] = windowState.Has(screenstate::MouseButtonFlags::MiddleDown);
+        if (windowState.Has(screenstate::MouseButtonFlags::WheelMinus))
+        {
+            io.MouseWheel = -1;
+        }
+        else if (windowState.Has(screenstate::MouseButtonFlags::WheelPlus))
+        {
+            io.MouseWheel = 1;
+        }
         ImGui::NewFrame();
 
         // camera update
-        if (!ImGui::IsAnyWindowHovered())
+        if (!io.WantCaptureMouse)
         {
-            camera.WindowInput(windowState);
+            camera.WindowInput(windowState, window.FrameEvents());
         }
+        telemetry.Mark(FramePhase::Input);
 
-        // nodeGraph.update();
+        // closed windows are reopened from here
+        if (ImGui::BeginMainMenuBar())
+        {
+            if (ImGui::BeginMenu("Windows"))
+            {
+                ImGui::MenuItem("frame telemetry", nullptr, &show_telemetry_window);
+                ImGui::MenuItem("spacechase0", nullptr, &show_spacechase0_window);
+                ImGui::EndMenu();
+            }
+            ImGui::EndMainMenuBar();
+        }
+        if (show_telemetry_window)
+        {
+            ShowTelemetryWindow(telemetry, &show_telemetry_window);
+        }
+
+        if (show_spacechase0_window)
+        {
+            if (ImGui::Begin("spacechase0", &show_spacechase0_window))
+            {
+                nodeGraph.update();
+                nodeGraph.evaluate();
+            }
+            ImGui::End();
+        }
         chemia_nodes.ProcessNodes();
+        telemetry.Mark(FramePhase::ImGuiUser);
 
         // static bool showNodeGraph = true;
         // ShowExampleAppCustomNodeGraph(&showNodeGraph);
@@ -84,14 +129,20 @@ int main(int argc, char **argv)
 
         // use manipulated world
         renderer.DrawTeapot(deviceContext, camera.state.viewProjection.data(), world.data());
+        telemetry.Mark(FramePhase::DrawTeapot);
 
         // imgui Rendering
         ImGui::Render();
         ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+        telemetry.Mark(FramePhase::ImGuiRender);
 
         // transfer backbuffer
         dx11.Present();
+        telemetry.Mark(FramePhase::Present);
+        telemetry.EndFrame();
     }
 
+    ImGui_ImplDX11_Shutdown();
+
     return 0;
 }
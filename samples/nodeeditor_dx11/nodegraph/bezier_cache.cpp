@@ -0,0 +1,114 @@
+#include "bezier_cache.h"
+#include <algorithm>
+#if NODEGRAPH_SIMD
+#include <emmintrin.h>
+#endif
+
+namespace nodegraph
+{
+
+namespace
+{
+// cubic Bernstein weights of the Segments + 1 samples, endpoints included
+struct BezierWeights
+{
+    float X[BezierCache::Segments + 1];
+    float Y[BezierCache::Segments + 1];
+    float Z[BezierCache::Segments + 1];
+    float W[BezierCache::Segments + 1];
+
+    constexpr BezierWeights() : X(), Y(), Z(), W()
+    {
+        for (int i = 0; i <= BezierCache::Segments; ++i)
+        {
+            float t = (float)i / (float)BezierCache::Segments;
+            float u = 1.0f - t;
+            X[i] = u * u * u;
+            Y[i] = 3 * u * u * t;
+            Z[i] = 3 * u * t * t;
+            W[i] = t * t * t;
+        }
+    }
+};
+constexpr BezierWeights Weights;
+} // namespace
+
+void BezierCache::Update(const ImVec2 &from, const ImVec2 &to, float tangent)
+{
+    if (from.x == m_from.x && from.y == m_from.y && to.x == m_to.x && to.y == m_to.y)
+    {
+        return;
+    }
+    m_from = from;
+    m_to = to;
+
+    const ImVec2 p2(from.x + tangent, from.y);
+    const ImVec2 p3(to.x - tangent, to.y);
+
+    m_min = ImVec2(FLT_MAX, FLT_MAX);
+    m_max = ImVec2(-FLT_MAX, -FLT_MAX);
+    for (int i = 0; i <= Segments; ++i)
+    {
+        m_x[i] = Weights.X[i] * from.x + Weights.Y[i] * p2.x + Weights.Z[i] * p3.x + Weights.W[i] * to.x;
+        m_y[i] = Weights.X[i] * from.y + Weights.Y[i] * p2.y + Weights.Z[i] * p3.y + Weights.W[i] * to.y;
+        m_min = ImVec2(std::min(m_min.x, m_x[i]), std::min(m_min.y, m_y[i]));
+        m_max = ImVec2(std::max(m_max.x, m_x[i]), std::max(m_max.y, m_y[i]));
+    }
+
+    for (int i = 0; i < Segments; ++i)
+    {
+        m_dx[i] = m_x[i + 1] - m_x[i];
+        m_dy[i] = m_y[i + 1] - m_y[i];
+        const float length2 = m_dx[i] * m_dx[i] + m_dy[i] * m_dy[i];
+        m_invLength2[i] = length2 > 0.0f ? 1.0f / length2 : 0.0f;
+    }
+}
+
+float BezierCache::GetSquaredDistance(const ImVec2 &point, float maxDistance) const
+{
+    if (point.x < m_min.x - maxDistance || point.y < m_min.y - maxDistance || point.x > m_max.x + maxDistance ||
+        point.y > m_max.y + maxDistance)
+    {
+        return FLT_MAX;
+    }
+
+#if NODEGRAPH_SIMD
+    // written out rather than left to the auto vectorizer, which needs -fno-trapping-math or /fp:fast for the clamp
+    const __m128 pointX = _mm_set1_ps(point.x);
+    const __m128 pointY = _mm_set1_ps(point.y);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 minDistance2 = _mm_set1_ps(FLT_MAX);
+    for (int i = 0; i < Segments; i += 4)
+    {
+        const __m128 dx = _mm_load_ps(m_dx + i);
+        const __m128 dy = _mm_load_ps(m_dy + i);
+        const __m128 px = _mm_sub_ps(pointX, _mm_load_ps(m_x + i));
+        const __m128 py = _mm_sub_ps(pointY, _mm_load_ps(m_y + i));
+
+        __m128 t = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(px, dx), _mm_mul_ps(py, dy)), _mm_load_ps(m_invLength2 + i));
+        t = _mm_min_ps(_mm_max_ps(t, zero), one);
+
+        const __m128 ex = _mm_sub_ps(px, _mm_mul_ps(t, dx));
+        const __m128 ey = _mm_sub_ps(py, _mm_mul_ps(t, dy));
+        minDistance2 = _mm_min_ps(minDistance2, _mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)));
+    }
+    minDistance2 = _mm_min_ps(minDistance2, _mm_shuffle_ps(minDistance2, minDistance2, _MM_SHUFFLE(2, 3, 0, 1)));
+    minDistance2 = _mm_min_ps(minDistance2, _mm_shuffle_ps(minDistance2, minDistance2, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(minDistance2);
+#else
+    float minDistance2 = FLT_MAX;
+    for (int i = 0; i < Segments; ++i)
+    {
+        const float px = point.x - m_x[i];
+        const float py = point.y - m_y[i];
+        const float t = std::min(std::max((px * m_dx[i] + py * m_dy[i]) * m_invLength2[i], 0.0f), 1.0f);
+        const float ex = px - t * m_dx[i];
+        const float ey = py - t * m_dy[i];
+        minDistance2 = std::min(minDistance2, ex * ex + ey * ey);
+    }
+    return minDistance2;
+#endif
+}
+
+} // namespace nodegraph
@@ -0,0 +1,76 @@
+#pragma once
+#include <imgui.h>
+#include <cfloat>
+
+///
+/// Link curve cache shared by the editors.
+///
+/// BezierCache curve;                                  // one per link, canvas space
+/// curve.Update(from, to, 50.0f);                      // every frame, a compare unless an endpoint moved
+/// if (!curve.Overlaps(clipMin, clipMax)) continue;    // cull with the polyline bounds
+/// float d2 = curve.GetSquaredDistance(mouse, 5.0f);   // hover test, FLT_MAX outside the bounds
+/// for (int i = 0; i <= BezierCache::Segments; ++i)    // draw the same polyline
+///     points[i] = offset + curve.GetPoint(i);
+///
+/// The curve runs from -> to with horizontal tangents and is tessellated into Segments segments once, then rebuilt
+/// only when an endpoint moves. Samples and segments are kept as structure of arrays so the distance test runs four
+/// segments at a time with SSE (NODEGRAPH_SIMD 0 forces the scalar loop).
+///
+
+#ifndef NODEGRAPH_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NODEGRAPH_SIMD 1
+#else
+#define NODEGRAPH_SIMD 0
+#endif
+#endif
+
+namespace nodegraph
+{
+
+class BezierCache
+{
+public:
+    static constexpr int Segments = 24;
+    static_assert(Segments % 4 == 0, "the distance loop takes 4 segments at a time");
+
+private:
+    ImVec2 m_from = ImVec2(FLT_MAX, FLT_MAX);
+    ImVec2 m_to = ImVec2(FLT_MAX, FLT_MAX);
+
+    // polyline bounds
+    ImVec2 m_min;
+    ImVec2 m_max;
+
+    // samples
+    alignas(16) float m_x[Segments + 1];
+    alignas(16) float m_y[Segments + 1];
+
+    // per segment: direction and 1 / squared length (0 for a degenerate segment)
+    alignas(16) float m_dx[Segments];
+    alignas(16) float m_dy[Segments];
+    alignas(16) float m_invLength2[Segments];
+
+public:
+    void Update(const ImVec2 &from, const ImVec2 &to, float tangent);
+
+    ImVec2 GetPoint(int i) const { return ImVec2(m_x[i], m_y[i]); }
+
+    bool Overlaps(const ImVec2 &min, const ImVec2 &max) const
+    {
+        return m_min.x <= max.x && m_min.y <= max.y && m_max.x >= min.x && m_max.y >= min.y;
+    }
+
+    // squared distance from point to the polyline, FLT_MAX if point is further than maxDistance from the bounds
+    float GetSquaredDistance(const ImVec2 &point, float maxDistance) const;
+
+    // same for a screen space point and maxDistance, with the curve drawn at offset + sample * scale
+    float GetSquaredScreenDistance(const ImVec2 &point, const ImVec2 &offset, float scale, float maxDistance) const
+    {
+        const ImVec2 canvasPoint((point.x - offset.x) / scale, (point.y - offset.y) / scale);
+        const float distanceSquared = GetSquaredDistance(canvasPoint, maxDistance / scale);
+        return distanceSquared == FLT_MAX ? FLT_MAX : distanceSquared * scale * scale;
+    }
+};
+
+} // namespace nodegraph
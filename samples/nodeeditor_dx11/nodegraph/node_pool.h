@@ -0,0 +1,396 @@
+#pragma once
+#include <algorithm>
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+///
+/// Node and edge storage shared by the editors.
+///
+/// NodePool<MyNode, MyLink> pool;
+/// NodeHandle a = pool.AddNode(MyNode{...}), b = pool.AddNode(MyNode{...});
+/// EdgeHandle e = pool.Connect(a, 0, b, 1);
+/// pool.RemoveNode(a);     // disconnects e too
+/// pool.Get(a) == nullptr; // a stale handle finds nothing, also once the slot is reused
+/// pool.RemoveNodes(selection.data(), selection.size());
+///
+/// Nodes and edges live in dense arrays, removing one moves the last into its place, so iteration is over live
+/// entries only and the order changes on removal. Handles address a slot that maps to the dense position and carry
+/// the slot's generation, which every removal bumps. Every node keeps the handles of its edges, and every edge knows
+/// where it sits in both endpoints' lists, so AddNode, Connect and Disconnect are O(1) and RemoveNode is O(degree).
+/// Ports are plain indices, whether a connection is allowed is up to the editor.
+///
+
+namespace nodegraph
+{
+
+template <typename Tag>
+struct Handle
+{
+    uint32_t Index = ~0u;
+    uint32_t Generation = 0;
+
+    bool operator==(const Handle &other) const { return Index == other.Index && Generation == other.Generation; }
+    bool operator!=(const Handle &other) const { return !(*this == other); }
+    bool operator<(const Handle &other) const { return Index < other.Index || (Index == other.Index && Generation < other.Generation); }
+    bool IsNull() const { return Index == ~0u; }
+};
+using NodeHandle = Handle<struct NodeTag>;
+using EdgeHandle = Handle<struct EdgeTag>;
+
+template <typename NodeType, typename EdgeType>
+class NodePool
+{
+public:
+    struct Edge
+    {
+        NodeHandle From;
+        uint32_t Output;
+        NodeHandle To;
+        uint32_t Input;
+        EdgeType Data;
+
+    private:
+        friend class NodePool;
+        uint32_t FromPosition; // in the adjacency of From
+        uint32_t ToPosition;   // in the adjacency of To
+    };
+
+private:
+    struct Slot
+    {
+        uint32_t Generation = 0;
+        uint32_t Dense = ~0u; // ~0u while free
+    };
+
+    template <typename T>
+    struct Table
+    {
+        std::vector<T> Items;           // dense
+        std::vector<uint32_t> SlotOf;   // per dense item
+        std::vector<Slot> Slots;
+        std::vector<uint32_t> FreeSlots;
+
+        template <typename H>
+        uint32_t Find(H handle) const
+        {
+            if (handle.Index >= Slots.size() || Slots[handle.Index].Generation != handle.Generation)
+            {
+                return ~0u;
+            }
+            return Slots[handle.Index].Dense;
+        }
+
+        template <typename H>
+        H Insert(T &&item)
+        {
+            uint32_t slot;
+            if (!FreeSlots.empty())
+            {
+                slot = FreeSlots.back();
+                FreeSlots.pop_back();
+            }
+            else
+            {
+                slot = (uint32_t)Slots.size();
+                Slots.emplace_back();
+            }
+            Slots[slot].Dense = (uint32_t)Items.size();
+            Items.push_back(std::move(item));
+            SlotOf.push_back(slot);
+            return H{slot, Slots[slot].Generation};
+        }
+
+        void Release(uint32_t slot)
+        {
+            ++Slots[slot].Generation;
+            Slots[slot].Dense = ~0u;
+            FreeSlots.push_back(slot);
+        }
+
+        // returns the dense position the last item moved from, ~0u if none moved
+        uint32_t Erase(uint32_t dense)
+        {
+            Release(SlotOf[dense]);
+
+            const uint32_t last = (uint32_t)Items.size() - 1;
+            uint32_t moved = ~0u;
+            if (dense != last)
+            {
+                Items[dense] = std::move(Items[last]);
+                SlotOf[dense] = SlotOf[last];
+                Slots[SlotOf[dense]].Dense = dense;
+                moved = last;
+            }
+            Items.pop_back();
+            SlotOf.pop_back();
+            return moved;
+        }
+
+        // drop the items whose slot was released or that keep() rejects, in one pass that keeps the order
+        template <typename Keep>
+        void Compact(Keep keep)
+        {
+            uint32_t kept = 0;
+            for (uint32_t i = 0; i < (uint32_t)Items.size(); ++i)
+            {
+                const uint32_t slot = SlotOf[i];
+                if (Slots[slot].Dense == ~0u)
+                {
+                    continue;
+                }
+                if (!keep(Items[i]))
+                {
+                    Release(slot);
+                    continue;
+                }
+                if (kept != i)
+                {
+                    Items[kept] = std::move(Items[i]);
+                    SlotOf[kept] = slot;
+                }
+                Slots[slot].Dense = kept++;
+            }
+            Items.erase(Items.begin() + kept, Items.end());
+            SlotOf.resize(kept);
+        }
+
+        void Clear()
+        {
+            for (uint32_t slot : SlotOf)
+            {
+                Release(slot);
+            }
+            Items.clear();
+            SlotOf.clear();
+        }
+    };
+
+    struct NodeEntry
+    {
+        NodeType Value;
+        std::vector<EdgeHandle> Edges; // in and out
+    };
+
+    Table<NodeEntry> m_nodes;
+    Table<Edge> m_edges;
+
+    // remove the entry at position of node's adjacency, fixing the position of the edge moved into its place
+    void Unlink(NodeHandle node, uint32_t position)
+    {
+        std::vector<EdgeHandle> &edges = m_nodes.Items[m_nodes.Find(node)].Edges;
+        if (position + 1 != edges.size())
+        {
+            edges[position] = edges.back();
+            Edge &moved = m_edges.Items[m_edges.Find(edges[position])];
+            (moved.From == node ? moved.FromPosition : moved.ToPosition) = position;
+        }
+        edges.pop_back();
+    }
+
+public:
+    NodeHandle AddNode(NodeType node)
+    {
+        return m_nodes.template Insert<NodeHandle>(NodeEntry{std::move(node), {}});
+    }
+
+    // O(degree), false if node is stale
+    bool RemoveNode(NodeHandle node)
+    {
+        const uint32_t dense = m_nodes.Find(node);
+        if (dense == ~0u)
+        {
+            return false;
+        }
+        // Disconnect pops from the back of this list
+        while (!m_nodes.Items[dense].Edges.empty())
+        {
+            Disconnect(m_nodes.Items[dense].Edges.back());
+        }
+        m_nodes.Erase(dense);
+        return true;
+    }
+
+    // Stale and repeated handles are skipped, returns the number of nodes removed. A few nodes are removed one by one,
+    // O(degree) each. A larger share of the graph is removed in one sweep over all nodes and edges, O(nodes + edges)
+    // but sequential, which keeps the order of the remaining nodes.
+    uint32_t RemoveNodes(const NodeHandle *nodes, size_t count)
+    {
+        return RemoveNodes(nodes, count, [](const Edge &, NodeHandle) {});
+    }
+
+    // onDrop(const Edge &edge, NodeHandle survivor) is called for every removed edge whose other endpoint survivor stays,
+    // before the edge goes, so the caller can update survivor without looking the edges up first
+    template <typename OnDrop>
+    uint32_t RemoveNodes(const NodeHandle *nodes, size_t count, OnDrop onDrop)
+    {
+        if (count * 16 < m_nodes.Items.size())
+        {
+            std::vector<NodeHandle> doomed(nodes, nodes + count);
+            std::sort(doomed.begin(), doomed.end());
+            uint32_t removed = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const uint32_t dense = m_nodes.Find(nodes[i]);
+                if (dense == ~0u)
+                {
+                    continue;
+                }
+                for (EdgeHandle handle : m_nodes.Items[dense].Edges)
+                {
+                    const Edge &edge = m_edges.Items[m_edges.Find(handle)];
+                    const NodeHandle other = edge.From == nodes[i] ? edge.To : edge.From;
+                    if (!std::binary_search(doomed.begin(), doomed.end(), other))
+                    {
+                        onDrop(edge, other);
+                    }
+                }
+                removed += RemoveNode(nodes[i]) ? 1 : 0;
+            }
+            return removed;
+        }
+
+        uint32_t removed = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (m_nodes.Find(nodes[i]) != ~0u)
+            {
+                m_nodes.Release(nodes[i].Index);
+                ++removed;
+            }
+        }
+        if (removed == 0)
+        {
+            return 0;
+        }
+
+        // edges to a removed node go. the surviving endpoint unlinks it right away, O(1): an edge moved within its list
+        // is found through its slot, which Compact keeps pointing at the edge's current place whether it was visited
+        // yet or not
+        m_edges.Compact([this, &onDrop](const Edge &edge) {
+            const bool from = m_nodes.Find(edge.From) != ~0u;
+            const bool to = m_nodes.Find(edge.To) != ~0u;
+            if (from && !to)
+            {
+                onDrop(edge, edge.From);
+                Unlink(edge.From, edge.FromPosition);
+            }
+            else if (to && !from)
+            {
+                onDrop(edge, edge.To);
+                Unlink(edge.To, edge.ToPosition);
+            }
+            return from && to;
+        });
+        m_nodes.Compact([](const NodeEntry &) { return true; });
+        return removed;
+    }
+
+    // a null handle if an endpoint is stale or from == to. Ports may take any number of edges.
+    EdgeHandle Connect(NodeHandle from, uint32_t output, NodeHandle to, uint32_t input, EdgeType data = EdgeType())
+    {
+        const uint32_t fromDense = m_nodes.Find(from);
+        const uint32_t toDense = m_nodes.Find(to);
+        if (fromDense == ~0u || toDense == ~0u || from == to)
+        {
+            return EdgeHandle();
+        }
+
+        Edge edge;
+        edge.From = from;
+        edge.Output = output;
+        edge.To = to;
+        edge.Input = input;
+        edge.Data = std::move(data);
+        edge.FromPosition = (uint32_t)m_nodes.Items[fromDense].Edges.size();
+        edge.ToPosition = (uint32_t)m_nodes.Items[toDense].Edges.size();
+        const EdgeHandle handle = m_edges.template Insert<EdgeHandle>(std::move(edge));
+
+        m_nodes.Items[fromDense].Edges.push_back(handle);
+        m_nodes.Items[toDense].Edges.push_back(handle);
+        return handle;
+    }
+
+    // O(1), false if edge is stale
+    bool Disconnect(EdgeHandle edge)
+    {
+        const uint32_t dense = m_edges.Find(edge);
+        if (dense == ~0u)
+        {
+            return false;
+        }
+        const Edge &removed = m_edges.Items[dense];
+        Unlink(removed.From, removed.FromPosition);
+        Unlink(removed.To, removed.ToPosition);
+        m_edges.Erase(dense);
+        return true;
+    }
+
+    void Clear()
+    {
+        m_nodes.Clear();
+        m_edges.Clear();
+    }
+
+    // nullptr if stale
+    NodeType *Get(NodeHandle node)
+    {
+        const uint32_t dense = m_nodes.Find(node);
+        return dense == ~0u ? nullptr : &m_nodes.Items[dense].Value;
+    }
+    const NodeType *Get(NodeHandle node) const { return const_cast<NodePool *>(this)->Get(node); }
+    Edge *Get(EdgeHandle edge)
+    {
+        const uint32_t dense = m_edges.Find(edge);
+        return dense == ~0u ? nullptr : &m_edges.Items[dense];
+    }
+    const Edge *Get(EdgeHandle edge) const { return const_cast<NodePool *>(this)->Get(edge); }
+
+    // the edges in and out of node, in no particular order. node must be valid.
+    const std::vector<EdgeHandle> &GetEdges(NodeHandle node) const
+    {
+        assert(m_nodes.Find(node) != ~0u);
+        return m_nodes.Items[m_nodes.Find(node)].Edges;
+    }
+    // the first edge into input of node, O(degree)
+    EdgeHandle FindInputEdge(NodeHandle node, uint32_t input) const
+    {
+        for (EdgeHandle handle : GetEdges(node))
+        {
+            const Edge &edge = m_edges.Items[m_edges.Find(handle)];
+            if (edge.To == node && edge.Input == input)
+            {
+                return handle;
+            }
+        }
+        return EdgeHandle();
+    }
+
+    // the live node in slot index, a null handle if the slot is free. For ids that outlive a frame, such as
+    // ImGui ids, keep the handle itself.
+    NodeHandle GetNodeHandle(uint32_t index) const
+    {
+        if (index >= m_nodes.Slots.size() || m_nodes.Slots[index].Dense == ~0u)
+        {
+            return NodeHandle();
+        }
+        return NodeHandle{index, m_nodes.Slots[index].Generation};
+    }
+    // slots ever used, Index of every NodeHandle is below
+    uint32_t GetNodeSlotCount() const { return (uint32_t)m_nodes.Slots.size(); }
+
+    // dense iteration, i < GetNodeCount()
+    uint32_t GetNodeCount() const { return (uint32_t)m_nodes.Items.size(); }
+    NodeType &GetNodeAt(uint32_t i) { return m_nodes.Items[i].Value; }
+    const NodeType &GetNodeAt(uint32_t i) const { return m_nodes.Items[i].Value; }
+    NodeHandle GetNodeHandleAt(uint32_t i) const { return NodeHandle{m_nodes.SlotOf[i], m_nodes.Slots[m_nodes.SlotOf[i]].Generation}; }
+
+    uint32_t GetEdgeCount() const { return (uint32_t)m_edges.Items.size(); }
+    Edge &GetEdgeAt(uint32_t i) { return m_edges.Items[i]; }
+    const Edge &GetEdgeAt(uint32_t i) const { return m_edges.Items[i]; }
+    EdgeHandle GetEdgeHandleAt(uint32_t i) const { return EdgeHandle{m_edges.SlotOf[i], m_edges.Slots[m_edges.SlotOf[i]].Generation}; }
+};
+
+} // namespace nodegraph
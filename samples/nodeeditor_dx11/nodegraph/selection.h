@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <stddef.h>
+#include <vector>
+
+///
+/// Set of selected nodes or edges, kept as a sorted array of handles.
+///
+/// Selection<NodeHandle> selection;
+/// selection.Add(a);                                // O(selected)
+/// selection.Add(hits.data(), hits.size());         // box selection, merged in one pass
+/// if (selection.Contains(b))                       // O(log selected)
+/// for (NodeHandle handle : selection)              // O(selected), in handle order
+///     pool.Get(handle)->Move(delta);
+/// pool.RemoveNodes(selection.data(), selection.size());
+///
+/// Queries and edits cost the size of the selection, never the size of the graph. Handle order is slot order, so
+/// walking the selection visits the pool's slots in increasing order. Handles are not tracked, a node removed
+/// behind the selection's back stays in it until Prune() or Clear().
+///
+
+namespace nodegraph
+{
+
+template <typename HandleType>
+class Selection
+{
+    std::vector<HandleType> m_handles; // sorted, no duplicates
+
+public:
+    bool Contains(HandleType handle) const { return std::binary_search(m_handles.begin(), m_handles.end(), handle); }
+
+    // false if handle was selected already
+    bool Add(HandleType handle)
+    {
+        auto it = std::lower_bound(m_handles.begin(), m_handles.end(), handle);
+        if (it != m_handles.end() && *it == handle)
+        {
+            return false;
+        }
+        m_handles.insert(it, handle);
+        return true;
+    }
+
+    // handles in any order, repeats allowed
+    void Add(const HandleType *handles, size_t count)
+    {
+        const size_t size = m_handles.size();
+        m_handles.insert(m_handles.end(), handles, handles + count);
+        std::sort(m_handles.begin() + size, m_handles.end());
+        std::inplace_merge(m_handles.begin(), m_handles.begin() + size, m_handles.end());
+        m_handles.erase(std::unique(m_handles.begin(), m_handles.end()), m_handles.end());
+    }
+
+    // false if handle was not selected
+    bool Remove(HandleType handle)
+    {
+        auto it = std::lower_bound(m_handles.begin(), m_handles.end(), handle);
+        if (it == m_handles.end() || *it != handle)
+        {
+            return false;
+        }
+        m_handles.erase(it);
+        return true;
+    }
+
+    // returns whether handle is selected afterwards
+    bool Toggle(HandleType handle)
+    {
+        if (Remove(handle))
+        {
+            return false;
+        }
+        Add(handle);
+        return true;
+    }
+
+    // drop the handles pool no longer knows
+    template <typename PoolType>
+    void Prune(const PoolType &pool)
+    {
+        m_handles.erase(std::remove_if(m_handles.begin(), m_handles.end(), [&](HandleType handle) { return !pool.Get(handle); }),
+                        m_handles.end());
+    }
+
+    void Clear() { m_handles.clear(); }
+    bool IsEmpty() const { return m_handles.empty(); }
+
+    const HandleType *data() const { return m_handles.data(); }
+    size_t size() const { return m_handles.size(); }
+    typename std::vector<HandleType>::const_iterator begin() const { return m_handles.begin(); }
+    typename std::vector<HandleType>::const_iterator end() const { return m_handles.end(); }
+};
+
+} // namespace nodegraph
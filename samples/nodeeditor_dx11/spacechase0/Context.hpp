@@ -1,55 +1,41 @@
 #pragma once
-#include <memory>
+#include <utility>
+#include <vector>
+#include "Node.hpp"
 
 namespace spacechase0
 {
 
-struct Connection;
 struct Context
 {
     bool clickedInSomething = false;
     bool dragging = false;
-    std::unique_ptr<Connection> connSel;
+    // a link being dragged from a pin to the mouse
+    bool connDragging = false;
+    NodeHandle connNode;
+    int connIndex = 0;
     bool connSelInput = false;
+    std::vector<std::pair<NodeHandle, int>> editedPins; // (node, input) changed by the user this frame
 
     void NewFrame()
     {
         clickedInSomething = false;
         dragging = false;
+        editedPins.clear();
     }
 
-    void clear()
+    void startDrag(NodeHandle node, int index, bool input)
     {
-        if (connSel)
-        {
-            if (connSelInput)
-                connSel->other->inputs[connSel->index] = std::any();
-            else
-                connSel->other->outputs[connSel->index] = std::any();
-        }
+        connDragging = true;
+        connNode = node;
+        connIndex = index;
+        connSelInput = input;
     }
 
-    void deselectAll(const std::vector<std::unique_ptr<Node>> &nodes)
+    void clear()
     {
-        for (auto &other : nodes)
-        {
-            other->selected = false;
-            for (auto &oin : other->inputs)
-            {
-                if (oin.type() == typeid(Connection))
-                {
-                    std::any_cast<Connection &>(oin).selected = false;
-                }
-            }
-            for (auto &oout : other->outputs)
-            {
-                if (oout.type() == typeid(Connection))
-                {
-                    std::any_cast<Connection &>(oout).selected = false;
-                }
-            }
-        }
+        connDragging = false;
     }
 };
 
-} // namespace spacechase0
\ No newline at end of file
+} // namespace spacechase0
@@ -0,0 +1,225 @@
+#include <plog/Log.h>
+#include <unordered_map>
+
+#include "NodeGraph.hpp"
+
+namespace spacechase0
+{
+
+static dataflow::ValueType toValueType(ConnectionType connType)
+{
+    switch (connType)
+    {
+    case ConnectionType::Int:
+        return dataflow::ValueType::Int;
+    case ConnectionType::Float:
+        return dataflow::ValueType::Float;
+    case ConnectionType::String:
+        return dataflow::ValueType::String;
+    case ConnectionType::Vector2:
+        return dataflow::ValueType::Vector2;
+    default:
+        return dataflow::ValueType::None;
+    }
+}
+
+static std::vector<dataflow::ValueType> toValueTypes(const std::vector<std::pair<ConnectionType, std::string>> &pins)
+{
+    std::vector<dataflow::ValueType> types;
+    for (auto &pin : pins)
+        types.push_back(toValueType(pin.first));
+    return types;
+}
+
+// the value of an unconnected pin, empty for Sequence
+static dataflow::Value toValue(const GraphStorage &storage, const Pin &pin)
+{
+    switch (pin.type)
+    {
+    case ConnectionType::Int:
+        return (int32_t)storage.ints[pin.row];
+    case ConnectionType::Float:
+        return storage.floats[pin.row];
+    case ConnectionType::String:
+        return storage.strings[pin.row];
+    case ConnectionType::Vector2:
+    {
+        ImVec2 v = storage.vector2s[pin.row];
+        return dataflow::Vector2{v.x, v.y};
+    }
+    default:
+        return std::monostate();
+    }
+}
+
+// write an evaluated output into the pin's column, where the node draws it from
+static void fromValue(const dataflow::Value &value, GraphStorage &storage, const Pin &pin)
+{
+    switch (pin.type)
+    {
+    case ConnectionType::Int:
+        if (auto v = std::get_if<int32_t>(&value))
+            storage.ints[pin.row] = *v;
+        break;
+    case ConnectionType::Float:
+        if (auto v = std::get_if<float>(&value))
+            storage.floats[pin.row] = *v;
+        break;
+    case ConnectionType::String:
+        if (auto v = std::get_if<std::string>(&value))
+            storage.strings[pin.row] = *v;
+        break;
+    case ConnectionType::Vector2:
+        if (auto v = std::get_if<dataflow::Vector2>(&value))
+            storage.vector2s[pin.row] = ImVec2(v->X, v->Y);
+        break;
+    default:
+        break;
+    }
+}
+
+// the string a Print node logs, past its Sequence output pin
+static const uint32_t PrintStringOutput = 1;
+
+void Graph::registerKernels(dataflow::KernelRegistry &registry) const
+{
+    using namespace dataflow;
+    std::unordered_map<std::string, KernelFunction> functions;
+    functions["Start"] = [](const Value *const *, Value *) {};
+    functions["Nop"] = [](const Value *const *, Value *) {};
+    functions["Print"] = [](const Value *const *in, Value *out) { out[PrintStringOutput] = *in[1]; };
+    functions["Concat"] = [](const Value *const *in, Value *out) {
+        out[0] = std::get<std::string>(*in[0]) + std::get<std::string>(*in[1]);
+    };
+    functions["Int ToString"] = [](const Value *const *in, Value *out) { out[0] = std::to_string(std::get<int32_t>(*in[0])); };
+    functions["Float ToString"] = [](const Value *const *in, Value *out) { out[0] = std::to_string(std::get<float>(*in[0])); };
+    functions["Split Vec2"] = [](const Value *const *in, Value *out) {
+        const dataflow::Vector2 &v = std::get<dataflow::Vector2>(*in[0]);
+        out[0] = (int32_t)v.X;
+        out[1] = (int32_t)v.Y;
+    };
+
+    for (auto &type : types)
+    {
+        auto function = functions.find(type.first);
+        if (function == functions.end())
+        {
+            LOGW << "spacechase0: no kernel for node type " << type.first;
+            continue;
+        }
+        std::vector<ValueType> outputs = toValueTypes(type.second.outputs);
+        // not a pin, so it isn't drawn
+        if (type.first == "Print")
+            outputs.push_back(ValueType::String);
+        registry.Register(type.first, toValueTypes(type.second.inputs), std::move(outputs), function->second);
+    }
+}
+
+bool Graph::buildDataflowGraph(dataflow::Graph &graph)
+{
+    graph.Clear();
+    m_dataflowIds.assign(storage.pool.GetNodeSlotCount(), dataflow::InvalidNode);
+    m_dataflowNodes.clear();
+    m_printNodes.clear();
+
+    for (uint32_t n = 0; n < storage.pool.GetNodeCount(); ++n)
+    {
+        const Node &node = storage.pool.GetNodeAt(n);
+        dataflow::NodeId id = graph.AddNode(node.type);
+        if (id == dataflow::InvalidNode)
+        {
+            LOGE << "spacechase0: no kernel for node type " << node.type;
+            return false;
+        }
+        m_dataflowIds[storage.pool.GetNodeHandleAt(n).Index] = id;
+        m_dataflowNodes.push_back(storage.pool.GetNodeHandleAt(n));
+        if (node.type == "Print")
+            m_printNodes.push_back({id, 0});
+
+        for (int i = 0; i < node.inputCount; ++i)
+        {
+            const Pin &pin = storage.input(node, i);
+            if (pin.edge.IsNull())
+            {
+                dataflow::Value value = toValue(storage, pin);
+                if (!std::holds_alternative<std::monostate>(value))
+                    graph.SetConstant(id, i, std::move(value));
+            }
+        }
+    }
+
+    for (uint32_t e = 0; e < storage.pool.GetEdgeCount(); ++e)
+    {
+        const auto &edge = storage.pool.GetEdgeAt(e);
+        if (!graph.Connect(m_dataflowIds[edge.From.Index], edge.Output, m_dataflowIds[edge.To.Index], edge.Input))
+            return false;
+    }
+    return true;
+}
+
+void Graph::applyPinEdits(dataflow::Program &program) const
+{
+    for (auto &edit : m_context.editedPins)
+    {
+        // skip nodes added since the program was built
+        if (edit.first.Index >= m_dataflowIds.size())
+            continue;
+        dataflow::NodeId id = m_dataflowIds[edit.first.Index];
+        if (id == dataflow::InvalidNode || m_dataflowNodes[id] != edit.first)
+            continue;
+
+        dataflow::Value value = toValue(storage, storage.input(storage.get(edit.first), edit.second));
+        if (!std::holds_alternative<std::monostate>(value))
+            program.SetConstant(id, edit.second, std::move(value));
+    }
+}
+
+void Graph::evaluate()
+{
+    // a new or removed node or link compiles again, everything is stale after. a pin edit only marks what is
+    // downstream of it
+    if (m_compiledVersion != storage.topologyVersion)
+    {
+        m_compiledVersion = storage.topologyVersion;
+        m_compiled = buildDataflowGraph(m_dataflowGraph);
+        if (m_compiled && !m_program.Compile(m_dataflowGraph))
+        {
+            LOGW << "spacechase0: the graph has a cycle of " << m_program.GetCycle().size() << " nodes, not evaluated";
+            m_compiled = false;
+        }
+    }
+    else if (m_compiled)
+    {
+        applyPinEdits(m_program);
+    }
+    if (!m_compiled)
+        return;
+
+    // pull only what is on screen, reruns the stale nodes those outputs depend on. an off screen node stays
+    // stale until it is scrolled in or something on screen needs it
+    for (NodeHandle handle : m_visibleNodes)
+    {
+        // removed by update() after it was drawn, the next frame compiles without it
+        if (!storage.isValid(handle))
+            continue;
+        const Node &node = storage.get(handle);
+        dataflow::NodeId id = m_dataflowIds[handle.Index];
+        for (int i = 0; i < node.outputCount; ++i)
+            fromValue(m_program.Pull(id, i), storage, storage.output(node, i));
+    }
+
+    // sinks run whether they are on screen or not. a memoized rerun that gives the same string keeps the port
+    // version, so each string is logged once
+    for (auto &print : m_printNodes)
+    {
+        const dataflow::Value &value = m_program.Pull(print.first, PrintStringOutput);
+        uint64_t version = m_program.GetPortVersion(print.first, PrintStringOutput);
+        if (version != print.second)
+        {
+            print.second = version;
+            LOGI << std::get<std::string>(value);
+        }
+    }
+}
+
+} // namespace spacechase0
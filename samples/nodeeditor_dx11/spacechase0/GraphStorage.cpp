@@ -0,0 +1,174 @@
+#include "GraphStorage.hpp"
+#include <algorithm>
+
+namespace spacechase0
+{
+
+uint32_t GraphStorage::allocateRow(ConnectionType type)
+{
+    std::vector<uint32_t> &freeRows = m_freeRows[type];
+    if (!freeRows.empty())
+    {
+        // a new pin starts from the default, not from the removed node's value
+        uint32_t row = freeRows.back();
+        freeRows.pop_back();
+        switch (type)
+        {
+        case ConnectionType::Int:
+            ints[row] = 0;
+            break;
+        case ConnectionType::Float:
+            floats[row] = 0.f;
+            break;
+        case ConnectionType::String:
+            strings[row].clear();
+            break;
+        case ConnectionType::Vector2:
+            vector2s[row] = ImVec2(0, 0);
+            break;
+        default:
+            break;
+        }
+        return row;
+    }
+
+    switch (type)
+    {
+    case ConnectionType::Int:
+        ints.push_back(0);
+        return (uint32_t)ints.size() - 1;
+    case ConnectionType::Float:
+        floats.push_back(0.f);
+        return (uint32_t)floats.size() - 1;
+    case ConnectionType::String:
+        strings.emplace_back();
+        return (uint32_t)strings.size() - 1;
+    case ConnectionType::Vector2:
+        vector2s.push_back(ImVec2(0, 0));
+        return (uint32_t)vector2s.size() - 1;
+    default:
+        return 0;
+    }
+}
+
+NodeHandle GraphStorage::add(const std::string &type, const NodeType &nodeType, ImVec2 position)
+{
+    Node node;
+    node.type = type;
+    node.position = position;
+    node.inputCount = (int)nodeType.inputs.size();
+    node.outputCount = (int)nodeType.outputs.size();
+
+    const uint32_t pinCount = (uint32_t)(node.inputCount + node.outputCount);
+    auto freePins = m_freePins.find(pinCount);
+    if (freePins != m_freePins.end() && !freePins->second.empty())
+    {
+        node.firstPin = freePins->second.back();
+        freePins->second.pop_back();
+    }
+    else
+    {
+        node.firstPin = (uint32_t)pins.size();
+        pins.resize(pins.size() + pinCount);
+    }
+
+    for (int i = 0; i < node.inputCount; ++i)
+    {
+        Pin &pin = input(node, i);
+        pin.type = nodeType.inputs[i].first;
+        pin.row = allocateRow(pin.type);
+        pin.edge = EdgeHandle();
+    }
+    for (int i = 0; i < node.outputCount; ++i)
+    {
+        Pin &pin = output(node, i);
+        pin.type = nodeType.outputs[i].first;
+        pin.row = allocateRow(pin.type);
+        pin.edge = EdgeHandle();
+    }
+
+    ++topologyVersion;
+    return pool.AddNode(std::move(node));
+}
+
+void GraphStorage::remove(NodeHandle handle)
+{
+    remove(std::vector<NodeHandle>{handle});
+}
+
+void GraphStorage::remove(const std::vector<NodeHandle> &nodes_)
+{
+    // a node listed twice would free its rows twice
+    std::vector<NodeHandle> nodes = nodes_;
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+    for (NodeHandle handle : nodes)
+    {
+        if (!isValid(handle))
+            continue;
+
+        // clears the pins on the other side, pool.RemoveNodes would only drop the links
+        while (!pool.GetEdges(handle).empty())
+            disconnect(pool.GetEdges(handle).back());
+
+        const Node &node = get(handle);
+        const uint32_t pinCount = (uint32_t)(node.inputCount + node.outputCount);
+        for (uint32_t i = node.firstPin; i < node.firstPin + pinCount; ++i)
+        {
+            if (pins[i].type != ConnectionType::Sequence)
+                m_freeRows[pins[i].type].push_back(pins[i].row);
+        }
+        m_freePins[pinCount].push_back(node.firstPin);
+    }
+
+    pool.RemoveNodes(nodes.data(), nodes.size());
+    ++topologyVersion;
+    selectedNodes.Prune(pool);
+}
+
+bool GraphStorage::connect(NodeHandle from, int outputIndex, NodeHandle to, int inputIndex)
+{
+    if (!isValid(from) || !isValid(to) || from == to)
+        return false;
+
+    const Node &fromNode = get(from);
+    const Node &toNode = get(to);
+    if (outputIndex < 0 || outputIndex >= fromNode.outputCount || inputIndex < 0 || inputIndex >= toNode.inputCount)
+        return false;
+
+    Link link;
+    link.fromPin = fromNode.firstPin + fromNode.inputCount + outputIndex;
+    link.toPin = toNode.firstPin + inputIndex;
+    if (pins[link.fromPin].type != pins[link.toPin].type)
+        return false;
+
+    disconnect(pins[link.fromPin].edge);
+    disconnect(pins[link.toPin].edge);
+
+    const uint32_t fromPin = link.fromPin, toPin = link.toPin;
+    ++topologyVersion;
+    pins[fromPin].edge = pins[toPin].edge = pool.Connect(from, outputIndex, to, inputIndex, link);
+    return true;
+}
+
+void GraphStorage::disconnect(EdgeHandle edge)
+{
+    const auto *link = pool.Get(edge);
+    if (!link)
+        return;
+
+    pins[link->Data.fromPin].edge = EdgeHandle();
+    pins[link->Data.toPin].edge = EdgeHandle();
+    selectedLinks.Remove(edge);
+    pool.Disconnect(edge);
+    ++topologyVersion;
+}
+
+void GraphStorage::deselectAll()
+{
+    selectedNodes.Clear();
+    selectedLinks.Clear();
+}
+
+} // namespace spacechase0
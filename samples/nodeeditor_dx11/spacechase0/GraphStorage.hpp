@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <imgui.h>
+#include "Node.hpp"
+#include "../nodegraph/selection.h"
+
+namespace spacechase0
+{
+
+// one pin of a node: its value lives in the column of its type, at row
+struct Pin
+{
+    ConnectionType type;
+    uint32_t row = 0; // unused for Sequence, which carries no value
+    EdgeHandle edge;  // null while unconnected
+};
+
+struct Link
+{
+    uint32_t fromPin = 0;
+    uint32_t toPin = 0;
+    BezierCache curve; // canvas space
+};
+
+// Nodes and links in a nodegraph::NodePool, pin values in one column per ConnectionType. A pin knows its link, so
+// connecting and disconnecting touch only the two pins, removing a node only its own, hit testing and evaluation
+// walk dense arrays, and selection is a sorted set of handles that costs what is selected.
+class GraphStorage
+{
+public:
+    // pin values by type, indexed by Pin::row
+    std::vector<int> ints;
+    std::vector<float> floats;
+    std::vector<std::string> strings;
+    std::vector<ImVec2> vector2s;
+
+    std::vector<Pin> pins;
+    nodegraph::NodePool<Node, Link> pool;
+
+    // removing a node or disconnecting a link drops it from these
+    nodegraph::Selection<NodeHandle> selectedNodes;
+    nodegraph::Selection<EdgeHandle> selectedLinks;
+
+    // bumped whenever a node or link is added or removed, evaluation compiles the graph again when it moved
+    uint64_t topologyVersion = 0;
+
+    NodeHandle add(const std::string &type, const NodeType &nodeType, ImVec2 position);
+    void remove(NodeHandle node);
+    void remove(const std::vector<NodeHandle> &nodes);
+
+    bool isValid(NodeHandle node) const { return pool.Get(node) != nullptr; }
+    Node &get(NodeHandle node) { return *pool.Get(node); }
+    const Node &get(NodeHandle node) const { return *pool.Get(node); }
+
+    Pin &input(const Node &node, int index) { return pins[node.firstPin + index]; }
+    Pin &output(const Node &node, int index) { return pins[node.firstPin + node.inputCount + index]; }
+    const Pin &input(const Node &node, int index) const { return pins[node.firstPin + index]; }
+    const Pin &output(const Node &node, int index) const { return pins[node.firstPin + node.inputCount + index]; }
+
+    // replaces what either pin was connected to. false if a handle is stale or the pin types differ.
+    bool connect(NodeHandle from, int output, NodeHandle to, int input);
+    void disconnect(EdgeHandle edge);
+
+    void deselectAll();
+
+private:
+    std::vector<uint32_t> m_freeRows[5];                           // per ConnectionType
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_freePins; // pin count -> first pins
+
+    uint32_t allocateRow(ConnectionType type);
+};
+
+} // namespace spacechase0
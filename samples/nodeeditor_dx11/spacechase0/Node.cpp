@@ -1,67 +1,44 @@
 ﻿#include "Node.hpp"
 #include "Utils.hpp"
 #include "Context.hpp"
+#include "GraphStorage.hpp"
 #include <algorithm>
 #include <imgui_internal.h>
 
-#include "Utils.hpp"
-static constexpr auto bezier_weights_ = BezierWeights<16>();
-float GetSquaredDistanceToBezierCurve(const ImVec2 &point, const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p3, const ImVec2 &p4)
-{
-    float minSquaredDistance = FLT_MAX;
-    ImVec2 L = p1;
-
-    for (int i = 1; i < 16 - 1; ++i)
-    {
-        const ImVec4 &W = ImVec4(bezier_weights_.x_[i], bezier_weights_.y_[i], bezier_weights_.z_[i], bezier_weights_.w_[i]);
-
-        ImVec2 temp;
-        temp.x = W.x * p1.x + W.y * p2.x + W.z * p3.x + W.w * p4.x;
-        temp.y = W.x * p1.y + W.y * p2.y + W.z * p3.y + W.w * p4.y;
-
-        float tmp = GetSquaredDistancePointSegment(point, L, temp);
-
-        if (minSquaredDistance > tmp)
-        {
-            minSquaredDistance = tmp;
-        }
-
-        L = temp;
-    }
-
-    {
-        auto tmp = GetSquaredDistancePointSegment(point, L, p4);
-        if (minSquaredDistance > tmp)
-        {
-            minSquaredDistance = tmp;
-        }
-    }
-
-    return minSquaredDistance;
-}
 namespace spacechase0
 {
 
-ImVec2 Node::getInputConnectorPos(ImVec2 base, int index)
+ImVec2 Node::getInputConnectorPos(ImVec2 base, int index) const
 {
     return base + position + ImVec2(5, 34) + ImVec2(0, (float)(index * 25));
 }
 
-ImVec2 Node::getOutputConnectorPos(ImVec2 base, int index)
+ImVec2 Node::getOutputConnectorPos(ImVec2 base, int index) const
 {
     return base + position + ImVec2(300 - 20, 34) + ImVec2(0, (float)(index * 25));
 }
 
-void Node::Draw(Context *context, ImDrawList *draw, int n, const NodeType &nodeType, const ImVec2 &offset, const ImVec2 &mouse,
-                const std::vector<std::unique_ptr<Node>> &nodes,
-                const std::unordered_map<std::string, NodeType> &types)
+ImVec2 Node::getSize() const
 {
-    ImGui::PushID(n);
+    return ImVec2(300, 25 + (collapsed
+                                 ? 0
+                                 : (float)(std::max(inputCount, outputCount) * 25 + 10)));
+}
+
+bool Node::isVisible(const ImVec2 &clipMin, const ImVec2 &clipMax) const
+{
+    ImVec2 size = getSize();
+    return position.x <= clipMax.x && position.y <= clipMax.y && position.x + size.x >= clipMin.x && position.y + size.y >= clipMin.y;
+}
+
+void Node::Draw(Context *context, ImDrawList *draw, NodeHandle self, const NodeType &nodeType, const ImVec2 &offset, const ImVec2 &mouse,
+                GraphStorage &storage)
+{
+    // the whole handle, a node added into a freed slot must not inherit the old node's widget state
+    ImGui::PushID((const char *)&self, (const char *)(&self + 1));
 
     ImVec2 nodePos = offset + position;
-    ImVec2 nodeSize(300, 25 + (collapsed
-                                   ? 0
-                                   : (float)(std::max(inputs.size(), outputs.size()) * 25 + 10)));
+    ImVec2 nodeSize = getSize();
 
     // Handle selection, dragging, collapsing
     if (ImGui::IsMouseClicked(0) && !ImGui::IsMouseDown(1) && !ImGui::IsMouseDown(2))
@@ -78,9 +55,9 @@ void Node::Draw(Context *context, ImDrawList *draw, int n, const NodeType &nodeT
             // click node header
             if (!ImGui::GetIO().KeyShift)
             {
-                context->deselectAll(nodes);
+                storage.deselectAll();
             }
-            selected = true;
+            storage.selectedNodes.Add(self);
 
             if (ImGui::IsMouseDoubleClicked(0))
             {
@@ -89,23 +66,16 @@ void Node::Draw(Context *context, ImDrawList *draw, int n, const NodeType &nodeT
         }
     }
 
-    if (ImGui::IsMouseDown(0) && selected)
-    {
-        // drag move
-        context->dragging = true;
-        position += ImGui::GetIO().MouseDelta;
-    }
-
     // Draw node BG
     // ImGui::BeginGroup();
     // ImGui::SetCursorScreenPos(offset + position);
-    if (selected)
+    if (storage.selectedNodes.Contains(self))
     {
         draw->AddRect(nodePos, nodePos + nodeSize, ImColor(255, 255, 255, 255), 16, ImDrawCornerFlags_All, 4);
     }
     draw->AddRectFilled(nodePos, nodePos + nodeSize, ImColor(64, 64, 64, 200), 16, ImDrawCornerFlags_All);
 
-    bool small = (collapsed || (std::max(inputs.size(), outputs.size()) == 0));
+    bool small = (collapsed || (std::max(inputCount, outputCount) == 0));
     draw->AddRectFilled(nodePos, nodePos + ImVec2(nodeSize.x, 25), ImColor(0, 32, 64, 200), 16,
                         small
                             ? ImDrawCornerFlags_All
@@ -118,158 +88,76 @@ void Node::Draw(Context *context, ImDrawList *draw, int n, const NodeType &nodeT
 
     if (!collapsed)
     {
-        DrawContent(context, draw, n, nodeType, offset, mouse, nodes, types);
+        DrawContent(context, draw, self, nodeType, offset, mouse, storage);
     }
 
     ImGui::PopID();
 }
 
-void Node::DrawContent(Context *context, ImDrawList *draw, int n, const NodeType &nodeType, const ImVec2 &offset, const ImVec2 &mouse,
-                       const std::vector<std::unique_ptr<Node>> &nodes,
-                       const std::unordered_map<std::string, NodeType> &types)
+void Node::DrawContent(Context *context, ImDrawList *draw, NodeHandle self, const NodeType &nodeType, const ImVec2 &offset, const ImVec2 &mouse,
+                       GraphStorage &storage)
 {
-    int i = 0;
-    for (auto &input : inputs)
+    for (int i = 0; i < inputCount; ++i)
     {
         ImVec2 connPos = getInputConnectorPos(offset, i);
 
-        doPinCircle(draw, connPos, nodeType.inputs[i].first, input.type() == typeid(Connection));
+        doPinCircle(draw, connPos, nodeType.inputs[i].first, !storage.input(*this, i).edge.IsNull());
         if (ImRect(connPos, connPos + ImVec2(16, 16)).Contains(mouse))
         {
-            if (!context->connSel && ImGui::IsMouseClicked(0))
+            if (!context->connDragging && ImGui::IsMouseClicked(0))
             {
                 context->clickedInSomething = true;
-                context->deselectAll(nodes);
-                context->connSel.reset(new Connection{this, i});
-                context->connSelInput = true;
+                storage.deselectAll();
+                context->startDrag(self, i, true);
 
-                if (input.type() == typeid(Connection))
-                {
-                    auto other = std::any_cast<Connection>(input);
-                    other.other->outputs[other.index] = std::any();
-                }
-                input = Connection();
+                // pick the link up, it is made again wherever it is dropped
+                if (!storage.input(*this, i).edge.IsNull())
+                    storage.disconnect(storage.input(*this, i).edge);
             }
-            else if (context->connSel &&
+            else if (context->connDragging &&
                      ImGui::IsMouseReleased(0) &&
                      !context->connSelInput &&
-                     context->connSel->other != this)
+                     context->connNode != self)
             {
-                auto found = types.find(context->connSel->other->type);
-                if (found != types.end())
-                {
-                    if (nodeType.inputs[i].first == found->second.outputs[context->connSel->index].first)
-                    {
-                        input = (*context->connSel);
-                        context->connSel->other->outputs[context->connSel->index] = Connection{this, i};
-                        context->connSel.reset();
-                    }
-                }
+                if (storage.connect(context->connNode, context->connIndex, self, i))
+                    context->connDragging = false;
             }
         }
 
         ImGui::SetCursorScreenPos(connPos + ImVec2(20, 0));
         ImGui::PushItemWidth(75);
-        doPinValue((nodeType.inputs[i].second + "##i" + std::to_string(i)).c_str(), nodeType.inputs[i].first, input);
+        if (doPinValue(nodeType.inputs[i].second + "##i" + std::to_string(i), storage, storage.input(*this, i)))
+            context->editedPins.push_back({self, i});
         ImGui::PopItemWidth();
-
-        if (input.type() == typeid(Connection))
-        {
-            Connection conn = std::any_cast<Connection>(input);
-            if (conn.other == nullptr)
-            {
-                // マウスでドラッグ
-                connPos += ImVec2(8, 8);
-                ImVec2 otherConnPos = mouse;
-                draw->AddBezierCurve(connPos, connPos + ImVec2(50, 0),
-                                     otherConnPos + ImVec2(-50, 0), otherConnPos,
-                                     getConnectorColor(nodeType.inputs[i].first), 2);
-            }
-        }
-
-        ++i;
     }
 
-    i = 0;
-    for (auto &output : outputs)
+    for (int i = 0; i < outputCount; ++i)
     {
         ImVec2 connPos = getOutputConnectorPos(offset, i);
 
-        doPinCircle(draw, connPos, nodeType.outputs[i].first, output.type() == typeid(Connection));
+        doPinCircle(draw, connPos, nodeType.outputs[i].first, !storage.output(*this, i).edge.IsNull());
         if (ImRect(connPos, connPos + ImVec2(16, 16)).Contains(mouse))
         {
-            if (!context->connSel && ImGui::IsMouseClicked(0))
+            if (!context->connDragging && ImGui::IsMouseClicked(0))
             {
                 context->clickedInSomething = true;
-                context->deselectAll(nodes);
-                context->connSel.reset(new Connection{this, i});
-                context->connSelInput = false;
-                if (output.type() == typeid(Connection))
-                {
-                    auto other = std::any_cast<Connection>(output);
-                    other.other->inputs[other.index] = std::any();
-                }
-                output = Connection();
+                storage.deselectAll();
+                context->startDrag(self, i, false);
+                if (!storage.output(*this, i).edge.IsNull())
+                    storage.disconnect(storage.output(*this, i).edge);
             }
-            else if (context->connSel && ImGui::IsMouseReleased(0) && context->connSelInput && context->connSel->other != this)
+            else if (context->connDragging && ImGui::IsMouseReleased(0) && context->connSelInput && context->connNode != self)
             {
-                auto found = types.find(context->connSel->other->type);
-                if (found != types.end())
-                {
-                    if (nodeType.outputs[i].first == found->second.inputs[context->connSel->index].first)
-                    {
-                        output = (*context->connSel);
-                        context->connSel->other->inputs[context->connSel->index] = Connection{this, i};
-
-                        context->connSel.reset();
-                    }
-                }
+                if (storage.connect(self, i, context->connNode, context->connIndex))
+                    context->connDragging = false;
             }
         }
 
         ImGui::SetCursorScreenPos(connPos - ImVec2(90, 0) - ImVec2(ImGui::CalcTextSize(nodeType.outputs[i].second.c_str()).x, 0));
 
         ImGui::PushItemWidth(75);
-        doPinValue((nodeType.outputs[i].second + "##o" + std::to_string(i)).c_str(), nodeType.outputs[i].first, output);
+        doPinOutput(nodeType.outputs[i].second + "##o" + std::to_string(i), storage, storage.output(*this, i));
         ImGui::PopItemWidth();
-
-        // Draw connections
-        if (output.type() == typeid(Connection))
-        {
-            Connection &conn = std::any_cast<Connection &>(output);
-
-            connPos += ImVec2(8, 8);
-            ImVec2 otherConnPos = conn.other == nullptr ? mouse : conn.other->getInputConnectorPos(offset, conn.index) + ImVec2(8, 8);
-
-            if (GetSquaredDistanceToBezierCurve(mouse,
-                                                connPos,
-                                                connPos + ImVec2(50, 0),
-                                                otherConnPos + ImVec2(-50, 0),
-                                                otherConnPos) < 25 &&
-                ImGui::IsMouseClicked(0))
-            {
-                if (!ImGui::GetIO().KeyShift)
-                {
-                    context->deselectAll(nodes);
-                }
-                conn.selected = true;
-                context->clickedInSomething = true;
-            }
-
-            if (conn.selected)
-            {
-                ImU32 invColor = getConnectorColor(nodeType.outputs[i].first) ^ 0x00FFFFFF;
-                draw->AddBezierCurve(connPos, connPos + ImVec2(50, 0), otherConnPos + ImVec2(-50, 0), otherConnPos, invColor, 4);
-            }
-            draw->AddBezierCurve(
-                connPos,
-                connPos + ImVec2(50, 0),
-                otherConnPos + ImVec2(-50, 0),
-                otherConnPos,
-                getConnectorColor(nodeType.outputs[i].first), 2);
-        }
-
-        ++i;
     }
 }
 
@@ -294,72 +182,61 @@ void Node::doPinCircle(ImDrawList *draw, ImVec2 pos, ConnectionType connType, bo
     }
 }
 
-void Node::doPinValue(const std::string &label, ConnectionType connType, std::any &input)
+bool Node::doPinValue(const std::string &label, GraphStorage &storage, const Pin &pin)
 {
-    switch (connType)
-    {
-    case ConnectionType::Sequence:
+    // connected pins take their value from the link
+    if (pin.type == ConnectionType::Sequence || !pin.edge.IsNull())
     {
         ImGui::Text((label.substr(0, label.find("##"))).c_str());
+        return false;
     }
-    break;
-    case ConnectionType::Int:
+
+    bool changed = false;
+    switch (pin.type)
     {
-        if (!input.has_value())
-            input = 0;
-        if (input.type() != typeid(int))
-        {
-            ImGui::Text((label.substr(0, label.find("##"))).c_str());
-            return;
-        }
-        int val = std::any_cast<int>(input);
-        ImGui::InputInt(label.c_str(), &val, 0, 0);
-        input = val;
-    }
-    break;
+    case ConnectionType::Int:
+        changed = ImGui::InputInt(label.c_str(), &storage.ints[pin.row], 0, 0);
+        break;
     case ConnectionType::Float:
-    {
-        if (!input.has_value())
-            input = 0.f;
-        if (input.type() != typeid(float))
-        {
-            ImGui::Text((label.substr(0, label.find("##"))).c_str());
-            return;
-        }
-        float val = std::any_cast<float>(input);
-        ImGui::InputFloat(label.c_str(), &val, 0, 0);
-        input = val;
-    }
-    break;
+        changed = ImGui::InputFloat(label.c_str(), &storage.floats[pin.row], 0, 0);
+        break;
     case ConnectionType::String:
     {
-        if (!input.has_value())
-            input = std::string();
-        if (input.type() != typeid(std::string))
-        {
-            ImGui::Text((label.substr(0, label.find("##"))).c_str());
-            return;
-        }
-        std::string val = std::any_cast<std::string>(input);
+        std::string &value = storage.strings[pin.row];
+        std::string val = value;
         val.resize(1024, '\0');
-        ImGui::InputText(label.c_str(), &val[0], 1024);
-        input = std::string(val.c_str());
+        changed = ImGui::InputText(label.c_str(), &val[0], 1024);
+        value = std::string(val.c_str());
     }
     break;
     case ConnectionType::Vector2:
-    {
-        if (!input.has_value())
-            input = ImVec2(0, 0);
-        if (input.type() != typeid(ImVec2))
-        {
-            ImGui::Text((label.substr(0, label.find("##"))).c_str());
-            return;
-        }
-        ImVec2 val = std::any_cast<ImVec2>(input);
-        ImGui::InputFloat2(label.c_str(), &val.x);
-        input = val;
+        changed = ImGui::InputFloat2(label.c_str(), &storage.vector2s[pin.row].x);
+        break;
+    default:
+        break;
     }
-    break;
+    return changed;
+}
+
+void Node::doPinOutput(const std::string &label, const GraphStorage &storage, const Pin &pin)
+{
+    switch (pin.type)
+    {
+    case ConnectionType::Int:
+        ImGui::LabelText(label.c_str(), "%d", storage.ints[pin.row]);
+        break;
+    case ConnectionType::Float:
+        ImGui::LabelText(label.c_str(), "%.3f", storage.floats[pin.row]);
+        break;
+    case ConnectionType::String:
+        ImGui::LabelText(label.c_str(), "%s", storage.strings[pin.row].c_str());
+        break;
+    case ConnectionType::Vector2:
+        ImGui::LabelText(label.c_str(), "%.3f, %.3f", storage.vector2s[pin.row].x, storage.vector2s[pin.row].y);
+        break;
+    default:
+        ImGui::Text((label.substr(0, label.find("##"))).c_str());
+        break;
     }
 }
 } // namespace spacechase0
\ No newline at end of file
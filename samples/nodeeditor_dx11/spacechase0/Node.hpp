@@ -1,10 +1,14 @@
 #pragma once
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 #include <memory>
 #include <string>
-#include <any>
+#include <cfloat>
+#include <cstdint>
 #include <imgui.h>
+#include "../nodegraph/bezier_cache.h"
+#include "../nodegraph/node_pool.h"
 
 namespace spacechase0
 {
@@ -42,6 +46,13 @@ struct NodeType
 };
 
 struct Context;
+class GraphStorage;
+
+using nodegraph::NodeHandle;
+using nodegraph::EdgeHandle;
+using nodegraph::BezierCache;
+
+struct Pin;
 struct Node
 {
 private:
@@ -50,33 +61,30 @@ private:
     bool collapsed = false;
 
 public:
-    bool selected = false;
+    // inputs then outputs, contiguous in GraphStorage::pins
+    uint32_t firstPin = 0;
+    int inputCount = 0;
+    int outputCount = 0;
 
-    std::vector<std::any> inputs;
-    std::vector<std::any> outputs;
+    void Draw(Context *context, ImDrawList *draw, NodeHandle self, const NodeType &nodeType, const ImVec2 &offset, const ImVec2 &mouse,
+              GraphStorage &storage);
 
-    void Draw(Context *context, ImDrawList *draw, int n, const NodeType &nodeType, const ImVec2 &offset, const ImVec2 &mouse,
-              const std::vector<std::unique_ptr<Node>> &nodes,
-              const std::unordered_map<std::string, NodeType> &types);
+    ImVec2 getSize() const;
+    bool isVisible(const ImVec2 &clipMin, const ImVec2 &clipMax) const;
+
+    ImVec2 getInputConnectorPos(ImVec2 base, int index) const;
+    ImVec2 getOutputConnectorPos(ImVec2 base, int index) const;
 
 private:
-    void DrawContent(Context *context, ImDrawList *draw, int n, const NodeType &nodeType, const ImVec2 &offset, const ImVec2 &mouse,
-                     const std::vector<std::unique_ptr<Node>> &nodes,
-                     const std::unordered_map<std::string, NodeType> &types);
+    void DrawContent(Context *context, ImDrawList *draw, NodeHandle self, const NodeType &nodeType, const ImVec2 &offset, const ImVec2 &mouse,
+                     GraphStorage &storage);
     void doPinCircle(ImDrawList *draw, ImVec2 pos, ConnectionType connType, bool filled);
-    void doPinValue(const std::string &label, ConnectionType connType, std::any &input);
+    // true if the user changed the value
+    bool doPinValue(const std::string &label, GraphStorage &storage, const Pin &pin);
+    // read only, Graph::evaluate() writes the outputs of the nodes on screen every frame
+    void doPinOutput(const std::string &label, const GraphStorage &storage, const Pin &pin);
     friend class Graph;
-
-    ImVec2 getInputConnectorPos(ImVec2 base, int index);
-
-    ImVec2 getOutputConnectorPos(ImVec2 base, int index);
-};
-
-struct Connection
-{
-    Node *other = nullptr;
-    int index = 0;
-    bool selected = false;
+    friend class GraphStorage;
 };
 
 } // namespace spacechase0
\ No newline at end of file
@@ -1,5 +1,4 @@
 ﻿
-#include <any>
 #include <cmath>
 #include <iostream>
 #include <imgui.h>
@@ -34,25 +33,97 @@ void Graph::update()
     ImVec2 mouse = ImGui::GetIO().MousePos;
 
     m_context.NewFrame();
+    m_visibleNodes.clear();
 
     DrawGrid(draw, pos, size, m_scroll);
 
-    // Draw nodes
-    int n = 0;
+    // Draw nodes, only nodes and links overlapping the playground are submitted to the draw list
     auto offset = pos + m_scroll;
-    for (auto &node : nodes)
+    ImVec2 clipMin = ImVec2(0, 0) - m_scroll;
+    ImVec2 clipMax = size - m_scroll;
+
+    // drag move, one offset for the whole selection
+    if (ImGui::IsMouseDown(0) && !storage.selectedNodes.IsEmpty())
+    {
+        m_context.dragging = true;
+        for (NodeHandle handle : storage.selectedNodes)
+            storage.get(handle).position += ImGui::GetIO().MouseDelta;
+    }
+
+    for (uint32_t i = 0; i < storage.pool.GetNodeCount(); ++i)
     {
-        node->Draw(&m_context, draw, n++, types[node->type], offset, mouse, nodes, types);
+        NodeHandle handle = storage.pool.GetNodeHandleAt(i);
+        Node &node = storage.pool.GetNodeAt(i);
+        if (node.isVisible(clipMin, clipMax))
+        {
+            node.Draw(&m_context, draw, handle, types[node.type], offset, mouse, storage);
+            m_visibleNodes.push_back(handle);
+        }
+    }
+
+    // links are drawn by their source node, also when that node itself is off screen
+    for (uint32_t e = 0; e < storage.pool.GetEdgeCount(); ++e)
+    {
+        auto &edge = storage.pool.GetEdgeAt(e);
+        Link &link = edge.Data;
+        const Node &from = storage.get(edge.From);
+        if (from.collapsed)
+            continue;
+
+        ImVec2 connPos = from.getOutputConnectorPos(offset, edge.Output) + ImVec2(8, 8);
+        ImVec2 otherConnPos = storage.get(edge.To).getInputConnectorPos(offset, edge.Input) + ImVec2(8, 8);
+
+        BezierCache &curve = link.curve;
+        curve.Update(connPos - offset, otherConnPos - offset, 50);
+        if (!curve.Overlaps(clipMin, clipMax))
+            continue;
+
+        if (ImGui::IsMouseClicked(0) && curve.GetSquaredDistance(mouse - offset, 5) < 25)
+        {
+            if (!ImGui::GetIO().KeyShift)
+                storage.deselectAll();
+            storage.selectedLinks.Add(storage.pool.GetEdgeHandleAt(e));
+            m_context.clickedInSomething = true;
+        }
+
+        ImVec2 points[BezierCache::Segments + 1];
+        for (int s = 0; s <= BezierCache::Segments; ++s)
+            points[s] = offset + curve.GetPoint(s);
+
+        ImU32 color = getConnectorColor(storage.pins[link.fromPin].type);
+        if (storage.selectedLinks.Contains(storage.pool.GetEdgeHandleAt(e)))
+            draw->AddPolyline(points, BezierCache::Segments + 1, color ^ 0x00FFFFFF, false, 4);
+        draw->AddPolyline(points, BezierCache::Segments + 1, color, false, 2);
+    }
+
+    // a link being dragged to the mouse
+    if (m_context.connDragging && storage.isValid(m_context.connNode))
+    {
+        const Node &node = storage.get(m_context.connNode);
+        if (!node.collapsed)
+        {
+            ImVec2 connPos = (m_context.connSelInput
+                                  ? node.getInputConnectorPos(offset, m_context.connIndex)
+                                  : node.getOutputConnectorPos(offset, m_context.connIndex)) +
+                             ImVec2(8, 8);
+            const Pin &pin = m_context.connSelInput ? storage.input(node, m_context.connIndex) : storage.output(node, m_context.connIndex);
+            draw->AddBezierCurve(connPos, connPos + ImVec2(50, 0),
+                                 mouse + ImVec2(-50, 0), mouse,
+                                 getConnectorColor(pin.type), 2);
+        }
     }
 
     if ((ImGui::IsMouseClicked(0) && !m_context.clickedInSomething) || ImGui::IsMouseClicked(1))
     {
         // 何もないところを左クリック
         // 右クリック
-        m_context.deselectAll(nodes);
+        storage.deselectAll();
         m_context.clear();
     }
 
+    if (ImGui::IsWindowFocused() && ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Delete]))
+        deletePressed();
+
     // Scrolling
     if (ImGui::IsWindowHovered() && !ImGui::IsAnyItemActive() && ImGui::IsMouseDown(2))
     {
@@ -70,12 +141,7 @@ void Graph::update()
             const auto &type = type_.second;
             if (type.canUserCreate && ImGui::MenuItem(type_.first.c_str()))
             {
-                auto node = std::make_unique<Node>();
-                node->position = mouse - m_scroll;
-                node->type = type_.first;
-                node->inputs.resize(type.inputs.size());
-                node->outputs.resize(type.outputs.size());
-                nodes.push_back(std::move(node));
+                storage.add(type_.first, type, mouse - m_scroll);
             }
         }
         ImGui::EndPopup();
@@ -84,65 +150,18 @@ void Graph::update()
     ImGui::EndChild();
 }
 
-// void Graph::deletePressed()
-// {
-//     if (nodes.size() == 0)
-//         return;
-
-//     for (auto &node : nodes)
-//     {
-//         for (auto &input : node->inputs)
-//         {
-//             if (input.type() == typeid(Connection))
-//             {
-//                 Connection conn = std::any_cast<Connection>(input);
-//                 if (!conn.selected)
-//                     continue;
-
-//                 conn.other->outputs[conn.index] = std::any();
-//                 input = std::any();
-//             }
-//         }
-//         for (auto &output : node->outputs)
-//         {
-//             if (output.type() == typeid(Connection))
-//             {
-//                 Connection conn = std::any_cast<Connection>(output);
-//                 if (!conn.selected)
-//                     continue;
-
-//                 conn.other->inputs[conn.index] = std::any();
-//                 output = std::any();
-//             }
-//         }
-//     }
-
-//     for (int i = (int)nodes.size() - 1; i >= 0; --i)
-//     {
-//         if (nodes[i]->selected)
-//         {
-//             for (auto &input : nodes[i]->inputs)
-//             {
-//                 if (input.type() == typeid(Connection))
-//                 {
-//                     Connection conn = std::any_cast<Connection>(input);
-//                     conn.other->outputs[conn.index] = std::any();
-//                     input = std::any();
-//                 }
-//             }
-//             for (auto &output : nodes[i]->outputs)
-//             {
-//                 if (output.type() == typeid(Connection))
-//                 {
-//                     Connection conn = std::any_cast<Connection>(output);
-//                     conn.other->inputs[conn.index] = std::any();
-//                     output = std::any();
-//                 }
-//             }
-//             nodes.erase(nodes.begin() + i);
-//         }
-//     }
-// }
+void Graph::deletePressed()
+{
+    // disconnect() drops a link from the selection, walk a copy
+    std::vector<EdgeHandle> links(storage.selectedLinks.begin(), storage.selectedLinks.end());
+    storage.selectedLinks.Clear();
+    for (EdgeHandle link : links)
+        storage.disconnect(link);
+    storage.remove(std::vector<NodeHandle>(storage.selectedNodes.begin(), storage.selectedNodes.end()));
+
+    if (!storage.isValid(m_context.connNode))
+        m_context.clear();
+}
 
 Graph::Graph()
 {
@@ -153,45 +172,18 @@ Graph::Graph()
     types.insert(std::make_pair<std::string, NodeType>("Int ToString", {{{ConnectionType::Int, "Input"}}, {{ConnectionType::String, "Output"}}}));
     types.insert(std::make_pair<std::string, NodeType>("Float ToString", {{{ConnectionType::Float, "Input"}}, {{ConnectionType::String, "Output"}}}));
     types.insert(std::make_pair<std::string, NodeType>("Split Vec2", {{{ConnectionType::Vector2, "Input"}}, {{ConnectionType::Int, "X"}, {ConnectionType::Int, "Y"}}}));
-    auto startNode = std::make_unique<Node>();
-    startNode->type = "Start";
-    startNode->outputs.resize(1);
-
-    auto floatNode = std::make_unique<Node>();
-    floatNode->type = "Float ToString";
-    floatNode->inputs.resize(1);
-    floatNode->inputs[0] = 3.14f;
-    floatNode->outputs.resize(1);
-    floatNode->position = ImVec2(100, 150);
-
-    auto printNode = std::make_unique<Node>();
-    printNode->type = "Print";
-    printNode->inputs.resize(2);
-    printNode->outputs.resize(1);
-    printNode->position = ImVec2(400, 0);
-
-    Connection conn1o;
-    conn1o.other = startNode.get();
-    conn1o.index = 0;
-    printNode->inputs[0] = conn1o;
-    Connection conn1i;
-    conn1i.other = printNode.get();
-    conn1i.index = 0;
-    startNode->outputs[0] = conn1i;
-
-    Connection conn2o;
-    conn2o.other = floatNode.get();
-    conn2o.index = 0;
-    printNode->inputs[1] = conn2o;
-    Connection conn2i;
-    conn2i.other = printNode.get();
-    conn2i.index = 1;
-    floatNode->outputs[0] = conn2i;
-    floatNode->selected = true;
-
-    nodes.push_back(std::move(startNode));
-    nodes.push_back(std::move(floatNode));
-    nodes.push_back(std::move(printNode));
+    NodeHandle startNode = storage.add("Start", types["Start"], ImVec2(0, 0));
+
+    NodeHandle floatNode = storage.add("Float ToString", types["Float ToString"], ImVec2(100, 150));
+    storage.floats[storage.input(storage.get(floatNode), 0).row] = 3.14f;
+
+    NodeHandle printNode = storage.add("Print", types["Print"], ImVec2(400, 0));
+
+    storage.connect(startNode, 0, printNode, 0);
+    storage.connect(floatNode, 0, printNode, 1);
+    storage.selectedNodes.Add(floatNode);
+
+    registerKernels(m_registry);
 }
 
 } // namespace spacechase0
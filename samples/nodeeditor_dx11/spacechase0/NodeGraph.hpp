@@ -1,7 +1,6 @@
 #ifndef NODEGRAPH_HPP
 #define NODEGRAPH_HPP
 
-#include <any>
 #include <imgui.h>
 #include <vector>
 #include <string>
@@ -10,6 +9,8 @@
 #include <algorithm>
 #include "Node.hpp"
 #include "Context.hpp"
+#include "GraphStorage.hpp"
+#include "../dataflow/dataflow.h"
 
 namespace spacechase0
 {
@@ -18,19 +19,43 @@ class Graph
 {
 public:
     Graph();
-    std::vector<std::unique_ptr<Node>> nodes;
+    GraphStorage storage;
     std::unordered_map<std::string, NodeType> types;
 
     void update();
-    // void deletePressed();
+    // after update(), bring the output pins of the nodes on screen up to date, running only the stale nodes they
+    // depend on
+    void evaluate();
+
+    // a kernel per node type. kernels have no side effects, Print passes its string to an extra output that
+    // evaluate() logs
+    void registerKernels(dataflow::KernelRegistry &registry) const;
+    // one dataflow node per node, in storage order, unconnected inputs take their pin values.
+    // false if a node type has no kernel.
+    bool buildDataflowGraph(dataflow::Graph &graph);
+    // after update(), forward this frame's pin edits to a program compiled from buildDataflowGraph(), so that
+    // pulling an output reruns only the nodes downstream of the edits
+    void applyPinEdits(dataflow::Program &program) const;
+    // removes the selected links and nodes, O(selected) plus the degree of every node
+    void deletePressed();
 
 private:
     Context m_context;
     ImVec2 m_scroll = ImVec2(0, 0);
+    std::vector<NodeHandle> m_visibleNodes; // drawn by the last update()
+
+    dataflow::KernelRegistry m_registry;
+    dataflow::Graph m_dataflowGraph{m_registry};
+    dataflow::Program m_program;
+    uint64_t m_compiledVersion = ~0ull; // storage.topologyVersion m_program was compiled from
+    bool m_compiled = false;            // false if the graph has a cycle or a node type without kernel
+    // from the last buildDataflowGraph()
+    std::vector<dataflow::NodeId> m_dataflowIds; // per handle index
+    std::vector<NodeHandle> m_dataflowNodes;     // per dataflow id
+    // Print sinks, forced by every evaluate() and logged when their string changed. the port version last logged
+    std::vector<std::pair<dataflow::NodeId, uint64_t>> m_printNodes;
 };
 
-float GetSquaredDistanceToBezierCurve(const ImVec2 &point, const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p3, const ImVec2 &p4);
-
 } // namespace spacechase0
 
 #endif // NODEGRAPH_HPP
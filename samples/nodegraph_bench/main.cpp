@@ -0,0 +1,981 @@
+///
+/// Headless benchmarks for the node editor data structures, across graph sizes.
+///
+/// nodegraph_bench [spatial|bezier|dataflow|incremental|tape|pool|selection] [node counts...]
+///
+#include <ChemiaAion/Node.h>
+#include <ChemiaAion/SpatialIndex.h>
+#include <dataflow/dataflow.h>
+#include <dataflow/tape.h>
+#include <dataflow/task_pool.h>
+#include <nodegraph/bezier_cache.h>
+#include <nodegraph/node_pool.h>
+#include <nodegraph/selection.h>
+#include <plog/Log.h>
+#include <plog/Appenders/ConsoleAppender.h>
+#include <plog/Formatters/TxtFormatter.h>
+#include <plog/Init.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <math.h>
+#include <memory>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+static double Ms(clock_type::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - begin).count();
+}
+
+// nodes on a jittered grid, roughly the density a user lays out by hand
+static std::vector<std::unique_ptr<ChemiaAion::Node>> CreateChemiaAionNodes(int count, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> jitter(-30.0f, 30.0f);
+    const int columns = (int)sqrtf((float)count) + 1;
+
+    std::vector<std::unique_ptr<ChemiaAion::Node>> nodes;
+    nodes.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        auto node = std::make_unique<ChemiaAion::Node>();
+        node->id_ = i + 1;
+        node->position_ = ImVec2((i % columns) * 220.0f + jitter(rng), (i / columns) * 160.0f + jitter(rng));
+        node->size_ = ImVec2(150.0f, 100.0f);
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
+
+static bool Contains(const ChemiaAion::Node &node, const ImVec2 &point, float margin)
+{
+    return point.x >= node.position_.x - margin && point.y >= node.position_.y - margin &&
+           point.x <= node.position_.x + node.size_.x + margin && point.y <= node.position_.y + node.size_.y + margin;
+}
+
+static bool Inside(const ChemiaAion::Node &node, const ImVec2 &min, const ImVec2 &max)
+{
+    return node.position_.x >= min.x && node.position_.y >= min.y &&
+           node.position_.x + node.size_.x <= max.x && node.position_.y + node.size_.y <= max.y;
+}
+
+// hover (point), box selection (screen sized rectangle) and drag (re-bucketing) queries, linear scan vs grid
+static void BenchSpatial(const std::vector<int> &sizes)
+{
+    const int point_queries = 10000;
+    const int rect_queries = 200;
+    const int drag_frames = 1000;
+    const int drag_nodes = 100;
+
+    for (int size : sizes)
+    {
+        std::mt19937 rng(size);
+        auto nodes = CreateChemiaAionNodes(size, rng);
+        const ImVec2 extent = nodes.back()->position_;
+        std::uniform_real_distribution<float> x(0.0f, extent.x);
+        std::uniform_real_distribution<float> y(0.0f, extent.y);
+
+        auto begin = clock_type::now();
+        ChemiaAion::SpatialIndex index;
+        for (auto &node : nodes)
+        {
+            index.Update(node.get());
+        }
+        const double build_ms = Ms(begin);
+
+        std::vector<ImVec2> points(point_queries);
+        for (auto &point : points)
+        {
+            point = ImVec2(x(rng), y(rng));
+        }
+
+        size_t linear_hits = 0;
+        begin = clock_type::now();
+        for (auto &point : points)
+        {
+            for (auto &node : nodes)
+            {
+                if (Contains(*node, point, 2.0f))
+                {
+                    ++linear_hits;
+                    break;
+                }
+            }
+        }
+        const double linear_point_ms = Ms(begin);
+
+        size_t index_hits = 0;
+        std::vector<ChemiaAion::Node *> result;
+        begin = clock_type::now();
+        for (auto &point : points)
+        {
+            result.clear();
+            index.QueryPoint(point, 2.0f, result);
+            index_hits += result.empty() ? 0 : 1;
+        }
+        const double index_point_ms = Ms(begin);
+
+        // 1920x1080 at the minimum zoom of 0.3
+        const ImVec2 rect_size(1920.0f / 0.3f, 1080.0f / 0.3f);
+        std::vector<ImVec2> rects(rect_queries);
+        for (auto &rect : rects)
+        {
+            rect = ImVec2(x(rng) - rect_size.x / 2.0f, y(rng) - rect_size.y / 2.0f);
+        }
+
+        size_t linear_selected = 0;
+        begin = clock_type::now();
+        for (auto &rect : rects)
+        {
+            ImVec2 max(rect.x + rect_size.x, rect.y + rect_size.y);
+            for (auto &node : nodes)
+            {
+                linear_selected += Inside(*node, rect, max) ? 1 : 0;
+            }
+        }
+        const double linear_rect_ms = Ms(begin);
+
+        size_t index_selected = 0;
+        begin = clock_type::now();
+        for (auto &rect : rects)
+        {
+            result.clear();
+            index.QueryRect(rect, ImVec2(rect.x + rect_size.x, rect.y + rect_size.y), true, result);
+            index_selected += result.size();
+        }
+        const double index_rect_ms = Ms(begin);
+
+        begin = clock_type::now();
+        for (int frame = 0; frame < drag_frames; ++frame)
+        {
+            for (int i = 0; i < drag_nodes && i < size; ++i)
+            {
+                auto &node = nodes[(i * 7919) % size];
+                node->position_.x += 1.0f;
+                index.Update(node.get());
+            }
+        }
+        const double drag_ms = Ms(begin);
+
+        if (linear_hits != index_hits || linear_selected != index_selected)
+        {
+            LOGE << size << " nodes: grid disagrees with the linear scan (" << index_hits << "/" << linear_hits << " hits, "
+                 << index_selected << "/" << linear_selected << " selected)";
+        }
+
+        LOGI << size << " nodes: build " << build_ms << " ms"
+             << ", hover " << linear_point_ms * 1000.0 / point_queries << " -> " << index_point_ms * 1000.0 / point_queries << " us"
+             << ", box select " << linear_rect_ms / rect_queries << " -> " << index_rect_ms / rect_queries << " ms"
+             << ", drag " << drag_nodes << " nodes " << drag_ms * 1000.0 / drag_frames << " us/frame";
+    }
+}
+
+// what the editors did before caching: 16 cubic samples per link and query
+static float GetSquaredDistanceToBezierCurve(const ImVec2 &point, const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p3, const ImVec2 &p4)
+{
+    float min_distance2 = FLT_MAX;
+    ImVec2 last = p1;
+    for (int i = 1; i <= 16; ++i)
+    {
+        const float t = (float)i / 16.0f;
+        const float u = 1.0f - t;
+        const float w0 = u * u * u, w1 = 3 * u * u * t, w2 = 3 * u * t * t, w3 = t * t * t;
+        const ImVec2 sample(w0 * p1.x + w1 * p2.x + w2 * p3.x + w3 * p4.x, w0 * p1.y + w1 * p2.y + w2 * p3.y + w3 * p4.y);
+
+        const float dx = sample.x - last.x, dy = sample.y - last.y;
+        const float px = point.x - last.x, py = point.y - last.y;
+        const float length2 = dx * dx + dy * dy;
+        const float t_segment = length2 > 0.0f ? std::min(std::max((px * dx + py * dy) / length2, 0.0f), 1.0f) : 0.0f;
+        const float ex = px - t_segment * dx, ey = py - t_segment * dy;
+        min_distance2 = std::min(min_distance2, ex * ex + ey * ey);
+
+        last = sample;
+    }
+    return min_distance2;
+}
+
+// one hover test per link per frame as the editors do, re-evaluating every curve vs the cached polyline
+static void BenchBezier(const std::vector<int> &sizes)
+{
+    const int frames = 100;
+
+    for (int size : sizes)
+    {
+        std::mt19937 rng(size);
+        std::uniform_real_distribution<float> x(0.0f, 20000.0f);
+        std::uniform_real_distribution<float> y(0.0f, 20000.0f);
+        std::uniform_real_distribution<float> span(-400.0f, 400.0f);
+
+        std::vector<ImVec2> from(size), to(size);
+        for (int i = 0; i < size; ++i)
+        {
+            from[i] = ImVec2(x(rng), y(rng));
+            to[i] = ImVec2(from[i].x + 100.0f + fabsf(span(rng)), from[i].y + span(rng));
+        }
+
+        std::vector<ImVec2> mice(frames);
+        for (auto &mouse : mice)
+        {
+            mouse = ImVec2(x(rng), y(rng));
+        }
+
+        size_t direct_hits = 0;
+        auto begin = clock_type::now();
+        for (auto &mouse : mice)
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                const ImVec2 p2(from[i].x + 50.0f, from[i].y);
+                const ImVec2 p3(to[i].x - 50.0f, to[i].y);
+                direct_hits += GetSquaredDistanceToBezierCurve(mouse, from[i], p2, p3, to[i]) < 100.0f ? 1 : 0;
+            }
+        }
+        const double direct_ms = Ms(begin);
+
+        std::vector<nodegraph::BezierCache> curves(size);
+        begin = clock_type::now();
+        for (int i = 0; i < size; ++i)
+        {
+            curves[i].Update(from[i], to[i], 50.0f);
+        }
+        const double build_ms = Ms(begin);
+
+        size_t cached_hits = 0;
+        begin = clock_type::now();
+        for (auto &mouse : mice)
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                curves[i].Update(from[i], to[i], 50.0f); // endpoints did not move, a compare
+                cached_hits += curves[i].GetSquaredDistance(mouse, 10.0f) < 100.0f ? 1 : 0;
+            }
+        }
+        const double cached_ms = Ms(begin);
+
+        // the worst case, the mouse inside every curve's bounds
+        begin = clock_type::now();
+        float sink = 0.0f;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                sink += curves[i].GetSquaredDistance(from[i], 10.0f);
+            }
+        }
+        const double near_ms = Ms(begin);
+
+        LOGI << size << " links: hover " << direct_ms / frames << " -> " << cached_ms / frames << " ms/frame"
+             << " (" << direct_hits << "/" << cached_hits << " hits), all near " << near_ms / frames << " ms/frame"
+             << ", build " << build_ms << " ms" << (sink < 0.0f ? "" : "");
+    }
+}
+
+// random DAG, every node reads two of the 1000 nodes before it: wide enough to run in parallel, deep enough to order
+static void CreateDataflowGraph(dataflow::Graph &graph, int count, std::mt19937 &rng)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        dataflow::NodeId node = graph.AddNode(i < 2 ? "Constant" : "Mix");
+        if (i < 2)
+        {
+            graph.SetConstant(node, 0, (float)(i + 1));
+            continue;
+        }
+        std::uniform_int_distribution<int> source(std::max(0, i - 1000), i - 1);
+        graph.Connect(source(rng), 0, node, 0);
+        graph.Connect(source(rng), 0, node, 1);
+    }
+}
+
+// compile, then a full evaluation on the calling thread vs the work-stealing pool at 1, 2, 4 and 8 threads, with a trivial
+// and an expensive kernel. the speedup is bounded by the hardware threads, which are logged
+static void BenchDataflow(const std::vector<int> &sizes)
+{
+    using namespace dataflow;
+    const int runs = 10;
+
+    LOGI << std::thread::hardware_concurrency() << " hardware threads";
+    std::vector<std::unique_ptr<dataflow::TaskPool>> pools;
+    for (int threads : {1, 2, 4, 8})
+    {
+        pools.emplace_back(new dataflow::TaskPool(threads));
+    }
+    for (int work : {0, 200})
+    {
+        KernelRegistry registry;
+        registry.Register("Constant", {ValueType::Float}, {ValueType::Float}, [](const Value *const *in, Value *out) {
+            out[0] = *in[0];
+        });
+        registry.Register("Mix", {ValueType::Float, ValueType::Float}, {ValueType::Float}, [work](const Value *const *in, Value *out) {
+            float value = 0.5f * (std::get<float>(*in[0]) + std::get<float>(*in[1]));
+            for (int i = 0; i < work; ++i)
+            {
+                value = sinf(value) + 0.5f;
+            }
+            out[0] = value;
+        });
+
+        for (int size : sizes)
+        {
+            std::mt19937 rng(size);
+            Graph graph(registry);
+            CreateDataflowGraph(graph, size, rng);
+
+            Program program;
+            auto begin = clock_type::now();
+            if (!program.Compile(graph))
+            {
+                return;
+            }
+            const double compile_ms = Ms(begin);
+
+            begin = clock_type::now();
+            for (int run = 0; run < runs; ++run)
+            {
+                program.Execute();
+            }
+            const double serial_ms = Ms(begin);
+            const float serial_result = std::get<float>(program.GetOutput(size - 1, 0));
+
+            LOGI << size << " nodes, " << work << " sinf per node: compile " << compile_ms << " ms"
+                 << ", evaluate " << serial_ms / runs << " ms on the calling thread";
+
+            for (auto &pool : pools)
+            {
+                begin = clock_type::now();
+                for (int run = 0; run < runs; ++run)
+                {
+                    program.Execute(pool.get());
+                }
+                const double parallel_ms = Ms(begin);
+                const float parallel_result = std::get<float>(program.GetOutput(size - 1, 0));
+
+                if (serial_result != parallel_result)
+                {
+                    LOGE << size << " nodes: parallel result " << parallel_result << " differs from " << serial_result;
+                }
+
+                LOGI << "    " << pool->GetThreadCount() << " threads: " << parallel_ms / runs << " ms, speedup "
+                     << serial_ms / parallel_ms;
+            }
+        }
+    }
+
+    // a cycle is reported, not run
+    KernelRegistry registry;
+    registry.Register("Pass", {ValueType::Float}, {ValueType::Float}, [](const Value *const *in, Value *out) { out[0] = *in[0]; });
+    Graph graph(registry);
+    for (int i = 0; i < 4; ++i)
+    {
+        graph.AddNode("Pass");
+    }
+    graph.Connect(0, 0, 1, 0);
+    graph.Connect(1, 0, 2, 0);
+    graph.Connect(2, 0, 1, 0); // replaces 0 -> 1, 1 -> 2 -> 1 is the loop
+    graph.Connect(2, 0, 3, 0);
+    Program program;
+    if (program.Compile(graph) || program.GetCycle().size() != 2)
+    {
+        LOGE << "cycle not detected";
+    }
+}
+
+static void RegisterMixKernels(dataflow::KernelRegistry &registry)
+{
+    using namespace dataflow;
+    registry.Register(
+        "Constant", {ValueType::Float}, {ValueType::Float},
+        [](const Value *const *in, Value *out) { out[0] = *in[0]; },
+        [](const float *const *in, float *const *out, uint32_t count) { memcpy(out[0], in[0], count * sizeof(float)); });
+    registry.Register(
+        "Mix", {ValueType::Float, ValueType::Float}, {ValueType::Float},
+        [](const Value *const *in, Value *out) { out[0] = 0.5f * (std::get<float>(*in[0]) + std::get<float>(*in[1])); },
+        [](const float *const *in, float *const *out, uint32_t count) {
+            const float *a = in[0], *b = in[1];
+            float *result = out[0];
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                result[i] = 0.5f * (a[i] + b[i]);
+            }
+        });
+    registry.Register(
+        "Clamp", {ValueType::Float}, {ValueType::Float},
+        [](const Value *const *in, Value *out) { out[0] = std::min(std::get<float>(*in[0]), 1.0f); },
+        [](const float *const *in, float *const *out, uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                out[0][i] = std::min(in[0][i], 1.0f);
+            }
+        });
+}
+
+// independent lanes of random DAGs: an edit in a lane can only reach the rest of that lane. Every other node of a
+// lane takes a constant as its second input, the constants stand in for pin values the user edits.
+static void CreateLanes(dataflow::Graph &graph, int count, int lanes, std::mt19937 &rng, std::vector<dataflow::NodeId> &sinks)
+{
+    const int lane_size = std::max(count / lanes, 2);
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        const dataflow::NodeId first = graph.AddNode("Constant");
+        graph.SetConstant(first, 0, (float)lane);
+        for (int i = 1; i < lane_size; ++i)
+        {
+            const dataflow::NodeId node = graph.AddNode("Mix");
+            std::uniform_int_distribution<int> source(std::max(0, i - 16), i - 1);
+            graph.Connect(first + source(rng), 0, node, 0);
+            if (i % 2 == 0)
+            {
+                graph.Connect(first + source(rng), 0, node, 1);
+            }
+        }
+        sinks.push_back(first + lane_size - 1);
+    }
+}
+
+// one edited constant, then the last node of every lane pulled as if displayed, vs evaluating everything
+static void BenchIncremental(const std::vector<int> &sizes)
+{
+    using namespace dataflow;
+    KernelRegistry registry;
+    RegisterMixKernels(registry);
+    const int lanes = 100;
+
+    for (int size : sizes)
+    {
+        std::mt19937 rng(size);
+        Graph graph(registry);
+        std::vector<NodeId> sinks;
+        CreateLanes(graph, size, lanes, rng, sinks);
+        const int lane_size = (int)graph.Size() / lanes;
+
+        Program program;
+        if (!program.Compile(graph))
+        {
+            return;
+        }
+        auto begin = clock_type::now();
+        program.Execute();
+        const double full_us = Ms(begin) * 1000.0;
+
+        LOGI << size << " nodes in " << lanes << " lanes: full evaluation " << full_us << " us";
+        // odd nodes of the first lane, from its end to its start, so the downstream cone grows
+        for (int position : {lane_size - 1, lane_size * 7 / 8, lane_size / 2, 1})
+        {
+            const NodeId node = (NodeId)(position | 1);
+            const float value = std::get<float>(program.GetOutput(node, 0)) + 1.0f;
+
+            program.ResetStats();
+            begin = clock_type::now();
+            program.SetConstant(node, 1, value);
+            const double mark_us = Ms(begin) * 1000.0;
+
+            size_t stale = 0;
+            for (NodeId i = 0; i < (NodeId)graph.Size(); ++i)
+            {
+                stale += program.IsStale(i) ? 1 : 0;
+            }
+
+            begin = clock_type::now();
+            for (NodeId sink : sinks)
+            {
+                program.Pull(sink, 0);
+            }
+            const double pull_us = Ms(begin) * 1000.0;
+
+            LOGI << "  edit node " << node << ": " << stale << " stale, mark " << mark_us << " us, pull " << sinks.size()
+                 << " outputs " << pull_us << " us, " << program.GetStats().NodesRun << " nodes run";
+        }
+
+        std::vector<float> pulled;
+        for (NodeId sink : sinks)
+        {
+            pulled.push_back(std::get<float>(program.GetOutput(sink, 0)));
+        }
+        program.Execute();
+        for (size_t i = 0; i < sinks.size(); ++i)
+        {
+            if (pulled[i] != std::get<float>(program.GetOutput(sinks[i], 0)))
+            {
+                LOGE << size << " nodes: pulled output of node " << sinks[i] << " differs from a full evaluation";
+            }
+        }
+    }
+
+    // a change that does not get through a node stops there: Clamp(5) == Clamp(6)
+    for (int size : sizes)
+    {
+        Graph graph(registry);
+        NodeId source = graph.AddNode("Constant");
+        NodeId clamp = graph.AddNode("Clamp");
+        graph.SetConstant(source, 0, 5.0f);
+        graph.Connect(source, 0, clamp, 0);
+        NodeId last = clamp;
+        for (int i = 2; i < size; ++i)
+        {
+            NodeId node = graph.AddNode("Mix");
+            graph.Connect(last, 0, node, 0);
+            graph.Connect(clamp, 0, node, 1);
+            last = node;
+        }
+
+        Program program;
+        program.Compile(graph);
+        program.Pull(last, 0);
+        program.ResetStats();
+
+        auto begin = clock_type::now();
+        program.SetConstant(source, 0, 6.0f);
+        program.Pull(last, 0);
+        const double us = Ms(begin) * 1000.0;
+
+        LOGI << size << " node chain behind a clamp: edit reran " << program.GetStats().NodesRun << ", reused "
+             << program.GetStats().NodesReused << " in " << us << " us";
+    }
+}
+
+// one input swept over many samples: the whole graph walked per sample vs the tape (the sink's upstream nodes only),
+// one sample per call and batched
+static void BenchTape(const std::vector<int> &sizes)
+{
+    using namespace dataflow;
+    KernelRegistry registry;
+    RegisterMixKernels(registry);
+
+    for (int size : sizes)
+    {
+        std::mt19937 rng(size);
+        Graph graph(registry);
+        CreateDataflowGraph(graph, size, rng);
+        const NodeId sink = (NodeId)size - 1;
+        const uint32_t samples = (uint32_t)std::min(std::max(20000000 / size, 256), 65536);
+
+        auto begin = clock_type::now();
+        Tape tape;
+        if (!tape.Compile(graph, {{0, 0}}, {{sink, 0}}))
+        {
+            return;
+        }
+        const double compile_ms = Ms(begin);
+
+        std::vector<float> in(samples), walked(samples), scalar(samples), batched(samples);
+        for (uint32_t i = 0; i < samples; ++i)
+        {
+            in[i] = (float)i / samples;
+        }
+
+        Program program;
+        program.Compile(graph);
+        begin = clock_type::now();
+        for (uint32_t i = 0; i < samples; ++i)
+        {
+            program.SetConstant(0, 0, in[i]);
+            program.Execute();
+            walked[i] = std::get<float>(program.GetOutput(sink, 0));
+        }
+        const double walk_ms = Ms(begin);
+
+        begin = clock_type::now();
+        for (uint32_t i = 0; i < samples; ++i)
+        {
+            const float *input = &in[i];
+            float *output = &scalar[i];
+            tape.Execute(&input, &output, 1);
+        }
+        const double scalar_ms = Ms(begin);
+
+        begin = clock_type::now();
+        const float *input = in.data();
+        float *output = batched.data();
+        tape.Execute(&input, &output, samples);
+        const double batched_ms = Ms(begin);
+
+        if (walked != scalar || walked != batched)
+        {
+            LOGE << size << " nodes: the tape disagrees with the graph";
+        }
+
+        const double per = 1000.0 / samples; // ms -> us per sample
+        LOGI << size << " nodes, " << samples << " samples: compile " << compile_ms << " ms, " << tape.GetInstructionCount()
+             << " instructions, " << tape.GetFoldedCount() << " folded, " << tape.GetRegisterCount() << " registers"
+             << "; us per sample: walk " << walk_ms * per << ", tape " << scalar_ms * per << ", batched " << batched_ms * per;
+    }
+}
+
+// every node takes two links from random earlier nodes nearby, degree 4 on average
+template <typename Connect>
+static void CreateLinks(int count, std::mt19937 &rng, Connect connect)
+{
+    for (int i = 1; i < count; ++i)
+    {
+        std::uniform_int_distribution<int> source(std::max(0, i - 64), i - 1);
+        connect(source(rng), i, 0);
+        connect(source(rng), i, 1);
+    }
+}
+
+// what ChemiaAion did: raw back pointers, deleting rewrites every input and rebuilds the node array
+struct PointerNode
+{
+    bool selected = false;
+    PointerNode *inputs[2] = {};
+    uint32_t connections = 0;
+};
+
+// what edon did: links hold node indices, which every removal shifts
+struct IndexLink
+{
+    int from, to, input;
+};
+
+// bulk delete of a selection, one at a time deletes and link churn: node pool vs pointers and indices
+static void BenchPool(const std::vector<int> &sizes)
+{
+    using namespace nodegraph;
+    struct Empty
+    {
+    };
+
+    for (int size : sizes)
+    {
+        std::mt19937 rng(size);
+        const int selected_count = std::min(10000, size / 2);
+        std::vector<int> order(size);
+        for (int i = 0; i < size; ++i)
+        {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        std::vector<bool> selected(size, false);
+        for (int i = 0; i < selected_count; ++i)
+        {
+            selected[order[i]] = true;
+        }
+
+        // pool, node by node and in one sweep
+        NodePool<int, Empty> pool;
+        std::vector<NodeHandle> handles;
+        std::mt19937 link_rng;
+        auto create_pool = [&]() {
+            pool.Clear();
+            handles.clear();
+            for (int i = 0; i < size; ++i)
+            {
+                handles.push_back(pool.AddNode(i));
+            }
+            link_rng.seed(size);
+            CreateLinks(size, link_rng, [&](int from, int to, int input) { pool.Connect(handles[from], 0, handles[to], input); });
+        };
+        std::vector<NodeHandle> doomed;
+
+        create_pool();
+        const uint32_t edge_count = pool.GetEdgeCount();
+        auto begin = clock_type::now();
+        for (int i = 0; i < selected_count; ++i)
+        {
+            pool.RemoveNode(handles[order[i]]);
+        }
+        const double pool_each_ms = Ms(begin);
+
+        create_pool();
+        for (int i = 0; i < selected_count; ++i)
+        {
+            doomed.push_back(handles[order[i]]);
+        }
+        begin = clock_type::now();
+        pool.RemoveNodes(doomed.data(), doomed.size());
+        const double pool_ms = Ms(begin);
+
+        // pointers
+        std::vector<std::unique_ptr<PointerNode>> pointer_nodes;
+        for (int i = 0; i < size; ++i)
+        {
+            pointer_nodes.push_back(std::make_unique<PointerNode>());
+            pointer_nodes.back()->selected = selected[i];
+        }
+        link_rng.seed(size);
+        CreateLinks(size, link_rng, [&](int from, int to, int input) {
+            pointer_nodes[to]->inputs[input] = pointer_nodes[from].get();
+            pointer_nodes[from]->connections++;
+        });
+
+        begin = clock_type::now();
+        for (auto &node : pointer_nodes)
+        {
+            for (auto &input : node->inputs)
+            {
+                if (!input)
+                {
+                    continue;
+                }
+                if (node->selected)
+                {
+                    input->connections--;
+                }
+                if (input->selected)
+                {
+                    input = nullptr;
+                }
+            }
+        }
+        std::vector<std::unique_ptr<PointerNode>> replacement;
+        replacement.reserve(pointer_nodes.size());
+        for (auto &node : pointer_nodes)
+        {
+            if (!node->selected)
+            {
+                replacement.push_back(std::move(node));
+            }
+        }
+        pointer_nodes = std::move(replacement);
+        const double pointer_ms = Ms(begin);
+
+        // indices, compacted once for the whole selection
+        std::vector<int> index_nodes(size);
+        std::vector<IndexLink> index_links;
+        link_rng.seed(size);
+        CreateLinks(size, link_rng, [&](int from, int to, int input) { index_links.push_back({from, to, input}); });
+        std::vector<IndexLink> index_links_copy = index_links;
+
+        begin = clock_type::now();
+        std::vector<int> remap(size, -1);
+        int kept = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            if (!selected[i])
+            {
+                index_nodes[kept] = index_nodes[i];
+                remap[i] = kept++;
+            }
+        }
+        index_nodes.resize(kept);
+        size_t link_kept = 0;
+        for (auto &link : index_links)
+        {
+            if (remap[link.from] >= 0 && remap[link.to] >= 0)
+            {
+                index_links[link_kept++] = {remap[link.from], remap[link.to], link.input};
+            }
+        }
+        index_links.resize(link_kept);
+        const double index_ms = Ms(begin);
+
+        LOGI << size << " nodes, " << edge_count << " links, delete " << selected_count << " selected: pool " << pool_ms
+             << " ms (node by node " << pool_each_ms << " ms), pointers " << pointer_ms << " ms, indices " << index_ms << " ms";
+
+        // single deletes, as from a context menu: a few handles vs shifting indices of the whole graph
+        const int single_count = std::min(100, size / 4);
+        begin = clock_type::now();
+        for (int i = 0; i < single_count; ++i)
+        {
+            pool.RemoveNode(handles[order[selected_count + i]]);
+        }
+        const double pool_single_us = Ms(begin) * 1000.0 / single_count;
+
+        index_links = index_links_copy;
+        std::vector<int> position(size);
+        for (int i = 0; i < size; ++i)
+        {
+            position[i] = i;
+        }
+        begin = clock_type::now();
+        for (int i = 0; i < single_count; ++i)
+        {
+            const int removed = position[order[selected_count + i]];
+            size_t link_kept = 0;
+            for (auto &link : index_links)
+            {
+                if (link.from != removed && link.to != removed)
+                {
+                    index_links[link_kept++] = {link.from - (link.from > removed), link.to - (link.to > removed), link.input};
+                }
+            }
+            index_links.resize(link_kept);
+            for (auto &p : position)
+            {
+                p -= p > removed;
+            }
+        }
+        const double index_single_us = Ms(begin) * 1000.0 / single_count;
+
+        // link churn: disconnect a random link and connect it again
+        const int churn_count = std::min(1000, (int)pool.GetEdgeCount());
+        begin = clock_type::now();
+        for (int i = 0; i < churn_count; ++i)
+        {
+            const uint32_t at = rng() % pool.GetEdgeCount();
+            const auto &edge = pool.GetEdgeAt(at);
+            const NodeHandle from = edge.From, to = edge.To;
+            const uint32_t input = edge.Input;
+            pool.Disconnect(pool.GetEdgeHandleAt(at));
+            pool.Connect(from, 0, to, input);
+        }
+        const double pool_churn_us = Ms(begin) * 1000.0 / churn_count;
+
+        begin = clock_type::now();
+        for (int i = 0; i < churn_count; ++i)
+        {
+            const size_t at = rng() % index_links.size();
+            const IndexLink link = index_links[at];
+            index_links.erase(index_links.begin() + at);
+            index_links.push_back(link);
+        }
+        const double index_churn_us = Ms(begin) * 1000.0 / churn_count;
+
+        LOGI << "  single delete: pool " << pool_single_us << " us, indices " << index_single_us
+             << " us; disconnect + connect: pool " << pool_churn_us << " us, indices " << index_churn_us << " us";
+    }
+}
+
+// dragging a box selection of a tenth of the canvas: every frame scanning all nodes for the id_ sign and re-bucketing
+// each selected one, vs walking the selection set and re-bucketing it once on release
+static void BenchSelection(const std::vector<int> &sizes)
+{
+    const int drag_frames = 60;
+    const float drag_step = 10.0f;
+
+    for (int size : sizes)
+    {
+        std::mt19937 rng(size);
+        ChemiaAion::NodeGraph graph;
+        ChemiaAion::SpatialIndex index;
+        for (auto &node : CreateChemiaAionNodes(size, rng))
+        {
+            ChemiaAion::Node *n = node.get();
+            n->handle_ = graph.AddNode(std::move(node));
+            index.Update(n);
+        }
+
+        // a box over the middle tenth of the canvas
+        ImVec2 extent(0.0f, 0.0f);
+        for (uint32_t i = 0; i < graph.GetNodeCount(); ++i)
+        {
+            const ChemiaAion::Node &node = *graph.GetNodeAt(i);
+            extent.x = std::max(extent.x, node.position_.x + node.size_.x);
+            extent.y = std::max(extent.y, node.position_.y + node.size_.y);
+        }
+        const float side = sqrtf(0.1f);
+        const ImVec2 min(extent.x * (0.5f - side / 2.0f), extent.y * (0.5f - side / 2.0f));
+        const ImVec2 max(extent.x * (0.5f + side / 2.0f), extent.y * (0.5f + side / 2.0f));
+        std::vector<ChemiaAion::Node *> hits;
+
+        // before: the selection is the sign of id_
+        index.QueryRect(min, max, true, hits);
+        for (auto node : hits)
+        {
+            node->id_ = -node->id_;
+        }
+        auto begin = clock_type::now();
+        for (int frame = 0; frame < drag_frames; ++frame)
+        {
+            for (uint32_t i = 0; i < graph.GetNodeCount(); ++i)
+            {
+                ChemiaAion::Node *node = graph.GetNodeAt(i).get();
+                if (node->id_ < 0)
+                {
+                    node->position_.x += drag_step;
+                    index.Update(node);
+                }
+            }
+        }
+        const double scan_us = Ms(begin) * 1000.0 / drag_frames;
+        for (auto node : hits)
+        {
+            node->id_ = -node->id_;
+        }
+
+        // after: a selection set, the grid is updated once on release
+        hits.clear();
+        index.QueryRect(min, max, true, hits);
+        begin = clock_type::now();
+        nodegraph::Selection<nodegraph::NodeHandle> selection;
+        std::vector<nodegraph::NodeHandle> handles;
+        for (auto node : hits)
+        {
+            handles.push_back(node->handle_);
+        }
+        selection.Add(handles.data(), handles.size());
+        const double select_us = Ms(begin) * 1000.0;
+
+        begin = clock_type::now();
+        for (int frame = 0; frame < drag_frames; ++frame)
+        {
+            for (auto handle : selection)
+            {
+                (*graph.Get(handle))->position_.x += drag_step;
+            }
+        }
+        const double set_us = Ms(begin) * 1000.0 / drag_frames;
+
+        begin = clock_type::now();
+        for (auto handle : selection)
+        {
+            index.Update(graph.Get(handle)->get());
+        }
+        const double release_ms = Ms(begin);
+
+        std::vector<ChemiaAion::Node *> all;
+        index.QueryRect(ImVec2(-100.0f, -100.0f), ImVec2(extent.x + drag_frames * drag_step * 2.0f, extent.y), false, all);
+        if (all.size() != (size_t)size)
+        {
+            LOGE << size << " nodes: " << all.size() << " left in the grid after the drag";
+        }
+
+        LOGI << size << " nodes, " << selection.size() << " selected: building the set " << select_us << " us"
+             << ", drag " << scan_us << " -> " << set_us << " us/frame"
+             << ", release " << release_ms << " ms";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static plog::ConsoleAppender<plog::TxtFormatter> consoleAppender;
+    plog::init(plog::info, &consoleAppender);
+
+    const struct
+    {
+        const char *name;
+        std::function<void(const std::vector<int> &)> run;
+    } benches[] = {
+        {"spatial", BenchSpatial},
+        {"bezier", BenchBezier},
+        {"dataflow", BenchDataflow},
+        {"incremental", BenchIncremental},
+        {"tape", BenchTape},
+        {"pool", BenchPool},
+        {"selection", BenchSelection},
+    };
+
+    const char *name = argc > 1 ? argv[1] : nullptr;
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; ++i)
+    {
+        sizes.push_back(atoi(argv[i]));
+    }
+    if (sizes.empty())
+    {
+        sizes = {1000, 5000, 20000, 100000};
+    }
+
+    bool found = false;
+    for (auto &bench : benches)
+    {
+        if (!name || strcmp(name, bench.name) == 0)
+        {
+            LOGI << "== " << bench.name;
+            bench.run(sizes);
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        LOGE << "usage: nodegraph_bench [spatial|bezier|dataflow|incremental|tape|pool|selection] [node counts...]";
+        return 1;
+    }
+
+    return 0;
+}
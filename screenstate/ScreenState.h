@@ -12,6 +12,7 @@ enum MouseButtonFlags
     WheelPlus = 0x08,
     WheelMinus = 0x10,
     CursorUpdate = 0x20,
+    KeyUpdate = 0x40, // a key went down/up or a character was typed during the frame
 };
 
 struct ScreenState
@@ -42,7 +43,8 @@ struct ScreenState
 
     void Clear()
     {
-        Unset((MouseButtonFlags)(MouseButtonFlags::WheelMinus | MouseButtonFlags::WheelPlus | MouseButtonFlags::CursorUpdate));
+        Unset((MouseButtonFlags)(MouseButtonFlags::WheelMinus | MouseButtonFlags::WheelPlus | MouseButtonFlags::CursorUpdate |
+                                 MouseButtonFlags::KeyUpdate));
     }
 
     float AspectRatio() const
@@ -44,25 +44,23 @@ LRESULT CALLBACK Win32Window::WindowProc(HWND hWnd, UINT message, WPARAM wParam,
     case WM_SIZE:
         if (wParam != SIZE_MINIMIZED)
         {
-            window->m_state.Width = LOWORD(lParam);
-            window->m_state.Height = HIWORD(lParam);
+            window->PushEvent(InputEventType::Resize, MouseButtonFlags::None, LOWORD(lParam), HIWORD(lParam));
         }
         break;
 
-        // TODO:
-        // case WM_KEYDOWN:
-        //     if (pSample)
-        //     {
-        //         pSample->OnKeyDown(static_cast<UINT8>(wParam));
-        //     }
-        //     return 0;
-
-        // case WM_KEYUP:
-        //     if (pSample)
-        //     {
-        //         pSample->OnKeyUp(static_cast<UINT8>(wParam));
-        //     }
-        //     return 0;
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN:
+        window->PushEvent(InputEventType::Key, MouseButtonFlags::None, (int)wParam, 1);
+        break;
+
+    case WM_KEYUP:
+    case WM_SYSKEYUP:
+        window->PushEvent(InputEventType::Key, MouseButtonFlags::None, (int)wParam, 0);
+        break;
+
+    case WM_CHAR:
+        window->PushEvent(InputEventType::Char, MouseButtonFlags::None, (int)wParam, 0);
+        break;
 
     case WM_ERASEBKGND:
         return 1;
@@ -72,69 +70,39 @@ LRESULT CALLBACK Win32Window::WindowProc(HWND hWnd, UINT message, WPARAM wParam,
         return 0;
 
     case WM_MOUSEMOVE:
-        window->m_state.MouseX = GET_X_LPARAM(lParam);
-        window->m_state.MouseY = GET_Y_LPARAM(lParam);
+        window->PushEvent(InputEventType::MouseMove, MouseButtonFlags::None, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
         return 0;
 
     case WM_LBUTTONDOWN:
-        if (!window->m_state.HasCapture())
-        {
-            SetCapture(hWnd);
-        }
-        window->m_state.Set(MouseButtonFlags::LeftDown);
+        window->ButtonDown(hWnd, MouseButtonFlags::LeftDown, lParam);
         return 0;
 
     case WM_LBUTTONUP:
-        window->m_state.Unset(MouseButtonFlags::LeftDown);
-        if (!window->m_state.HasCapture())
-        {
-            ReleaseCapture();
-        }
+        window->ButtonUp(MouseButtonFlags::LeftDown, lParam);
         return 0;
 
     case WM_RBUTTONDOWN:
-        if (!window->m_state.HasCapture())
-        {
-            SetCapture(hWnd);
-        }
-        window->m_state.Set(MouseButtonFlags::RightDown);
+        window->ButtonDown(hWnd, MouseButtonFlags::RightDown, lParam);
         return 0;
 
     case WM_RBUTTONUP:
-        window->m_state.Unset(MouseButtonFlags::RightDown);
-        if (!window->m_state.HasCapture())
-        {
-            ReleaseCapture();
-        }
+        window->ButtonUp(MouseButtonFlags::RightDown, lParam);
         return 0;
 
     case WM_MBUTTONDOWN:
-        if (!window->m_state.HasCapture())
-        {
-            SetCapture(hWnd);
-        }
-        window->m_state.Set(MouseButtonFlags::MiddleDown);
+        window->ButtonDown(hWnd, MouseButtonFlags::MiddleDown, lParam);
         return 0;
 
     case WM_MBUTTONUP:
-        window->m_state.Unset(MouseButtonFlags::MiddleDown);
-        if (!window->m_state.HasCapture())
-        {
-            ReleaseCapture();
-        }
+        window->ButtonUp(MouseButtonFlags::MiddleDown, lParam);
         return 0;
 
     case WM_MOUSEWHEEL:
     {
-        auto zDelta = GET_WHEEL_DELTA_WPARAM(wParam);
-        if (zDelta < 0)
-        {
-            window->m_state.Set(MouseButtonFlags::WheelMinus);
-        }
-        else if (zDelta > 0)
-        {
-            window->m_state.Set(MouseButtonFlags::WheelPlus);
-        }
+        // every notch is an event, several notches within a frame are no longer folded into one flag
+        POINT p = {GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)};
+        ScreenToClient(hWnd, &p);
+        window->PushEvent(InputEventType::Wheel, MouseButtonFlags::None, p.x, p.y, GET_WHEEL_DELTA_WPARAM(wParam));
         return 0;
     }
 
@@ -148,7 +116,7 @@ LRESULT CALLBACK Win32Window::WindowProc(HWND hWnd, UINT message, WPARAM wParam,
         {
             if (LOWORD(lParam) == HTCLIENT)
             {
-                window->m_state.Set(MouseButtonFlags::CursorUpdate);
+                window->PushEvent(InputEventType::CursorUpdate, MouseButtonFlags::None, 0, 0);
                 return 1;
             }
         }
@@ -159,6 +127,38 @@ LRESULT CALLBACK Win32Window::WindowProc(HWND hWnd, UINT message, WPARAM wParam,
     return DefWindowProc(hWnd, message, wParam, lParam);
 }
 
+void Win32Window::PushEvent(InputEventType type, MouseButtonFlags button, int x, int y, int wheelDelta)
+{
+    m_producer.Push({
+        .Timestamp = InputClock::Now(),
+        .Type = type,
+        .Button = button,
+        .X = (int16_t)x,
+        .Y = (int16_t)y,
+        .WheelDelta = (int16_t)wheelDelta,
+    });
+}
+
+void Win32Window::ButtonDown(HWND hWnd, MouseButtonFlags button, LPARAM lParam)
+{
+    if (m_buttons == MouseButtonFlags::None)
+    {
+        SetCapture(hWnd);
+    }
+    m_buttons = (MouseButtonFlags)(m_buttons | button);
+    PushEvent(InputEventType::ButtonDown, button, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+}
+
+void Win32Window::ButtonUp(MouseButtonFlags button, LPARAM lParam)
+{
+    m_buttons = (MouseButtonFlags)(m_buttons & ~button);
+    if (m_buttons == MouseButtonFlags::None)
+    {
+        ReleaseCapture();
+    }
+    PushEvent(InputEventType::ButtonUp, button, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+}
+
 HWND Win32Window::Create(const wchar_t *titleName, int width, int height)
 {
     // Initialize the window class.
@@ -210,57 +210,35 @@ void Win32Window::Show(int nCmdShow)
     ShowWindow(m_hwnd, nCmdShow);
 }
 
-bool Win32Window::Update(ScreenState *pState)
+bool Win32Window::PumpMessages()
 {
     MSG msg = {};
-    while (true)
+    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
     {
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        if (msg.message == WM_QUIT)
         {
-            if (msg.message == WM_QUIT)
-            {
-                return false;
-            }
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
-        else
-        {
-            break;
+            return false;
         }
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
     }
+    m_producer.Flush();
+    return true;
+}
 
-    if (msg.message == WM_QUIT)
-    {
-        return false;
-    }
+void Win32Window::WaitEvents(int64_t timeoutMicroseconds)
+{
+    auto ms = (DWORD)((timeoutMicroseconds + 999) / 1000);
+    MsgWaitForMultipleObjectsEx(0, nullptr, ms, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
 
-    auto now = timeGetTime();
-    if (m_startTime)
-    {
-        now -= m_startTime;
-    }
-    else
-    {
-        now = 0;
-    }
-    if (now > m_lastTime)
-    {
-        m_state.ElapsedSeconds = now * 0.001f;
-        auto delta = now - m_lastTime;
-        m_state.DeltaSeconds = delta * 0.001f;
-    }
-    else
+bool Win32Window::Update(ScreenState *pState)
+{
+    if (!PumpMessages())
     {
-        // work around
-        m_startTime = now;
-        m_state.DeltaSeconds = 0.016f;
-        m_state.ElapsedSeconds = 0.016f;
+        return false;
     }
-    m_lastTime = now;
-
-    *pState = m_state;
-    m_state.Clear();
+    *pState = m_reducer.Drain(m_events, InputClock::Now());
     return true;
 }
 } // namespace screenstate
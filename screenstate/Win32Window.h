@@ -1,5 +1,6 @@
 #pragma once
 #include "ScreenState.h"
+#include "input_event.h"
 #include <Windows.h>
 #include <string>
 
@@ -8,22 +9,37 @@ namespace screenstate
 class Win32Window
 {
     HWND m_hwnd = NULL;
-    ScreenState m_state{};
     std::wstring m_className;
     HINSTANCE m_hInstance;
-    UINT m_lastTime = 0;
-    UINT m_startTime = 0;
     bool m_enableSetCursor = true;
 
+    // written by WindowProc, read by Update or by a render thread
+    InputEventQueue m_events;
+    InputEventProducer m_producer{m_events};
+    // window thread copy of the pressed buttons, for SetCapture/ReleaseCapture
+    MouseButtonFlags m_buttons = MouseButtonFlags::None;
+    InputReducer m_reducer;
+
 public:
     Win32Window(const wchar_t *className);
     ~Win32Window();
     HWND Create(const wchar_t *titleName, int width = 0, int height = 0);
     void Show(int nCmdShow = SW_SHOW);
+    // pump messages and drain the events into a snapshot. pumping and rendering on the same thread
     bool Update(ScreenState *pState);
+    // pump messages only, return false on WM_QUIT. the render thread consumes Events() with its own InputReducer
+    bool PumpMessages();
+    // block until a message arrives or timeoutMicroseconds elapsed
+    void WaitEvents(int64_t timeoutMicroseconds);
+    InputEventQueue &Events() { return m_events; }
+    // the events folded into the ScreenState of the last Update(), see InputReducer::FrameEvents
+    const std::vector<InputEvent> &FrameEvents() const { return m_reducer.FrameEvents(); }
     void SetEnableSetCursor(bool enable) { m_enableSetCursor = enable; }
 
 private:
     static LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+    void PushEvent(InputEventType type, MouseButtonFlags button, int x, int y, int wheelDelta = 0);
+    void ButtonDown(HWND hWnd, MouseButtonFlags button, LPARAM lParam);
+    void ButtonUp(MouseButtonFlags button, LPARAM lParam);
 };
 } // namespace screenstate
\ No newline at end of file
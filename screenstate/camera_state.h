@@ -28,17 +28,86 @@ struct CameraState
     std::array<float, 16> view;
     std::array<float, 16> viewInverse;
 
-    // mult
+    // true if the projection maps z to [-1, 1] (GL), false for [0, 1] (DX)
+    bool ndcZNegativeOneToOne = false;
+
+    // incremented by Update(), consumers can compare it to skip work when the camera did not change
+    uint32_t version = 0;
+
+    // derived data, valid after Update()
     std::array<float, 16> viewProjection;
-    void CalcViewProjection()
+    // in Im3d::FrustumPlane order (near, far, top, right, bottom, left), xyz = normal pointing inside, inside if dot(xyz, p) >= w
+    std::array<std::array<float, 4>, 6> frustumPlanes;
+    // world space cursor ray: direction = normalize(ndcX * rayRight + ndcY * rayUp + rayForward), origin = viewInverse[12..14]
+    std::array<float, 3> rayRight;
+    std::array<float, 3> rayUp;
+    std::array<float, 3> rayForward;
+    // world space height of the view plane at distance 1, see Im3d::AppData::m_projScaleY
+    float projScaleY = 1.0f;
+
+    // call after view, viewInverse or projection changed
+    void Update()
     {
         viewProjection = amth::Mult(view, projection);
+        CalcFrustumPlanes();
+
+        for (int i = 0; i < 3; ++i)
+        {
+            rayRight[i] = viewInverse[i] / projection[0];
+            rayUp[i] = viewInverse[4 + i] / projection[5];
+            rayForward[i] = -viewInverse[8 + i];
+        }
+        projScaleY = tanf(fovYRadians * 0.5f) * 2.0f;
+
+        ++version;
+    }
+
+    std::array<float, 3> CalcRayDirection(float ndcX, float ndcY) const
+    {
+        std::array<float, 3> d;
+        for (int i = 0; i < 3; ++i)
+        {
+            d[i] = ndcX * rayRight[i] + ndcY * rayUp[i] + rayForward[i];
+        }
+        auto invLength = 1.0f / sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        for (auto &x : d)
+        {
+            x *= invLength;
+        }
+        return d;
     }
 
     std::array<float, 16> CalcModelViewProjection(const std::array<float, 16> &m) const
     {
         return amth::Mult(m, viewProjection);
     }
+
+private:
+    void CalcFrustumPlanes()
+    {
+        // row vectors: clip[j] = dot(p, column j of viewProjection)
+        auto &m = viewProjection;
+        auto column = [&m](int j) { return std::array<float, 4>{m[j], m[4 + j], m[8 + j], m[12 + j]}; };
+        auto x = column(0);
+        auto y = column(1);
+        auto z = column(2);
+        auto w = column(3);
+        auto plane = [](const std::array<float, 4> &a, float s, const std::array<float, 4> &b) {
+            std::array<float, 4> p;
+            for (int i = 0; i < 4; ++i)
+            {
+                p[i] = a[i] + s * b[i];
+            }
+            auto invLength = 1.0f / sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            return std::array<float, 4>{p[0] * invLength, p[1] * invLength, p[2] * invLength, -p[3] * invLength};
+        };
+        frustumPlanes[0] = ndcZNegativeOneToOne ? plane(w, 1.0f, z) : plane(z, 0.0f, z); // near
+        frustumPlanes[1] = plane(w, -1.0f, z);                                            // far
+        frustumPlanes[2] = plane(w, -1.0f, y);                                            // top
+        frustumPlanes[3] = plane(w, -1.0f, x);                                            // right
+        frustumPlanes[4] = plane(w, 1.0f, y);                                             // bottom
+        frustumPlanes[5] = plane(w, 1.0f, x);                                             // left
+    }
 };
 /*
 struct RenderTargetInfo
@@ -0,0 +1,83 @@
+#include "frame_scheduler.h"
+#include <thread>
+
+namespace screenstate
+{
+
+static bool InputChanged(const ScreenState &l, const ScreenState &r)
+{
+    return l.Width != r.Width || l.Height != r.Height || l.MouseX != r.MouseX || l.MouseY != r.MouseY ||
+           l.MouseFlag != r.MouseFlag;
+}
+
+void FrameScheduler::SetMaxFps(float fps)
+{
+    if (fps <= 0)
+    {
+        m_minInterval = clock::duration::zero();
+    }
+    else
+    {
+        m_minInterval = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    }
+}
+
+bool FrameScheduler::ShouldRender(ScreenState &state)
+{
+    // edge flags (wheel, cursor, key) are only set on the frame they happen
+    auto edges = MouseButtonFlags::WheelPlus | MouseButtonFlags::WheelMinus | MouseButtonFlags::CursorUpdate | MouseButtonFlags::KeyUpdate;
+    if (m_first || InputChanged(state, m_last) || (state.MouseFlag & edges))
+    {
+        m_pendingFrames = 2;
+    }
+    m_first = false;
+    m_last = state;
+
+    if (!m_animating && m_pendingFrames == 0)
+    {
+        m_skippedSeconds += state.DeltaSeconds;
+        ++m_stats.SkippedFrames;
+        return false;
+    }
+    if (m_pendingFrames > 0)
+    {
+        --m_pendingFrames;
+    }
+    state.DeltaSeconds += m_skippedSeconds;
+    m_skippedSeconds = 0;
+    m_lastFrame = clock::now();
+    ++m_stats.RenderedFrames;
+    return true;
+}
+
+bool FrameScheduler::ShouldRender(ScreenState &state, const std::vector<InputEvent> &events)
+{
+    if (!events.empty())
+    {
+        m_pendingFrames = 2;
+    }
+    return ShouldRender(state);
+}
+
+void FrameScheduler::Wait(const std::function<void(int64_t)> &waitEvents)
+{
+    // pace to the max rate. sleep is coarse (~1ms on linux, up to a timer tick on windows), spin the remainder
+    auto due = m_lastFrame + m_minInterval;
+    const auto SPIN = std::chrono::milliseconds(2);
+    auto now = clock::now();
+    if (due - now > SPIN)
+    {
+        std::this_thread::sleep_for(due - now - SPIN);
+    }
+    while (clock::now() < due)
+    {
+        std::this_thread::yield();
+    }
+
+    if (m_animating || m_pendingFrames > 0)
+    {
+        return;
+    }
+    waitEvents(std::chrono::duration_cast<std::chrono::microseconds>(m_idleTimeout).count());
+}
+} // namespace screenstate
@@ -0,0 +1,71 @@
+#pragma once
+#include "ScreenState.h"
+#include "input_event.h"
+#include <chrono>
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+namespace screenstate
+{
+///
+/// Decide per loop iteration whether a frame has to be rendered, and wait between frames.
+///
+/// while (window.Update(&state))
+/// {
+///     if (scheduler.ShouldRender(state))
+///     {
+///         ... update, render, present ...
+///         scheduler.SetAnimating(Im3d::GetActiveId() != Im3d::Id_Invalid);
+///     }
+///     scheduler.Wait([&window](int64_t us) { window.WaitEvents(us); });
+/// }
+///
+class FrameScheduler
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Stats
+    {
+        uint64_t RenderedFrames = 0;
+        uint64_t SkippedFrames = 0;
+    };
+
+private:
+    ScreenState m_last{};
+    bool m_first = true;
+    bool m_animating = false;
+    // frames still to render after a change. input is applied by Im3d/ImGui one frame late, so a change renders twice
+    int m_pendingFrames = 0;
+    // DeltaSeconds of the frames skipped since the last rendered one
+    float m_skippedSeconds = 0;
+    clock::duration m_minInterval = std::chrono::microseconds(1000000 / 60);
+    clock::duration m_idleTimeout = std::chrono::milliseconds(250);
+    clock::time_point m_lastFrame;
+    Stats m_stats;
+
+public:
+    // 0: unlimited
+    void SetMaxFps(float fps);
+    // upper bound of a wait without events, so time based state (DeltaSeconds, shared memory input) still advances
+    void SetIdleTimeout(clock::duration timeout) { m_idleTimeout = timeout; }
+    // render continuously while set, e.g. during gizmo drag or an animation
+    void SetAnimating(bool animating) { m_animating = animating; }
+    // request a frame for a change the scheduler cannot see, e.g. data loaded in the background
+    void Invalidate() { m_pendingFrames = 2; }
+
+    // call once per loop iteration after the window update. count the frame as rendered or skipped. the DeltaSeconds of
+    // skipped frames is added to the state of the next rendered one, so time based updates don't lose the idle time
+    bool ShouldRender(ScreenState &state);
+    // as above, and any event of the frame (Win32Window::FrameEvents) counts as a change. a click which went down and up
+    // within the frame leaves the snapshot as it was, but still has to reach Im3d/ImGui
+    bool ShouldRender(ScreenState &state, const std::vector<InputEvent> &events);
+
+    // sleep until the next frame is due at the max rate. when idle, additionally block in waitEvents(timeoutMicroseconds)
+    // until the platform reports input or the idle timeout expires
+    void Wait(const std::function<void(int64_t)> &waitEvents);
+
+    const Stats &GetStats() const { return m_stats; }
+};
+} // namespace screenstate
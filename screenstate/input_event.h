@@ -0,0 +1,232 @@
+#pragma once
+#include "ScreenState.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace screenstate
+{
+enum class InputEventType : uint8_t
+{
+    MouseMove,
+    ButtonDown, // Button is one of LeftDown, RightDown, MiddleDown
+    ButtonUp,
+    Wheel,
+    Resize,
+    CursorUpdate,
+    Key,  // X: virtual key, Y: 1 down, 0 up
+    Char, // X: UTF-16 code unit
+};
+
+struct InputEvent
+{
+    // steady_clock, microseconds. see InputClock
+    int64_t Timestamp;
+    InputEventType Type;
+    MouseButtonFlags Button;
+    int16_t X; // MouseMove, Button*: cursor position. Resize: width
+    int16_t Y; // MouseMove, Button*: cursor position. Resize: height
+    int16_t WheelDelta;
+};
+
+struct InputClock
+{
+    static int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Single producer single consumer ring. Push is called from the window thread, Pop from the render thread.
+template <typename T, size_t N>
+class SpscRing
+{
+    static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+    std::array<T, N> m_items;
+    alignas(64) std::atomic<uint32_t> m_head{0}; // next write, owned by the producer
+    alignas(64) std::atomic<uint32_t> m_tail{0}; // next read, owned by the consumer
+    alignas(64) std::atomic<uint32_t> m_dropped{0};
+
+public:
+    // producer. return false and count the item as dropped if the consumer is N items behind, see InputEventProducer
+    bool Push(const T &item)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == N)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[head & (N - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer
+    bool Pop(T *pItem)
+    {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        *pItem = m_items[tail & (N - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const
+    {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+    uint32_t DroppedCount() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+};
+
+using InputEventQueue = SpscRing<InputEvent, 1024>;
+
+// Window thread side of an InputEventQueue. A mouse move is held back and replaced by the next one until another event or
+// Flush() publishes it, so a burst of moves costs one slot. Events which don't fit while the consumer is behind wait here in
+// order and are retried by the next Push()/Flush(); button edges are never lost, moves keep only the latest position.
+class InputEventProducer
+{
+    InputEventQueue &m_queue;
+    std::vector<InputEvent> m_pending; // not yet in m_queue, in order
+
+public:
+    explicit InputEventProducer(InputEventQueue &queue) : m_queue(queue) {}
+
+    void Push(const InputEvent &e)
+    {
+        if (e.Type == InputEventType::MouseMove && !m_pending.empty() && m_pending.back().Type == InputEventType::MouseMove)
+        {
+            m_pending.back() = e;
+            return;
+        }
+        Flush();
+        m_pending.push_back(e);
+        if (e.Type != InputEventType::MouseMove)
+        {
+            Flush();
+        }
+    }
+
+    // publish the pending events, call once the window messages of a pump are handled
+    void Flush()
+    {
+        size_t i = 0;
+        while (i < m_pending.size() && m_queue.Push(m_pending[i]))
+        {
+            ++i;
+        }
+        m_pending.erase(m_pending.begin(), m_pending.begin() + i);
+    }
+};
+
+// Derive ScreenState snapshots from the event stream on the consumer side.
+class InputReducer
+{
+    ScreenState m_state{};
+    int64_t m_startTime = 0;
+    int64_t m_lastTime = 0;
+    // events applied by the last Drain(), in order
+    std::vector<InputEvent> m_frameEvents;
+
+public:
+    const ScreenState &State() const { return m_state; }
+    // The snapshot folds a frame into one state, so a click that goes down and up within the frame leaves no trace and
+    // several wheel notches set one flag. Consumers which need every edge or the wheel amount read the events instead.
+    const std::vector<InputEvent> &FrameEvents() const { return m_frameEvents; }
+
+    void Apply(const InputEvent &e)
+    {
+        switch (e.Type)
+        {
+        case InputEventType::MouseMove:
+            m_state.MouseX = e.X;
+            m_state.MouseY = e.Y;
+            break;
+
+        case InputEventType::ButtonDown:
+            m_state.MouseX = e.X;
+            m_state.MouseY = e.Y;
+            m_state.Set(e.Button);
+            break;
+
+        case InputEventType::ButtonUp:
+            m_state.MouseX = e.X;
+            m_state.MouseY = e.Y;
+            m_state.Unset(e.Button);
+            break;
+
+        case InputEventType::Wheel:
+            if (e.WheelDelta < 0)
+            {
+                m_state.Set(MouseButtonFlags::WheelMinus);
+            }
+            else if (e.WheelDelta > 0)
+            {
+                m_state.Set(MouseButtonFlags::WheelPlus);
+            }
+            break;
+
+        case InputEventType::Resize:
+            m_state.Width = e.X;
+            m_state.Height = e.Y;
+            break;
+
+        case InputEventType::CursorUpdate:
+            m_state.Set(MouseButtonFlags::CursorUpdate);
+            break;
+
+        case InputEventType::Key:
+        case InputEventType::Char:
+            m_state.Set(MouseButtonFlags::KeyUpdate);
+            break;
+        }
+    }
+
+    // Apply every queued event, calling onEvent(const InputEvent &, const ScreenState &) after each one for consumers
+    // that need per event timing. Then stamp the frame time and return the snapshot. Edge flags (wheel, cursor, key) are
+    // cleared on the next call, as ScreenState::Clear() does for Win32Window::Update.
+    template <typename F>
+    ScreenState Drain(InputEventQueue &queue, int64_t now, const F &onEvent)
+    {
+        m_state.Clear();
+        m_frameEvents.clear();
+        InputEvent e;
+        while (queue.Pop(&e))
+        {
+            Apply(e);
+            m_frameEvents.push_back(e);
+            onEvent(e, m_state);
+        }
+
+        if (m_startTime == 0)
+        {
+            m_startTime = now;
+            m_lastTime = now;
+            m_state.DeltaSeconds = 0.016f;
+        }
+        else
+        {
+            m_state.DeltaSeconds = (now - m_lastTime) * 0.000001f;
+        }
+        m_state.ElapsedSeconds = (now - m_startTime) * 0.000001f;
+        m_lastTime = now;
+        return m_state;
+    }
+
+    ScreenState Drain(InputEventQueue &queue, int64_t now)
+    {
+        return Drain(queue, now, [](const InputEvent &, const ScreenState &) {});
+    }
+};
+} // namespace screenstate
@@ -0,0 +1,95 @@
+#include "input_trace.h"
+#include "input_event.h"
+#include <string.h>
+#include <thread>
+
+namespace screenstate
+{
+
+bool InputTraceWriter::Open(const std::filesystem::path &path)
+{
+    m_io.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_io)
+    {
+        return false;
+    }
+    InputTraceHeader header;
+    m_io.write((const char *)&header, sizeof(header));
+    m_frameCount = 0;
+    return true;
+}
+
+void InputTraceWriter::Write(const ScreenState &state)
+{
+    if (!m_io)
+    {
+        return;
+    }
+    m_io.write((const char *)&state, sizeof(state));
+    ++m_frameCount;
+}
+
+bool InputTraceReader::Open(const std::filesystem::path &path)
+{
+    std::ifstream io(path, std::ios::binary);
+    if (!io)
+    {
+        return false;
+    }
+    InputTraceHeader header;
+    InputTraceHeader expected;
+    if (!io.read((char *)&header, sizeof(header)) || memcmp(header.Magic, expected.Magic, sizeof(header.Magic)) != 0 ||
+        header.Version != expected.Version || header.RecordSize != expected.RecordSize)
+    {
+        return false;
+    }
+
+    io.seekg(0, std::ios::end);
+    auto size = (size_t)io.tellg() - sizeof(header);
+    io.seekg(sizeof(header), std::ios::beg);
+    // a truncated last record (recorder killed mid write) is ignored
+    m_frames.resize(size / sizeof(ScreenState));
+    io.read((char *)m_frames.data(), m_frames.size() * sizeof(ScreenState));
+    m_next = 0;
+    return (bool)io;
+}
+
+bool InputTraceReader::Next(ScreenState *pState)
+{
+    if (m_next >= m_frames.size())
+    {
+        return false;
+    }
+    auto state = m_frames[m_next];
+
+    switch (m_pacing)
+    {
+    case InputTracePacing::Fixed:
+        state.DeltaSeconds = m_fixedDeltaSeconds;
+        state.ElapsedSeconds = m_fixedDeltaSeconds * (m_next + 1);
+        break;
+
+    case InputTracePacing::Unpaced:
+        break;
+
+    case InputTracePacing::Original:
+    {
+        auto now = InputClock::Now();
+        if (m_next == 0)
+        {
+            m_startTime = now - (int64_t)(state.ElapsedSeconds * 1000000.0f);
+        }
+        auto due = m_startTime + (int64_t)(state.ElapsedSeconds * 1000000.0f);
+        if (due > now)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+        }
+        break;
+    }
+    }
+
+    ++m_next;
+    *pState = state;
+    return true;
+}
+} // namespace screenstate
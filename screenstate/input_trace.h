@@ -0,0 +1,65 @@
+#pragma once
+#include "ScreenState.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace screenstate
+{
+///
+/// Per frame ScreenState stream, for reproducible performance runs.
+/// File: InputTraceHeader then one raw ScreenState (20 bytes) per frame, little endian.
+///
+struct InputTraceHeader
+{
+    char Magic[4] = {'I', 'T', 'R', 'C'};
+    uint32_t Version = 1;
+    uint32_t RecordSize = sizeof(ScreenState);
+    uint32_t Reserved = 0;
+};
+static_assert(sizeof(InputTraceHeader) == 16, "sizeof(InputTraceHeader)");
+
+class InputTraceWriter
+{
+    std::ofstream m_io;
+    uint32_t m_frameCount = 0;
+
+public:
+    bool Open(const std::filesystem::path &path);
+    bool IsOpen() const { return m_io.is_open(); }
+    // call once per frame with the state passed to the frame, e.g. right after Win32Window::Update
+    void Write(const ScreenState &state);
+    uint32_t FrameCount() const { return m_frameCount; }
+};
+
+enum class InputTracePacing
+{
+    // DeltaSeconds is replaced by a fixed step and frames run back to back. deterministic
+    Fixed,
+    // recorded DeltaSeconds, frames run back to back
+    Unpaced,
+    // recorded DeltaSeconds, Next() sleeps until the recorded ElapsedSeconds
+    Original,
+};
+
+class InputTraceReader
+{
+    std::vector<ScreenState> m_frames;
+    size_t m_next = 0;
+    InputTracePacing m_pacing = InputTracePacing::Fixed;
+    float m_fixedDeltaSeconds = 1.0f / 60.0f;
+    int64_t m_startTime = 0;
+
+public:
+    bool Open(const std::filesystem::path &path);
+    void SetPacing(InputTracePacing pacing, float fixedDeltaSeconds = 1.0f / 60.0f)
+    {
+        m_pacing = pacing;
+        m_fixedDeltaSeconds = fixedDeltaSeconds;
+    }
+    size_t FrameCount() const { return m_frames.size(); }
+    void Rewind() { m_next = 0; }
+    // same contract as Win32Window::Update, return false after the last frame
+    bool Next(ScreenState *pState);
+};
+} // namespace screenstate
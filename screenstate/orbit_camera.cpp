@@ -21,9 +21,12 @@ void OrbitCamera::CalcPerspective()
 {
 #if 0
     amth::PerspectiveRHGL(state.projection.data(), state.fovYRadians, aspectRatio, zNear, zFar);
+    state.ndcZNegativeOneToOne = true;
 #else
     amth::PerspectiveRHDX(state.projection.data(), state.fovYRadians, aspectRatio, zNear, zFar);
+    state.ndcZNegativeOneToOne = false;
 #endif
+    m_projectionFovY = state.fovYRadians;
 }
 
 void OrbitCamera::SetViewport(int x, int y, int w, int h)
@@ -44,7 +47,7 @@ void OrbitCamera::SetViewport(int x, int y, int w, int h)
     state.viewportY = y;
     state.viewportWidth = w;
     state.viewportHeight = h;
-    CalcPerspective();
+    projectionDirty = true;
 }
 
 void OrbitCamera::WindowInput(const screenstate::ScreenState &window)
@@ -61,23 +64,66 @@ void OrbitCamera::WindowInput(const screenstate::ScreenState &window)
             const auto FACTOR = 1.0f / 180.0f * 1.7f;
             yawRadians -= deltaX * FACTOR;
             pitchRadians += deltaY * FACTOR;
+            viewDirty |= deltaX != 0 || deltaY != 0;
         }
         if (window.Has(screenstate::MouseButtonFlags::MiddleDown))
         {
             shiftX -= deltaX / (float)state.viewportHeight * shiftZ;
             shiftY += deltaY / (float)state.viewportHeight * shiftZ;
+            viewDirty |= deltaX != 0 || deltaY != 0;
         }
         if (window.Has(screenstate::WheelPlus))
         {
             shiftZ *= 0.9f;
+            viewDirty = true;
         }
         else if (window.Has(screenstate::WheelMinus))
         {
             shiftZ *= 1.1f;
+            viewDirty = true;
         }
     }
     prevMouseX = window.MouseX;
     prevMouseY = window.MouseY;
-    CalcView();
-    state.CalcViewProjection();
+    Update();
+}
+
+void OrbitCamera::WindowInput(const screenstate::ScreenState &window, const std::vector<screenstate::InputEvent> &events)
+{
+    for (auto &e : events)
+    {
+        if (e.Type == screenstate::InputEventType::Wheel && e.WheelDelta != 0)
+        {
+            // 120 per notch (WHEEL_DELTA), same step as the flag path
+            shiftZ *= powf(e.WheelDelta > 0 ? 0.9f : 1.1f, fabsf(e.WheelDelta / 120.0f));
+            viewDirty = true;
+        }
+    }
+    auto state = window;
+    state.Unset((screenstate::MouseButtonFlags)(screenstate::WheelPlus | screenstate::WheelMinus));
+    WindowInput(state);
+}
+
+bool OrbitCamera::Update()
+{
+    if (state.fovYRadians != m_projectionFovY)
+    {
+        projectionDirty = true;
+    }
+    if (!viewDirty && !projectionDirty)
+    {
+        return false;
+    }
+    if (viewDirty)
+    {
+        CalcView();
+    }
+    if (projectionDirty)
+    {
+        CalcPerspective();
+    }
+    viewDirty = false;
+    projectionDirty = false;
+    state.Update();
+    return true;
 }
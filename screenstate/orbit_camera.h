@@ -1,7 +1,9 @@
 #pragma once
 #include "ScreenState.h"
 #include "camera_state.h"
+#include "input_event.h"
 #include <array>
+#include <vector>
 
 
 struct OrbitCamera
@@ -21,14 +23,23 @@ struct OrbitCamera
     float yawRadians = 0;
     float pitchRadians = 0;
 
+    // set when the inputs of CalcView/CalcPerspective change, cleared by Update()
+    bool viewDirty = true;
+    bool projectionDirty = true;
+
     OrbitCamera()
     {
-        CalcView();
-        CalcPerspective();
-        state.CalcViewProjection();
+        Update();
     }
     void CalcView();
     void CalcPerspective();
     void SetViewport(int x, int y, int w, int h);
     void WindowInput(const screenstate::ScreenState &window);
+    // zoom by every wheel event of the frame (Win32Window::FrameEvents) instead of once per wheel flag
+    void WindowInput(const screenstate::ScreenState &window, const std::vector<screenstate::InputEvent> &events);
+    // recalculate view/projection if dirty, return true if the state changed
+    bool Update();
+
+private:
+    float m_projectionFovY = 0;
 };
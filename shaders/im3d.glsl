@@ -1,6 +1,23 @@
 R""(
 #define kAntialiasing 2.0
-#ifdef VERTEX_SHADER
+#if defined(VERTEX_SHADER) && defined(EXPANDED)
+/*	Points and lines were expanded on the CPU (see im3d_expand.h). Vertices are in clip space and drawn as a plain triangle list,
+	aEdge carries the point uv or line edge distance (xy), the size (z) and the primitive type (w, Im3d::DrawPrimitiveType).
+*/
+	in vec4 aPosition;
+	in vec4 aEdge;
+	in vec4 aColor;
+
+	noperspective out vec4 vEdge;
+	smooth out vec4 vColor;
+
+	void main()
+	{
+		gl_Position = aPosition;
+		vEdge = aEdge;
+		vColor = aColor.abgr; // Im3d::Color is 0xRRGGBBAA, read as normalized bytes on a little endian CPU
+	}
+#elif defined(VERTEX_SHADER)
 /*	This vertex shader fetches Im3d vertex data manually from a uniform buffer (uVertexData). It assumes that the bound vertex buffer contains 4 vertices as follows:
 
 	 -1,1       1,1
@@ -95,7 +112,29 @@ R""(
 	}
 #endif
 
-#ifdef FRAGMENT_SHADER
+#if defined(FRAGMENT_SHADER) && defined(EXPANDED)
+	noperspective in vec4 vEdge;
+	smooth in vec4 vColor;
+
+	out vec4 fResult;
+
+	void main()
+	{
+		fResult = vColor;
+		if (vEdge.w > 1.5) // points
+		{
+			float d = length(vEdge.xy - vec2(0.5));
+			d = smoothstep(0.5, 0.5 - (kAntialiasing / vEdge.z), d);
+			fResult.a *= d;
+		}
+		else if (vEdge.w > 0.5) // lines
+		{
+			float d = abs(vEdge.x) / vEdge.z;
+			d = smoothstep(1.0, 1.0 - (kAntialiasing / vEdge.z), d);
+			fResult.a *= d;
+		}
+	}
+#elif defined(FRAGMENT_SHADER)
 	#ifdef POINTS
 		noperspective in vec2 vUv;
 	#endif
@@ -1,6 +1,12 @@
 R""(
 #ifdef VERTEX_SHADER
+#ifdef INSTANCED
+	// per instance attribute, 4 consecutive locations
+	in mat4 aWorldMatrix;
+	#define uWorldMatrix aWorldMatrix
+#else
 	uniform mat4 uWorldMatrix;
+#endif
 	uniform mat4 uViewProjMatrix;
 	
 	in vec3 aPosition;